@@ -33,8 +33,8 @@
 #ifndef CONF_SW_TIMER_H_INCLUDED
 #define CONF_SW_TIMER_H_INCLUDED
 
-/* Maximum timer count. */
-#define CONF_SW_TIMER_COUNT                1
+/* Maximum timer count. One for each HTTP client and one for the connection pool of HTTP client. */
+#define CONF_SW_TIMER_COUNT                2
 
 /* Maximum timer count. */
 #define CONF_SW_TIMER_CALLBACK_CHANNEL     0
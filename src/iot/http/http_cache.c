@@ -0,0 +1,324 @@
+/**
+ * \file
+ *
+ * \brief Persistent cache index of the HTTP resources on the FatFs volume.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/http/http_cache.h"
+#include <string.h>
+#include <errno.h>
+
+/** Magic number of the index file. ("HCI1") */
+#define HTTP_CACHE_MAGIC               0x31494348UL
+/** Hash value of the empty record. */
+#define HTTP_CACHE_HASH_EMPTY          0
+/** Hash value of the removed record. The lookup continues after this record. */
+#define HTTP_CACHE_HASH_REMOVED        1
+
+/**
+ * \brief First record of the index file.
+ */
+struct http_cache_header {
+	/** HTTP_CACHE_MAGIC */
+	uint32_t magic;
+	/** Size of the record. */
+	uint16_t record_size;
+	/** Number of the records after the header. */
+	uint16_t capacity;
+};
+
+void http_cache_get_config_defaults(struct http_cache_config *const config)
+{
+	config->index_path = "0:http.idx";
+	config->capacity = 256;
+}
+
+/**
+ * \brief Calculate the hash of the URL. (FNV-1a)
+ *
+ * \return     Hash of the URL. It never collides with the empty or the removed record.
+ */
+static uint32_t _http_cache_hash(const char *url)
+{
+	uint32_t hash = 2166136261UL;
+
+	while (*url != '\0') {
+		hash ^= (uint8_t)*url++;
+		hash *= 16777619UL;
+	}
+	if (hash <= HTTP_CACHE_HASH_REMOVED) {
+		hash += 2;
+	}
+	return hash;
+}
+
+/**
+ * \brief Read the record of the slot to module->record.
+ */
+static int _http_cache_read(struct http_cache_module *const module, uint32_t slot)
+{
+	UINT length;
+
+	/* Slot 0 is the header. */
+	if (f_lseek(&module->file, (slot + 1) * HTTP_CACHE_RECORD_SIZE) != FR_OK
+		|| f_read(&module->file, &module->record, HTTP_CACHE_RECORD_SIZE, &length) != FR_OK
+		|| length != HTTP_CACHE_RECORD_SIZE) {
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * \brief Write module->record to the slot.
+ */
+static int _http_cache_write(struct http_cache_module *const module, uint32_t slot)
+{
+	UINT length;
+
+	if (f_lseek(&module->file, (slot + 1) * HTTP_CACHE_RECORD_SIZE) != FR_OK
+		|| f_write(&module->file, &module->record, HTTP_CACHE_RECORD_SIZE, &length) != FR_OK
+		|| length != HTTP_CACHE_RECORD_SIZE || f_sync(&module->file) != FR_OK) {
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * \brief Clear the index file and write the header.
+ */
+static int _http_cache_format(struct http_cache_module *const module)
+{
+	struct http_cache_header *header = (struct http_cache_header *)&module->record;
+	uint32_t slot;
+	UINT length;
+
+	memset(&module->record, 0, sizeof(struct http_cache_entry));
+	if (f_lseek(&module->file, HTTP_CACHE_RECORD_SIZE) != FR_OK || f_truncate(&module->file) != FR_OK) {
+		return -EIO;
+	}
+	for (slot = 0; slot < module->config.capacity; slot++) {
+		if (f_write(&module->file, &module->record, HTTP_CACHE_RECORD_SIZE, &length) != FR_OK
+			|| length != HTTP_CACHE_RECORD_SIZE) {
+			return -EIO;
+		}
+	}
+
+	/* The header is written last, so the index which was not formatted completely is cleared again. */
+	header->magic = HTTP_CACHE_MAGIC;
+	header->record_size = HTTP_CACHE_RECORD_SIZE;
+	header->capacity = module->config.capacity;
+	if (f_lseek(&module->file, 0) != FR_OK
+		|| f_write(&module->file, &module->record, HTTP_CACHE_RECORD_SIZE, &length) != FR_OK
+		|| length != HTTP_CACHE_RECORD_SIZE || f_sync(&module->file) != FR_OK) {
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * \brief Find the record of the URL.
+ *
+ * \param[in]  module          Instance of the HTTP cache.
+ * \param[in]  url             URL of the resource.
+ * \param[in]  hash            Hash of the URL.
+ * \param[out] slot            Slot of the record. If the URL is not found, The slot which can be used for the URL.
+ *
+ * \return     0 if the URL is found, -ENOENT if not found, -EIO if the index can not be read.
+ */
+static int _http_cache_find(struct http_cache_module *const module, const char *url, uint32_t hash, uint32_t *slot)
+{
+	uint32_t home = hash % module->config.capacity;
+	uint32_t index, i;
+	int free_slot = -1;
+
+	for (i = 0; i < HTTP_CACHE_MAX_PROBE; i++) {
+		index = (home + i) % module->config.capacity;
+		if (_http_cache_read(module, index) < 0) {
+			return -EIO;
+		}
+		if (module->record.hash == hash && !strncmp(module->record.url, url, HTTP_CACHE_URL_LENGTH - 1)) {
+			*slot = index;
+			return 0;
+		}
+		if (module->record.hash == HTTP_CACHE_HASH_REMOVED && free_slot < 0) {
+			free_slot = (int)index;
+		} else if (module->record.hash == HTTP_CACHE_HASH_EMPTY) {
+			/* URL was never stored after this record. */
+			if (free_slot < 0) {
+				free_slot = (int)index;
+			}
+			break;
+		}
+	}
+
+	/* If all of the probed slots are used, The record in the slot of the hash is replaced. */
+	*slot = (free_slot >= 0) ? (uint32_t)free_slot : home;
+	return -ENOENT;
+}
+
+int http_cache_init(struct http_cache_module *const module, struct http_cache_config *config)
+{
+	struct http_cache_header *header;
+	UINT length;
+
+	/* Checks the parameters. */
+	if (module == NULL || config == NULL || config->index_path == NULL) {
+		return -EINVAL;
+	}
+
+	if (config->capacity < HTTP_CACHE_MAX_PROBE) {
+		return -EINVAL;
+	}
+
+	memset(module, 0, sizeof(struct http_cache_module));
+	memcpy(&module->config, config, sizeof(struct http_cache_config));
+
+	if (f_open(&module->file, config->index_path, FA_OPEN_ALWAYS | FA_READ | FA_WRITE) != FR_OK) {
+		return -EIO;
+	}
+
+	header = (struct http_cache_header *)&module->record;
+	if (f_read(&module->file, &module->record, HTTP_CACHE_RECORD_SIZE, &length) != FR_OK
+		|| length != HTTP_CACHE_RECORD_SIZE || header->magic != HTTP_CACHE_MAGIC
+		|| header->record_size != HTTP_CACHE_RECORD_SIZE || header->capacity != config->capacity
+		|| module->file.fsize < (uint32_t)(config->capacity + 1) * HTTP_CACHE_RECORD_SIZE) {
+		/* New index or the index of the different layout. */
+		if (_http_cache_format(module) < 0) {
+			f_close(&module->file);
+			return -EIO;
+		}
+	}
+
+	module->opened = 1;
+	return 0;
+}
+
+int http_cache_deinit(struct http_cache_module *const module)
+{
+	/* Checks the parameters. */
+	if (module == NULL) {
+		return -EINVAL;
+	}
+
+	if (module->opened) {
+		f_close(&module->file);
+		module->opened = 0;
+	}
+
+	return 0;
+}
+
+int http_cache_lookup(struct http_cache_module *const module, const char *url, struct http_cache_entry *entry)
+{
+	FILINFO info;
+	uint32_t slot;
+	int result;
+
+	/* Checks the parameters. */
+	if (module == NULL || url == NULL || entry == NULL || !module->opened) {
+		return -EINVAL;
+	}
+
+	result = _http_cache_find(module, url, _http_cache_hash(url), &slot);
+	if (result < 0) {
+		return result;
+	}
+
+	/* The cached file can be deleted or changed by others. */
+	memset(&info, 0, sizeof(FILINFO));
+	if (f_stat(module->record.path, &info) != FR_OK || info.fsize != module->record.length) {
+		module->record.hash = HTTP_CACHE_HASH_REMOVED;
+		_http_cache_write(module, slot);
+		return -ENOENT;
+	}
+
+	memcpy(entry, &module->record, sizeof(struct http_cache_entry));
+	return 0;
+}
+
+int http_cache_store(struct http_cache_module *const module, const char *url, const char *etag,
+	const char *last_modified, const char *path, uint32_t length)
+{
+	uint32_t hash, slot;
+
+	/* Checks the parameters. */
+	if (module == NULL || url == NULL || path == NULL || !module->opened) {
+		return -EINVAL;
+	}
+
+	if (etag == NULL && last_modified == NULL) {
+		/* Resource can not be validated. */
+		return -EINVAL;
+	}
+
+	if ((etag != NULL && strlen(etag) >= HTTP_CACHE_ETAG_LENGTH)
+		|| (last_modified != NULL && strlen(last_modified) >= HTTP_CACHE_DATE_LENGTH)
+		|| strlen(path) >= HTTP_CACHE_PATH_LENGTH) {
+		return -ENAMETOOLONG;
+	}
+
+	hash = _http_cache_hash(url);
+	if (_http_cache_find(module, url, hash, &slot) == -EIO) {
+		return -EIO;
+	}
+
+	memset(&module->record, 0, sizeof(struct http_cache_entry));
+	module->record.hash = hash;
+	module->record.length = length;
+	if (etag != NULL) {
+		strcpy(module->record.etag, etag);
+	}
+	if (last_modified != NULL) {
+		strcpy(module->record.last_modified, last_modified);
+	}
+	strcpy(module->record.path, path);
+	strncpy(module->record.url, url, HTTP_CACHE_URL_LENGTH - 1);
+
+	return _http_cache_write(module, slot);
+}
+
+int http_cache_remove(struct http_cache_module *const module, const char *url)
+{
+	uint32_t slot;
+	int result;
+
+	/* Checks the parameters. */
+	if (module == NULL || url == NULL || !module->opened) {
+		return -EINVAL;
+	}
+
+	result = _http_cache_find(module, url, _http_cache_hash(url), &slot);
+	if (result < 0) {
+		return result;
+	}
+
+	module->record.hash = HTTP_CACHE_HASH_REMOVED;
+	return _http_cache_write(module, slot);
+}
@@ -0,0 +1,214 @@
+/**
+ * \file
+ *
+ * \brief Persistent cache index of the HTTP resources on the FatFs volume.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_CACHE_H_INCLUDED
+#define HTTP_CACHE_H_INCLUDED
+
+#include "ff.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of the one record in the index file. Two records are stored in a sector. */
+#define HTTP_CACHE_RECORD_SIZE         256
+/** Max size of the ETag which can be cached. */
+#define HTTP_CACHE_ETAG_LENGTH         64
+/** Max size of the Last-Modified date. (e.g. "Sun, 06 Nov 1994 08:49:37 GMT") */
+#define HTTP_CACHE_DATE_LENGTH         32
+/** Max size of the path of the cached file. */
+#define HTTP_CACHE_PATH_LENGTH         64
+/**
+ * Size of the URL which is stored in the record.
+ * Longer URL is truncated, but it is still distinguished by the hash of the whole URL.
+ */
+#define HTTP_CACHE_URL_LENGTH          (HTTP_CACHE_RECORD_SIZE - 8 - HTTP_CACHE_ETAG_LENGTH - HTTP_CACHE_DATE_LENGTH - HTTP_CACHE_PATH_LENGTH)
+/**
+ * Maximum number of the records which are read to find an URL.
+ * The record is placed near the slot of its hash, so a lookup reads one record in most cases.
+ * If the slots are full, The record in the slot of the hash is replaced.
+ */
+#define HTTP_CACHE_MAX_PROBE           8
+
+/**
+ * \brief Cached resource.
+ *
+ * It is the same layout as the record in the index file.
+ */
+struct http_cache_entry {
+	/** Hash of the whole URL. 0 means the empty record and 1 means the removed record. */
+	uint32_t hash;
+	/** Size of the cached file. */
+	uint32_t length;
+	/** ETag of the resource. Empty string if the server did not send it. */
+	char etag[HTTP_CACHE_ETAG_LENGTH];
+	/** Last-Modified of the resource. Empty string if the server did not send it. */
+	char last_modified[HTTP_CACHE_DATE_LENGTH];
+	/** Path of the file which keeps the entity of the resource. */
+	char path[HTTP_CACHE_PATH_LENGTH];
+	/** URL of the resource. */
+	char url[HTTP_CACHE_URL_LENGTH];
+};
+
+/**
+ * \brief HTTP cache configuration structure
+ *
+ * Configuration struct for a HTTP cache instance. This structure should be
+ * initialized by the \ref http_cache_get_config_defaults function before being
+ * modified by the user application.
+ */
+struct http_cache_config {
+	/**
+	 * Path of the index file.
+	 * Default value is "0:http.idx".
+	 */
+	const char *index_path;
+	/**
+	 * Number of the records in the index file. The file is created in this size at once.
+	 * If the existing index was created in the different size, It is cleared.
+	 * It MUST NOT be smaller than HTTP_CACHE_MAX_PROBE.
+	 * Default value is 256. (64KB)
+	 */
+	uint16_t capacity;
+};
+
+/**
+ * \brief Instance of the HTTP cache.
+ */
+struct http_cache_module {
+	/** Index file. It is kept open while the cache is used. */
+	FIL file;
+	/** Configuration of the cache. */
+	struct http_cache_config config;
+	/** Record which is read from the index file. */
+	struct http_cache_entry record;
+	/** A flag that whether the index file is opened or not. */
+	uint8_t opened;
+};
+
+/**
+ * \brief Get default configuration of the HTTP cache.
+ *
+ * \param[in]  config          Pointer of configuration structure which will be used in the module.
+ */
+void http_cache_get_config_defaults(struct http_cache_config *const config);
+
+/**
+ * \brief Open the index file. It is created if it does not exist.
+ *
+ * The volume MUST be mounted before calling this function.
+ *
+ * \param[in]  module          Instance of the HTTP cache.
+ * \param[in]  config          Configuration of the cache.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -EIO            Index file can not be opened or created.
+ */
+int http_cache_init(struct http_cache_module *const module, struct http_cache_config *config);
+
+/**
+ * \brief Close the index file.
+ *
+ * \param[in]  module          Instance of the HTTP cache.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_cache_deinit(struct http_cache_module *const module);
+
+/**
+ * \brief Find the cached resource of the URL.
+ *
+ * The entry is returned only if its file still exists in the same size.
+ *
+ * \param[in]  module          Instance of the HTTP cache.
+ * \param[in]  url             URL of the resource.
+ * \param[out] entry           Cached resource.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENOENT         URL is not cached.
+ * \return     -EIO            Index file can not be read.
+ */
+int http_cache_lookup(struct http_cache_module *const module, const char *url, struct http_cache_entry *entry);
+
+/**
+ * \brief Record the file which keeps the entity of the URL.
+ *
+ * It is called after the whole entity was written in the file.
+ * The previous record of the same URL is replaced.
+ *
+ * \param[in]  module          Instance of the HTTP cache.
+ * \param[in]  url             URL of the resource.
+ * \param[in]  etag            ETag of the response. It can be NULL.
+ * \param[in]  last_modified   Last-Modified of the response. It can be NULL.
+ * \param[in]  path            Path of the file.
+ * \param[in]  length          Size of the file.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument or both of the validators are NULL.
+ * \return     -ENAMETOOLONG   Validator or path is too long.
+ * \return     -EIO            Index file can not be written.
+ */
+int http_cache_store(struct http_cache_module *const module, const char *url, const char *etag,
+	const char *last_modified, const char *path, uint32_t length);
+
+/**
+ * \brief Remove the record of the URL. The cached file is not deleted.
+ *
+ * \param[in]  module          Instance of the HTTP cache.
+ * \param[in]  url             URL of the resource.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENOENT         URL is not cached.
+ * \return     -EIO            Index file can not be written.
+ */
+int http_cache_remove(struct http_cache_module *const module, const char *url);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_CACHE_H_INCLUDED */
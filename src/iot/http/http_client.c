@@ -32,6 +32,7 @@
  */
 
 #include "iot/http/http_client.h"
+#include "iot/http/http_cache.h"
 #include <string.h>
 #include "driver/include/m2m_wifi.h"
 #include "iot/stream_writer.h"
@@ -48,28 +49,110 @@ enum http_client_req_state {
 	STATE_TRY_SOCK_CONNECT,
 	STATE_SOCK_CONNECTED,
 	STATE_REQ_SEND_HEADER,
+	STATE_REQ_WAIT_HEADER,
 	STATE_REQ_SEND_ENTITY,
 };
 
+/** Context of the header which is written to the socket in non-blocking mode. */
+struct http_client_header_writer {
+	/** Module instance of HTTP. */
+	struct http_client_module *module;
+	/** Size of the header which was accepted by the socket in the previous try. It is skipped. */
+	uint32_t skip;
+	/** Result of the send. If an error was occurred, Remain part of the header is discarded. */
+	int result;
+};
+
+/** Method names with a following space. It MUST be ordered same as \ref http_method. */
+static const struct {
+	const char *name;
+	uint8_t length;
+} method_names[] = {
+	{"", 0},
+	{"GET ", 4},
+	{"POST ", 5},
+	{"DELETE ", 7},
+	{"PUT ", 4},
+	{"OPTIONS ", 8},
+	{"HEAD ", 5},
+};
+
 enum http_client_resp_state {
 	STATE_PARSE_HEADER,
 	STATE_PARSE_ENTITY,
 };
 
-int g_send_pkg_cnt=0;
-int g_recv_pkg_cnt=0;
+enum http_client_header_state {
+	HEADER_STATUS_VERSION = 0,
+	HEADER_STATUS_CODE,
+	HEADER_STATUS_REASON,
+	HEADER_LINE_START,
+	HEADER_NAME,
+	HEADER_VALUE_START,
+	HEADER_VALUE,
+	HEADER_SKIP_LINE,
+};
+
+/** States of the chunked transfer decoder. */
+enum http_client_chunk_state {
+	/** Hexadecimal size of the chunk. */
+	CHUNK_SIZE = 0,
+	/** Chunk extension after the size. It is ignored. */
+	CHUNK_EXTENSION,
+	/** Data of the chunk. */
+	CHUNK_DATA,
+	/** CRLF after the data. */
+	CHUNK_DATA_END,
+	/** Start of the trailer line or the empty line which ends the entity. */
+	CHUNK_TRAILER,
+	/** Trailer header. It is ignored. */
+	CHUNK_TRAILER_LINE,
+};
+
+/** Headers which are interpreted by the response parser. */
+enum http_client_header_id {
+	HEADER_CONTENT_LENGTH = 0,
+	HEADER_TRANSFER_ENCODING,
+	HEADER_CONNECTION,
+	HEADER_CONTENT_ENCODING,
+	HEADER_CONTENT_RANGE,
+	HEADER_ETAG,
+	HEADER_LAST_MODIFIED,
+	HEADER_KEEP_ALIVE,
+	HEADER_CACHE_CONTROL,
+	HEADER_EXPIRES,
+	HEADER_DATE,
+	HEADER_AGE,
+	HEADER_MAX,
+};
+
+/** Lower case names of the interpreted headers. It MUST be ordered same as \ref http_client_header_id. */
+static const char *const header_names[HEADER_MAX] = {
+	"content-length",
+	"transfer-encoding",
+	"connection",
+	"content-encoding",
+	"content-range",
+	"etag",
+	"last-modified",
+	"keep-alive",
+	"cache-control",
+	"expires",
+	"date",
+	"age",
+};
 
 /**
- * \brief Sending the packet in blocking mode.
+ * \brief Sending the part of the header in non-blocking mode.
  *
- * \param[in]  module          Module instance of HTTP.
+ * \param[in]  priv            Context of the header writer. See \ref http_client_header_writer.
  * \param[in]  buffer          Buffer to be sent.
  * \param[in]  buffer_len      Buffer size.
  *
  * \return     0               Function success.
  * \return     otherwise       Function failed.
  */
-int _http_client_send_wait(void *module, char *buffer, size_t buffer_len);
+int _http_client_send_header(void *priv, char *buffer, size_t buffer_len);
 
 int _http_client_read_wait(void *module, char *buffer, size_t buffer_len);
 
@@ -112,6 +195,19 @@ int _http_client_handle_response(struct http_client_module *const module);
  * \param[in]  module          Module instance of HTTP.
  */
 int _http_client_handle_header(struct http_client_module *const module);
+/**
+ * \brief Feed the received bytes to the header parser.
+ *
+ * The parser keeps its position in the response instance,
+ * so each byte is examined only once even if the header is divided in the multiple packets.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  data            Received data.
+ * \param[in]  length          Size of the received data.
+ *
+ * \return     Size of the consumed data. Negative value if the session was closed.
+ */
+int _http_client_parse_header(struct http_client_module *const module, const char *data, int length);
 /**
  * \brief parse the HTTP entity part.
  *
@@ -119,12 +215,75 @@ int _http_client_handle_header(struct http_client_module *const module);
  */
 int _http_client_handle_entity(struct http_client_module *const module);
 /**
- * \brief Move remain part of the buffer to the start position in the buffer.
+ * \brief Pass the part of the entity to the application.
+ *
+ * If the entity is compressed, It is decoded first.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  buffer          Part of the entity.
+ * \param[in]  length          Size of the part.
+ * \param[in]  is_complete     A flag for the last part of the entity.
+ *
+ * \return     0 if success, -1 if the session was closed.
+ */
+int _http_client_send_entity(struct http_client_module *const module, char *buffer, int length, int is_complete);
+/**
+ * \brief Output callback of the decoder. It is registered to the \ref http_inflate_init.
+ */
+void _http_client_inflate_output(void *priv_data, const char *data, size_t length);
+/**
+ * \brief Prepare the parser for the next response.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ */
+void _http_client_reset_response(struct http_client_module *const module);
+/**
+ * \brief Mark the response of the oldest request as received.
+ *
+ * It is called before the last callback of the response,
+ * so a request which is sent from the callback is not marked as answered.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ */
+void _http_client_finish_response(struct http_client_module *const module);
+/**
+ * \brief Get the contiguous part of the received data in the receive buffer.
+ *
+ * The receive buffer is used as a circular buffer.
+ * So the received data can be divided in the two parts at the end of the buffer.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[out] data            Start position of the unread data.
+ *
+ * \return     Size of the contiguous unread data.
+ */
+int _http_client_rx_peek(struct http_client_module *const module, char **data);
+/**
+ * \brief Release the data which was processed from the receive buffer.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  length          Size of the processed data.
+ */
+void _http_client_rx_consume(struct http_client_module *const module, int length);
+/**
+ * \brief Rotate the receive buffer so that the unread data is placed at the start of the buffer.
+ * It is only needed when the data must be passed to the application in a piece.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ */
+void _http_client_rx_linearize(struct http_client_module *const module);
+/**
+ * \brief Drop all requests in the pipeline queue.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ */
+void _http_client_pipeline_flush(struct http_client_module *const module);
+/**
+ * \brief Move the idle connection of the module to the pool.
  *
  * \param[in]  module          Module instance of HTTP.
- * \param[in]  base            Current position of the buffer pointer.
  */
-void _http_client_move_buffer(struct http_client_module *const module, char *base);
+static int _http_client_pool_put(struct http_client_module *const module);
 
 /**
  * \brief Timer callback entry of HTTP client.
@@ -142,6 +301,128 @@ void http_client_timer_callback(struct sw_timer_module *const module, int timer_
  */
 static struct http_client_module *module_ref_inst[TCP_SOCK_MAX] = {NULL,};
 
+/**
+ * \brief Idle persistent connection in the pool.
+ */
+struct http_client_pool_entry {
+	/** Socket of the connection. Negative value means the entry is empty. */
+	SOCKET sock;
+	/** A flag that whether the connection uses TLS or not. */
+	uint8_t tls;
+	/** TCP port of the server. */
+	uint16_t port;
+	/** Number of the requests which are allowed in the connection. 0xFFFF if it is unknown. */
+	uint16_t remain;
+	/** Time when the connection is closed. See \ref sw_timer_get_time. */
+	uint32_t expire;
+	/** Host name of the server. */
+	char host[HOSTNAME_MAX_SIZE];
+};
+
+/**
+ * \brief Idle persistent connections which can be used by any module.
+ * A connection is moved in here when its response was finished, and it is taken by the next request to the same server.
+ */
+static struct http_client_pool_entry http_client_pool[HTTP_CLIENT_POOL_SIZE];
+/** Timer which is used to close the expired connections in the pool. */
+static struct sw_timer_module *http_client_pool_timer_inst = NULL;
+/** ID of the pool timer. Negative value if the timer is not registered. */
+static int http_client_pool_timer_id = -1;
+/** Receive buffer of the idle connections. The data in the idle connection is not expected, so it is just discarded. */
+static uint8_t http_client_pool_recv_buffer[16];
+
+/**
+ * \brief Resolved address of the host name.
+ */
+struct http_client_dns_entry {
+	/** Hash of the host name. Zero means the entry is empty. */
+	uint32_t hash;
+	/** IPv4 address of the host. Zero if the host was not found. */
+	uint32_t ip;
+	/** Time when the entry is expired. See \ref sw_timer_get_time. */
+	uint32_t expire;
+	/** Host name. It is compared only if the hash is matched. */
+	char host[HOSTNAME_MAX_SIZE];
+};
+
+/** Resolved addresses which are used instead of gethostbyname until they are expired. */
+static struct http_client_dns_entry http_client_dns_cache[HTTP_CLIENT_DNS_CACHE_SIZE];
+/** Timer which is used to know the current time in the resolve handler. NULL until the first resolution. */
+static struct sw_timer_module *http_client_dns_timer_inst = NULL;
+
+/**
+ * \brief Response in the response cache.
+ *
+ * The records are packed in the memory of \ref http_client_module.response_cache.
+ * Each record is followed by its key, The host name and the URI without the terminators, and the content.
+ */
+struct http_client_response_record {
+	/** Size of the record including the key and the content. It is aligned to 4 bytes. */
+	uint32_t size;
+	/** Hash of the key. */
+	uint32_t hash;
+	/** Time when the response is expired. See \ref sw_timer_get_time. */
+	uint32_t expire;
+	/** Value of \ref http_client_module.response_cache_clock when the response was used last. */
+	uint32_t last_used;
+	/** Length of the content. */
+	uint32_t content_length;
+	/** Length of the key. */
+	uint16_t key_length;
+	/** Length of the host name in the key. */
+	uint8_t host_length;
+};
+
+/**
+ * \brief Allocate the memory from the pool or the heap if the pool is not configured.
+ */
+static void *_http_client_alloc(struct http_pool *const pool, size_t size)
+{
+	if (pool != NULL) {
+		return http_pool_alloc(pool, size);
+	}
+	return malloc(size);
+}
+
+/**
+ * \brief Release the memory which was allocated by \ref _http_client_alloc with the same pool.
+ */
+static void _http_client_free(struct http_pool *const pool, void *ptr)
+{
+	if (pool != NULL) {
+		http_pool_free(pool, ptr);
+	} else {
+		free(ptr);
+	}
+}
+
+/**
+ * \brief Copy the string into the pool or the heap.
+ */
+static char *_http_client_strdup(struct http_pool *const pool, const char *str)
+{
+	if (pool != NULL) {
+		return http_pool_strdup(pool, str);
+	}
+	return strdup(str);
+}
+
+/**
+ * \brief Release the decoder, the cache entry and the response cache unless they are the memory of the application.
+ */
+static void _http_client_free_memory(struct http_client_module *const module)
+{
+	if (module->inflate != NULL && module->config.inflate_buffer == NULL) {
+		_http_client_free(module->config.buffer_pool, module->inflate);
+	}
+	if (module->cache_entry != NULL) {
+		_http_client_free(module->config.buffer_pool, module->cache_entry);
+	}
+	if (module->response_cache != NULL && module->config.response_cache_buffer == NULL) {
+		_http_client_free(module->config.buffer_pool, module->response_cache);
+	}
+}
+
 void http_client_get_config_defaults(struct http_client_config *const config)
 {
 	config->port = 80;
@@ -150,12 +431,25 @@ void http_client_get_config_defaults(struct http_client_config *const config)
 	config->timer_inst = NULL;
 	config->recv_buffer = NULL;
 	config->recv_buffer_size = 256;
+	config->send_buffer = NULL;
 	config->send_buffer_size = MIN_SEND_BUFFER_SIZE;
+	config->send_window_max = 6;
+	config->inflate_window_size = 0;
+	config->inflate_buffer = NULL;
 	config->user_agent = DEFAULT_USER_AGENT;
+	config->default_headers = HTTP_CLIENT_DEFAULT_HEADERS;
+	config->pipeline_depth = 0;
+	config->cache = NULL;
+	config->response_cache_size = 0;
+	config->response_cache_buffer = NULL;
+	config->buffer_pool = NULL;
+	config->string_pool = NULL;
 }
 
 int http_client_init(struct http_client_module *const module, struct http_client_config *config)
 {
+	int result = -ENOMEM;
+
 	/* Checks the parameters. */
 	if (module == NULL || config == NULL) {
 		return -EINVAL;
@@ -169,35 +463,95 @@ int http_client_init(struct http_client_module *const module, struct http_client
 		return -EINVAL;
 	}
 
-	if (config->send_buffer_size < MIN_SEND_BUFFER_SIZE) {
+	if (config->send_buffer_size < MIN_SEND_BUFFER_SIZE || config->send_buffer_size > SOCKET_BUFFER_MAX_LENGTH) {
+		return -EINVAL;
+	}
+
+	if (config->send_window_max == 0) {
+		return -EINVAL;
+	}
+
+	if (config->inflate_window_size != 0 && (config->inflate_window_size < HTTP_INFLATE_MIN_WINDOW_SIZE
+		|| config->inflate_window_size > HTTP_INFLATE_MAX_WINDOW_SIZE)) {
+		return -EINVAL;
+	}
+
+	if (config->pipeline_depth > HTTP_CLIENT_PIPELINE_MAX_DEPTH) {
 		return -EINVAL;
 	}
 
 	memset(module, 0, sizeof(struct http_client_module));
 	memcpy(&module->config, config, sizeof(struct http_client_config));
 
-	/* Allocate the buffer in the heap. */
+	/* Allocate the buffer in the pool or the heap. */
 	if (module->config.recv_buffer == NULL) {
-		module->config.recv_buffer = malloc(config->recv_buffer_size);
+		module->config.recv_buffer = _http_client_alloc(config->buffer_pool, config->recv_buffer_size);
 		if (module->config.recv_buffer == NULL) {
-			return -ENOMEM;
+			goto fail;
 		}
 		module->alloc_buffer = 1;
 	}
 
+	if (module->config.send_buffer == NULL) {
+		module->config.send_buffer = _http_client_alloc(config->buffer_pool, config->send_buffer_size);
+		if (module->config.send_buffer == NULL) {
+			goto fail;
+		}
+		module->alloc_send_buffer = 1;
+	}
+
+	if (config->inflate_window_size > 0) {
+		module->inflate = (config->inflate_buffer != NULL) ? (struct http_inflate *)config->inflate_buffer
+			: _http_client_alloc(config->buffer_pool, HTTP_CLIENT_INFLATE_BUFFER_SIZE(config->inflate_window_size));
+		if (module->inflate == NULL) {
+			goto fail;
+		}
+	}
+
+	if (config->cache != NULL) {
+		module->cache_entry = _http_client_alloc(config->buffer_pool, sizeof(struct http_cache_entry));
+		if (module->cache_entry == NULL) {
+			goto fail;
+		}
+	}
+
+	if (config->response_cache_size > 0) {
+		module->response_cache = (config->response_cache_buffer != NULL) ? config->response_cache_buffer
+			: _http_client_alloc(config->buffer_pool, config->response_cache_size);
+		if (module->response_cache == NULL) {
+			goto fail;
+		}
+	}
+
 	if (config->timeout > 0) {
 		/* Enable the timer. */
 		module->timer_id = sw_timer_register_callback(config->timer_inst, http_client_timer_callback, (void *)module, 0);
 
 		if (module->timer_id < 0) {
-			return -ENOSPC;
+			result = -ENOSPC;
+			goto fail;
 		}
 	}
 
+	module->sock = -1;
+	module->keep_alive_max = 0xFFFF;
 	module->req.state = STATE_INIT;
 	module->resp.state = STATE_PARSE_HEADER;
 
 	return 0;
+
+fail:
+	/* Release everything which was allocated before the failure. */
+	if (module->alloc_buffer != 0) {
+		_http_client_free(module->config.buffer_pool, module->config.recv_buffer);
+	}
+	if (module->alloc_send_buffer != 0) {
+		_http_client_free(module->config.buffer_pool, module->config.send_buffer);
+	}
+	_http_client_free_memory(module);
+	memset(module, 0, sizeof(struct http_client_module));
+
+	return result;
 }
 
 int http_client_deinit(struct http_client_module *const module)
@@ -207,12 +561,31 @@ int http_client_deinit(struct http_client_module *const module)
 		return -EINVAL;
 	}
 
+	/* The module is released silently. */
+	module->cb = NULL;
+	if (module->req.state >= STATE_TRY_SOCK_CONNECT && _http_client_pool_put(module) < 0) {
+		/* Connection which cannot be parked in the pool is closed. */
+		_http_client_clear_conn(module, 0);
+	}
+
 	if (module->alloc_buffer != 0) {
-		free(module->config.recv_buffer);
+		_http_client_free(module->config.buffer_pool, module->config.recv_buffer);
+	}
+
+	if (module->alloc_send_buffer != 0) {
+		_http_client_free(module->config.buffer_pool, module->config.send_buffer);
 	}
 
+	_http_client_free_memory(module);
+
 	if (module->req.ext_header != NULL) {
-		free(module->req.ext_header);
+		_http_client_free(module->config.string_pool, module->req.ext_header);
+	}
+
+	_http_client_pipeline_flush(module);
+
+	if (module->config.timeout > 0 && module->config.timer_inst != NULL) {
+		sw_timer_unregister_callback(module->config.timer_inst, module->timer_id);
 	}
 
 	memset(module, 0, sizeof(struct http_client_module));
@@ -282,128 +655,585 @@ static inline int _hwerr_to_stderr(int err)
 	}
 }
 
-void http_client_socket_event_handler(SOCKET sock, uint8_t msg_type, void *msg_data)
+/**
+ * \brief Start to measure the latency of the request.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  next            First phase which is measured. See \ref http_client_phase.
+ * \param[in]  start           Time when the request was started. See \ref sw_timer_get_time.
+ */
+static void _http_client_timing_start(struct http_client_module *const module, uint8_t next, uint32_t start)
 {
-	tstrSocketConnectMsg *msg_connect;
-	tstrSocketRecvMsg *msg_recv;
-	int16_t send_ret;
-	union http_client_data data;
+	memset(&module->timing, 0, sizeof(struct http_client_timing));
+	module->timing.start = start;
+	module->timing.mark = start;
+	module->timing.next = next;
+}
 
-	/* Find instance using the socket descriptor. */
-	//printf("sock=%d\r\n", sock);
-	struct http_client_module *module = module_ref_inst[sock];
-	//printf("log6 priv data len=%d\r\n", strlen( module_ref_inst[sock]->req.entity.priv_data));
-	//printf("log6 priv data len=%d\r\n", strlen( module_ref_inst[0]->req.entity.priv_data));
-	/* If cannot found reference, This socket is not HTTP client socket. */
-	if (module == NULL) {
+/**
+ * \brief Finish the phase of the current request.
+ *
+ * The phases which were skipped are left as zero. The phase which was finished already is ignored.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  phase           Phase which was finished. See \ref http_client_phase.
+ */
+static void _http_client_timing_mark(struct http_client_module *const module, uint8_t phase)
+{
+	uint32_t now;
+
+	if (phase < module->timing.next) {
+		/* Phase of the next pipelined request. */
 		return;
 	}
-	switch (msg_type) {
-	case SOCKET_MSG_CONNECT:
-    	msg_connect = (tstrSocketConnectMsg*)msg_data;
-    	data.sock_connected.result = msg_connect->s8Error;
-    	if (msg_connect->s8Error < 0) {
-			/* Remove reference. */
-			_http_client_clear_conn(module, _hwerr_to_stderr(msg_connect->s8Error));
-		} else {
-			/* Send event to callback. */
-			if (module->cb != NULL) {
-				module->cb(module, HTTP_CLIENT_CALLBACK_SOCK_CONNECTED, &data);
-			}
-			module->req.state = STATE_REQ_SEND_HEADER;
-			/* Start timer. */
-			sw_timer_enable_callback(module->config.timer_inst, module->timer_id, module->config.timeout);
-    		/* Start receive packet. */
-    		_http_client_recv_packet(module);
-			/* Try to check the FSM. */
-			_http_client_request(module);
+	if (phase == HTTP_CLIENT_PHASE_ENTITY) {
+		module->timing.bytes_sent = module->req.header_sent + module->req.sent_length;
+	}
+	now = sw_timer_get_time(module->config.timer_inst);
+	module->timing.phase[phase] = now - module->timing.mark;
+	module->timing.mark = now;
+	module->timing.next = phase + 1;
+}
+
+/**
+ * \brief Finish the current request and add its latency to the histograms.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  unread          Size of the response which is not consumed yet.
+ *
+ * \return     Latency breakdown of the request which is passed to the application.
+ */
+static const struct http_client_timing *_http_client_timing_complete(struct http_client_module *const module, int unread)
+{
+	struct http_client_timing_stats *stats = &module->timing_stats;
+	uint32_t elapsed;
+	int i, bucket;
+
+	if (module->timing.next == HTTP_CLIENT_PHASE_MAX) {
+		/* Already counted. */
+		return &module->timing;
+	}
+	_http_client_timing_mark(module, HTTP_CLIENT_PHASE_RECEIVE);
+	module->timing.phase[HTTP_CLIENT_PHASE_TOTAL] = module->timing.mark - module->timing.start;
+	module->timing.next = HTTP_CLIENT_PHASE_MAX;
+	module->timing.bytes_received += unread;
+
+	stats->completed++;
+	stats->bytes_sent += module->timing.bytes_sent;
+	stats->bytes_received += module->timing.bytes_received;
+	for (i = 0; i < HTTP_CLIENT_PHASE_MAX; i++) {
+		elapsed = module->timing.phase[i];
+		stats->sum[i] += elapsed;
+		if (elapsed > stats->max[i]) {
+			stats->max[i] = elapsed;
 		}
-    	break;
-	case SOCKET_MSG_RECV:
-    	msg_recv = (tstrSocketRecvMsg*)msg_data;
-    	/* Start post processing. */
-    	if (msg_recv->s16BufferSize > 0) {
-    		_http_client_recved_packet(module, msg_recv->s16BufferSize);
-		} else {
-			/* Socket was occurred errors. Close this session. */
-			_http_client_clear_conn(module, _hwerr_to_stderr(msg_recv->s16BufferSize));
+		for (bucket = 0; elapsed > 0 && bucket < HTTP_CLIENT_TIMING_BUCKETS - 1; bucket++) {
+			elapsed >>= 1;
 		}
-		/* COntinue to receive the packet. */
-		_http_client_recv_packet(module);
-		break;
-	case SOCKET_MSG_SEND:
-		send_ret = *(int16_t*)msg_data;
-		g_recv_pkg_cnt++;
-		
-		if (send_ret < 0) {
-			/* Send failed. */
-			_http_client_clear_conn(module, _hwerr_to_stderr(send_ret));
-		} else {
-			/* Try to check the FSM. */
-			if (g_recv_pkg_cnt == g_send_pkg_cnt)
-			{
-				g_recv_pkg_cnt = 0;	
-				g_send_pkg_cnt = 0;	
-    			_http_client_request(module);
-			}
+		if (stats->histogram[i][bucket] != 0xFFFF) {
+			stats->histogram[i][bucket]++;
 		}
-		/* Disable sending flag. */
-		module->sending = 0;
-    	break;
-	default:
-		break;
 	}
-
+	return &module->timing;
 }
 
-void http_client_socket_resolve_handler(uint8_t *doamin_name, uint32_t server_ip)
+/**
+ * \brief Start the pool timer for the connection which expires first.
+ * The timer is stopped if the pool is empty, so it does not wake up the idle system.
+ *
+ * \param[in]  now             Current time. See \ref sw_timer_get_time.
+ */
+static void _http_client_pool_arm(uint32_t now)
 {
+	int32_t delay = -1;
+	int32_t remain;
 	int i;
-	struct http_client_module *module;
-	struct sockaddr_in addr_in;
 
-	for (i = 0; i < TCP_SOCK_MAX; i++) {
-		if (module_ref_inst[i] != NULL) {
-			module = module_ref_inst[i];
-			if (!strcmp((const char*)doamin_name, module->host) && module->req.state == STATE_TRY_SOCK_CONNECT) {
-				if (server_ip == 0) { /* Host was not found or was not reachable. */ 
-					printf("HTTTP LOG5\r\n");
-					_http_client_clear_conn(module, -EHOSTUNREACH);
-					return;
-				}
-				addr_in.sin_family = AF_INET;
-				addr_in.sin_port = _htons(module->config.port);
-				addr_in.sin_addr.s_addr = server_ip;
-				connect(module->sock, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
-				return;
+	if (http_client_pool_timer_id < 0) {
+		return;
+	}
+	for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+		if (http_client_pool[i].sock >= 0) {
+			remain = (int32_t)(http_client_pool[i].expire - now);
+			if (remain < 0) {
+				remain = 0;
+			}
+			if (delay < 0 || remain < delay) {
+				delay = remain;
 			}
 		}
 	}
+	if (delay < 0) {
+		sw_timer_disable_callback(http_client_pool_timer_inst, http_client_pool_timer_id);
+	} else {
+		sw_timer_enable_callback(http_client_pool_timer_inst, http_client_pool_timer_id, (uint32_t)delay);
+	}
 }
 
-void http_client_timer_callback(struct sw_timer_module *const module, int timer_id, void *context, int period)
+/**
+ * \brief Close the connections in the pool which were expired.
+ *
+ * \param[in]  now             Current time. See \ref sw_timer_get_time.
+ */
+static void _http_client_pool_reap(uint32_t now)
 {
-	struct http_client_module *module_inst = (struct http_client_module *)context;
+	int i;
 
-	/* Checks invalid arguments. */
-	if (module_inst == NULL) {
-		return;
+	for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+		if (http_client_pool[i].sock >= 0 && (int32_t)(http_client_pool[i].expire - now) <= 0) {
+			close(http_client_pool[i].sock);
+			http_client_pool[i].sock = -1;
+		}
 	}
-	printf("HTTTP LOG5\r\n");
-	_http_client_clear_conn(module_inst, -ETIME);
+	_http_client_pool_arm(now);
 }
 
-static int _is_ip(const char *host)
+/**
+ * \brief Timer callback of the connection pool.
+ */
+static void _http_client_pool_timer_callback(struct sw_timer_module *const module, int timer_id, void *context, int period)
 {
-	uint32_t isv6 = 0;
-	char ch;
+	_http_client_pool_reap(sw_timer_get_time(module));
+}
 
-	while (*host != '\0') {
-		ch = *host++;
-		if ((ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F') || ch == ':' || ch == '/') {
-			isv6 = 1;
-		} else if (ch == '.') {
-			if (isv6) {
+/**
+ * \brief Handle the socket event of the connection in the pool.
+ * Any received data or error means that the server closed the idle connection.
+ *
+ * \param[in]  sock            Socket descriptor.
+ * \param[in]  msg_type        Type of the socket event.
+ */
+static void _http_client_pool_event(SOCKET sock, uint8_t msg_type)
+{
+	int i;
+
+	if (msg_type != SOCKET_MSG_RECV) {
+		return;
+	}
+	for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+		if (http_client_pool[i].sock == sock) {
+			close(sock);
+			http_client_pool[i].sock = -1;
+			_http_client_pool_arm(sw_timer_get_time(http_client_pool_timer_inst));
+			return;
+		}
+	}
+}
+
+/**
+ * \brief Move the idle connection of the module to the pool.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ *
+ * \return     0 if the module released the connection, Negative value if the module keeps it.
+ */
+static int _http_client_pool_put(struct http_client_module *const module)
+{
+	struct http_client_pool_entry *entry = NULL;
+	uint32_t now, timeout;
+	int i;
+
+	if (!module->permanent || module->waiting_response || module->req.state != STATE_SOCK_CONNECTED
+		|| module->recved_size > 0) {
+		return -1;
+	}
+
+	if (module->keep_alive_max == 0) {
+		/* Server does not allow more requests. */
+		_http_client_clear_conn(module, 0);
+		return 0;
+	}
+
+	if (http_client_pool_timer_inst == NULL) {
+		/* First use of the pool. */
+		for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+			http_client_pool[i].sock = -1;
+		}
+		/* The pool works without the timer, but the expired connections are closed only when the pool is accessed. */
+		http_client_pool_timer_inst = module->config.timer_inst;
+		/* One shot. It is started for the connection which expires first. */
+		http_client_pool_timer_id = sw_timer_register_callback(http_client_pool_timer_inst,
+			_http_client_pool_timer_callback, NULL, 0);
+	}
+
+	now = sw_timer_get_time(module->config.timer_inst);
+	_http_client_pool_reap(now);
+	for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+		if (http_client_pool[i].sock < 0) {
+			entry = &http_client_pool[i];
+			break;
+		}
+	}
+	if (entry == NULL) {
+		/* Pool is full. The module keeps its connection. */
+		return -1;
+	}
+
+	/* Stop using the connection a second before the server closes it. */
+	timeout = HTTP_CLIENT_POOL_IDLE_TIMEOUT;
+	if (module->keep_alive_timeout > 1) {
+		timeout = (module->keep_alive_timeout - 1) * 1000;
+	}
+
+	entry->sock = module->sock;
+	entry->tls = module->config.tls;
+	entry->port = module->config.port;
+	entry->remain = module->keep_alive_max;
+	entry->expire = now + timeout;
+	strcpy(entry->host, module->host);
+	_http_client_pool_arm(now);
+
+	/* Detach the connection from the module. */
+	if (module->config.timeout > 0) {
+		sw_timer_disable_callback(module->config.timer_inst, module->timer_id);
+	}
+	recv(module->sock, http_client_pool_recv_buffer, sizeof(http_client_pool_recv_buffer), 0);
+	module_ref_inst[module->sock] = NULL;
+	module->sock = -1;
+	module->req.state = STATE_INIT;
+	module->permanent = 0;
+	return 0;
+}
+
+/**
+ * \brief Take the idle connection to the server of the module from the pool.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ *
+ * \return     0 if the connection was found, Negative value otherwise.
+ */
+static int _http_client_pool_get(struct http_client_module *const module)
+{
+	struct http_client_pool_entry *entry;
+	uint32_t now;
+	int i;
+
+	if (http_client_pool_timer_inst == NULL) {
+		/* Nothing was put yet. */
+		return -1;
+	}
+
+	now = sw_timer_get_time(module->config.timer_inst);
+	_http_client_pool_reap(now);
+	for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+		entry = &http_client_pool[i];
+		if (entry->sock >= 0 && entry->port == module->config.port && entry->tls == module->config.tls
+			&& !strcmp(entry->host, module->host)) {
+			module->sock = entry->sock;
+			entry->sock = -1;
+			_http_client_pool_arm(now);
+			module_ref_inst[module->sock] = module;
+			module->permanent = 1;
+			module->keep_alive_timeout = 0;
+			/* This request uses one of the allowed requests. */
+			module->keep_alive_max = (entry->remain != 0xFFFF) ? entry->remain - 1 : 0xFFFF;
+			module->send_window = module->config.send_buffer_size * module->config.send_window_max;
+			module->send_inflight = 0;
+			module->send_inflight_count = 0;
+			module->req.state = STATE_SOCK_CONNECTED;
+			/* Receive to the buffer of this module. */
+			_http_client_recv_packet(module);
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/**
+ * \brief Calculate the hash of the host name. (FNV-1a)
+ *
+ * \return     Hash of the host name. It is never zero.
+ */
+static uint32_t _http_client_dns_hash(const char *host)
+{
+	uint32_t hash = 2166136261UL;
+
+	while (*host != '\0') {
+		hash ^= (uint8_t)*host++;
+		hash *= 16777619UL;
+	}
+	return (hash != 0) ? hash : 1;
+}
+
+/**
+ * \brief Find the host name in the DNS cache.
+ *
+ * \param[in]  host            Host name.
+ * \param[in]  now             Current time. See \ref sw_timer_get_time.
+ *
+ * \return     Entry of the host. NULL if it is not cached or expired.
+ */
+static struct http_client_dns_entry *_http_client_dns_lookup(const char *host, uint32_t now)
+{
+	struct http_client_dns_entry *entry;
+	uint32_t hash = _http_client_dns_hash(host);
+	int i;
+
+	for (i = 0; i < HTTP_CLIENT_DNS_CACHE_SIZE; i++) {
+		entry = &http_client_dns_cache[i];
+		if (entry->hash == hash && !strcmp(entry->host, host)) {
+			if ((int32_t)(entry->expire - now) <= 0) {
+				entry->hash = 0;
+				return NULL;
+			}
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Store the result of the resolution in the DNS cache.
+ *
+ * The entry of the same host, An empty entry or the entry which is expired first is replaced.
+ *
+ * \param[in]  host            Host name.
+ * \param[in]  ip              Address of the host. Zero if the host was not found.
+ * \param[in]  now             Current time. See \ref sw_timer_get_time.
+ */
+static void _http_client_dns_store(const char *host, uint32_t ip, uint32_t now)
+{
+	struct http_client_dns_entry *entry = NULL, *candidate;
+	uint32_t hash = _http_client_dns_hash(host);
+	int i;
+
+	if (strlen(host) >= HOSTNAME_MAX_SIZE) {
+		return;
+	}
+	for (i = 0; i < HTTP_CLIENT_DNS_CACHE_SIZE; i++) {
+		candidate = &http_client_dns_cache[i];
+		if (candidate->hash == hash && !strcmp(candidate->host, host)) {
+			entry = candidate;
+			break;
+		}
+		if (entry == NULL || (entry->hash != 0 && (candidate->hash == 0
+			|| (int32_t)(candidate->expire - entry->expire) < 0))) {
+			entry = candidate;
+		}
+	}
+
+	entry->hash = hash;
+	entry->ip = ip;
+	entry->expire = now + ((ip != 0) ? HTTP_CLIENT_DNS_CACHE_TTL : HTTP_CLIENT_DNS_NEGATIVE_TTL);
+	strcpy(entry->host, host);
+}
+
+/**
+ * \brief Remove the host name from the DNS cache. It is used when the cached address is not reachable.
+ */
+static void _http_client_dns_remove(const char *host)
+{
+	uint32_t hash = _http_client_dns_hash(host);
+	int i;
+
+	for (i = 0; i < HTTP_CLIENT_DNS_CACHE_SIZE; i++) {
+		if (http_client_dns_cache[i].hash == hash && !strcmp(http_client_dns_cache[i].host, host)) {
+			http_client_dns_cache[i].hash = 0;
+		}
+	}
+}
+
+/**
+ * \brief Calculate the hash of the response cache key. (FNV-1a)
+ */
+static uint32_t _http_client_response_cache_hash(const char *host, const char *uri)
+{
+	uint32_t hash = 2166136261UL;
+
+	while (*host != '\0') {
+		hash ^= (uint8_t)*host++;
+		hash *= 16777619UL;
+	}
+	while (*uri != '\0') {
+		hash ^= (uint8_t)*uri++;
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+/**
+ * \brief Find the response of the URL in the response cache.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  host            Host name of the URL.
+ * \param[in]  uri             URI of the URL. It starts with '/'.
+ *
+ * \return     Record of the response. NULL if it is not cached.
+ */
+static struct http_client_response_record *_http_client_response_cache_find(struct http_client_module *const module,
+	const char *host, const char *uri)
+{
+	struct http_client_response_record *record;
+	uint32_t hash = _http_client_response_cache_hash(host, uri);
+	uint32_t offset;
+	size_t host_length = strlen(host), uri_length = strlen(uri);
+	const char *key;
+
+	for (offset = 0; offset < module->response_cache_used; offset += record->size) {
+		record = (struct http_client_response_record *)(module->response_cache + offset);
+		key = (const char *)(record + 1);
+		if (record->hash == hash && record->host_length == host_length && record->key_length == host_length + uri_length
+			&& !memcmp(key, host, host_length) && !memcmp(key + host_length, uri, uri_length)) {
+			return record;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Remove the record from the response cache. The following records are moved forward.
+ */
+static void _http_client_response_cache_remove(struct http_client_module *const module,
+	struct http_client_response_record *record)
+{
+	char *start = (char *)record;
+	char *end = module->response_cache + module->response_cache_used;
+	uint32_t size = record->size;
+
+	memmove(start, start + size, end - (start + size));
+	module->response_cache_used -= size;
+}
+
+/**
+ * \brief Keep the received response in the response cache if its freshness lifetime is known.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  content         Entity of the response. Its length is resp.content_length.
+ */
+static void _http_client_response_cache_store(struct http_client_module *const module, const char *content)
+{
+	struct http_client_resp *const resp = &module->resp;
+	struct http_client_response_record *record, *victim;
+	const char *uri;
+	uint32_t lifetime, size, offset, now;
+	size_t host_length, uri_length;
+	int method;
+
+	if (module->response_cache == NULL || resp->response_code != 200 || resp->no_store) {
+		return;
+	}
+
+	if (module->pipeline_count > 0) {
+		method = module->pipeline[module->pipeline_head].method;
+		uri = module->pipeline[module->pipeline_head].uri;
+	} else {
+		if (module->req.range_requested) {
+			return;
+		}
+		method = module->req.method;
+		uri = module->req.uri;
+	}
+	if (method != HTTP_METHOD_GET) {
+		return;
+	}
+
+	/* max-age overrides Expires. The response without the explicit lifetime is not kept. */
+	if (resp->has_max_age) {
+		lifetime = resp->max_age;
+	} else if (resp->expires != 0 && resp->date != 0) {
+		lifetime = (resp->expires > resp->date) ? resp->expires - resp->date : 0;
+	} else {
+		return;
+	}
+	if (lifetime <= resp->age) {
+		return;
+	}
+	lifetime -= resp->age;
+	if (lifetime > HTTP_CLIENT_RESPONSE_CACHE_MAX_AGE) {
+		lifetime = HTTP_CLIENT_RESPONSE_CACHE_MAX_AGE;
+	}
+
+	host_length = strlen(module->host);
+	uri_length = strlen(uri);
+	size = (sizeof(struct http_client_response_record) + host_length + uri_length + resp->content_length + 3) & ~3UL;
+	if (size > module->config.response_cache_size) {
+		return;
+	}
+
+	/* Previous response of the same URL is replaced. */
+	record = _http_client_response_cache_find(module, module->host, uri);
+	if (record != NULL) {
+		_http_client_response_cache_remove(module, record);
+	}
+
+	/* Expired responses are removed first, And then the least recently used ones. */
+	now = sw_timer_get_time(module->config.timer_inst);
+	while (module->response_cache_used + size > module->config.response_cache_size) {
+		victim = NULL;
+		for (offset = 0; offset < module->response_cache_used; offset += record->size) {
+			record = (struct http_client_response_record *)(module->response_cache + offset);
+			if ((int32_t)(record->expire - now) <= 0) {
+				victim = record;
+				break;
+			}
+			if (victim == NULL || (int32_t)(record->last_used - victim->last_used) < 0) {
+				victim = record;
+			}
+		}
+		_http_client_response_cache_remove(module, victim);
+	}
+
+	record = (struct http_client_response_record *)(module->response_cache + module->response_cache_used);
+	record->size = size;
+	record->hash = _http_client_response_cache_hash(module->host, uri);
+	record->expire = now + lifetime * 1000;
+	record->last_used = ++module->response_cache_clock;
+	record->content_length = resp->content_length;
+	record->key_length = (uint16_t)(host_length + uri_length);
+	record->host_length = (uint8_t)host_length;
+	memcpy((char *)(record + 1), module->host, host_length);
+	memcpy((char *)(record + 1) + host_length, uri, uri_length);
+	memcpy((char *)(record + 1) + record->key_length, content, resp->content_length);
+	module->response_cache_used += size;
+}
+
+/**
+ * \brief Answer the GET request from the response cache.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  host            Host name of the URL.
+ * \param[in]  uri             URI of the URL. It starts with '/'.
+ *
+ * \return     1 if the response was reported to the application, 0 otherwise.
+ */
+static int _http_client_response_cache_answer(struct http_client_module *const module, const char *host, const char *uri)
+{
+	struct http_client_response_record *record;
+	union http_client_data data;
+
+	record = _http_client_response_cache_find(module, host, uri);
+	if (record != NULL && (int32_t)(record->expire - sw_timer_get_time(module->config.timer_inst)) <= 0) {
+		_http_client_response_cache_remove(module, record);
+		record = NULL;
+	}
+	if (record == NULL) {
+		module->response_cache_misses++;
+		return 0;
+	}
+
+	module->response_cache_hits++;
+	record->last_used = ++module->response_cache_clock;
+	if (module->cb) {
+		memset(&data, 0, sizeof(data));
+		data.recv_response.response_code = 200;
+		data.recv_response.content_length = record->content_length;
+		data.recv_response.content = (char *)(record + 1) + record->key_length;
+		module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
+	}
+	return 1;
+}
+
+static int _is_ip(const char *host)
+{
+	uint32_t isv6 = 0;
+	char ch;
+
+	while (*host != '\0') {
+		ch = *host++;
+		if ((ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F') || ch == ':' || ch == '/') {
+			isv6 = 1;
+		} else if (ch == '.') {
+			if (isv6) {
 				return 0;
 			}
 		} else if ((ch & 0x30) != 0x30) {
@@ -413,20 +1243,442 @@ static int _is_ip(const char *host)
 	return 1;
 }
 
-int http_client_send_request(struct http_client_module *const module, const char *url,
-	enum http_method method, struct http_entity *const entity, const char *ext_header)
+/**
+ * \brief Open the connection to the host of the module.
+ *
+ * The idle connection in the pool is used if it is exist.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ *
+ * \return     0 if success, -ENOSPC if the socket is not available.
+ */
+static int _http_client_open(struct http_client_module *const module)
 {
 	uint8_t flag = 0;
 	struct sockaddr_in addr_in;
-	const char *uri = NULL;
-	int i = 0, j = 0, reconnect = 0;
+	struct http_client_dns_entry *dns = NULL;
+	int i;
 
+	if (_http_client_pool_get(module) == 0) {
+		/* Idle connection to the same server is reused. */
+		module->timing.reused = 1;
+		module->req.state = STATE_REQ_SEND_HEADER;
+		if (module->config.timeout > 0) {
+			sw_timer_enable_callback(module->config.timer_inst, module->timer_id, module->config.timeout);
+		}
+		_http_client_request(module);
+		return 0;
+	}
+	if (!_is_ip(module->host)) {
+		dns = _http_client_dns_lookup(module->host, sw_timer_get_time(module->config.timer_inst));
+		if (dns != NULL && dns->ip == 0) {
+			/* Host was not found recently. */
+			return -EHOSTUNREACH;
+		}
+	}
+	if (module->config.tls) {
+		flag |= SOCKET_FLAGS_SSL;
+	}
+	module->sock = socket(AF_INET, SOCK_STREAM, flag);
+	if (module->sock < 0) {
+		return -ENOSPC;
+	}
+	module_ref_inst[module->sock] = module;
+	module->req.state = STATE_TRY_SOCK_CONNECT;
+
+	addr_in.sin_family = AF_INET;
+	addr_in.sin_port = _htons(module->config.port);
+	if (_is_ip(module->host)) {
+		addr_in.sin_addr.s_addr = nmi_inet_addr((char *)module->host);
+		_http_client_timing_mark(module, HTTP_CLIENT_PHASE_RESOLVE);
+		connect(module->sock, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
+	} else if (dns != NULL) {
+		addr_in.sin_addr.s_addr = dns->ip;
+		_http_client_timing_mark(module, HTTP_CLIENT_PHASE_RESOLVE);
+		connect(module->sock, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
+	} else {
+		module->resolving = 1;
+		http_client_dns_timer_inst = module->config.timer_inst;
+		/* Only one query is sent for the host even if several modules are waiting it. */
+		for (i = 0; i < TCP_SOCK_MAX; i++) {
+			if (module_ref_inst[i] != NULL && module_ref_inst[i] != module && module_ref_inst[i]->resolving
+				&& !strcmp(module_ref_inst[i]->host, module->host)) {
+				break;
+			}
+		}
+		if (i == TCP_SOCK_MAX) {
+			gethostbyname((uint8*)module->host);
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief Check the request can be pipelined.
+ *
+ * Only the idempotent requests which can be sent again without side effect are pipelined.
+ */
+static int _http_client_pipeline_allowed(struct http_client_module *const module, enum http_method method,
+	struct http_entity *const entity, const struct http_client_range *range)
+{
+	if (module->config.pipeline_depth == 0 || entity != NULL || range != NULL) {
+		return 0;
+	}
+	return (method == HTTP_METHOD_GET || method == HTTP_METHOD_HEAD || method == HTTP_METHOD_OPTIONS);
+}
+
+/**
+ * \brief Add the request to the tail of the pipeline queue.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  method          Method of the request.
+ * \param[in]  uri             URI of the request.
+ * \param[in]  ext_header      Extension header of the request. It can be NULL.
+ *
+ * \return     0 if success, -ENOMEM if the memory is not enough.
+ */
+static int _http_client_pipeline_push(struct http_client_module *const module, enum http_method method,
+	const char *uri, const char *ext_header)
+{
+	struct http_client_pipeline_entry *entry;
+
+	entry = &module->pipeline[(module->pipeline_head + module->pipeline_count) % module->config.pipeline_depth];
+	entry->uri = _http_client_alloc(module->config.string_pool, strlen(uri) + 2);
+	if (entry->uri == NULL) {
+		return -ENOMEM;
+	}
+	if (uri[0] == '/') {
+		strcpy(entry->uri, uri);
+	} else {
+		entry->uri[0] = '/';
+		strcpy(entry->uri + 1, uri);
+	}
+	entry->ext_header = NULL;
+	if (ext_header != NULL) {
+		entry->ext_header = _http_client_strdup(module->config.string_pool, ext_header);
+		if (entry->ext_header == NULL) {
+			_http_client_free(module->config.string_pool, entry->uri);
+			return -ENOMEM;
+		}
+	}
+	entry->method = (uint8_t)method;
+	module->pipeline_count++;
+	return 0;
+}
+
+/**
+ * \brief Remove the oldest request from the pipeline queue after its response was received.
+ */
+static void _http_client_pipeline_pop(struct http_client_module *const module)
+{
+	struct http_client_pipeline_entry *entry;
+
+	if (module->pipeline_sent == 0) {
+		return;
+	}
+	entry = &module->pipeline[module->pipeline_head];
+	_http_client_free(module->config.string_pool, entry->uri);
+	if (entry->ext_header != NULL) {
+		_http_client_free(module->config.string_pool, entry->ext_header);
+	}
+	module->pipeline_head = (module->pipeline_head + 1) % module->config.pipeline_depth;
+	module->pipeline_count--;
+	module->pipeline_sent--;
+	module->pipeline_retry = 0;
+	if (module->pipeline_count == 0) {
+		module->pipeline_serial = 0;
+	}
+}
+
+void _http_client_pipeline_flush(struct http_client_module *const module)
+{
+	module->pipeline_sent = module->pipeline_count;
+	while (module->pipeline_count > 0) {
+		_http_client_pipeline_pop(module);
+	}
+	module->pipeline_head = 0;
+	module->pipeline_serial = 0;
+}
+
+/**
+ * \brief Pass the next request in the pipeline queue to the request writer.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ *
+ * \return     1 if the request was loaded, 0 if there is no request to send, -ENOMEM if the memory is not enough.
+ */
+static int _http_client_pipeline_load(struct http_client_module *const module)
+{
+	struct http_client_pipeline_entry *entry;
+
+	if (module->pipeline_sent >= module->pipeline_count) {
+		return 0;
+	}
+	if (module->pipeline_serial && module->pipeline_sent > 0) {
+		/* Wait the response of the previous request. */
+		return 0;
+	}
+	entry = &module->pipeline[(module->pipeline_head + module->pipeline_sent) % module->config.pipeline_depth];
+
+	if (module->req.ext_header != NULL) {
+		_http_client_free(module->config.string_pool, module->req.ext_header);
+		module->req.ext_header = NULL;
+	}
+	if (entry->ext_header != NULL) {
+		module->req.ext_header = _http_client_strdup(module->config.string_pool, entry->ext_header);
+		if (module->req.ext_header == NULL) {
+			return -ENOMEM;
+		}
+	}
+	strcpy(module->req.uri, entry->uri);
+	module->req.method = (enum http_method)entry->method;
+	memset(&module->req.entity, 0, sizeof(struct http_entity));
+	module->req.range_requested = 0;
+	module->req.cache_hit = 0;
+	module->req.header_sent = 0;
+	module->pipeline_sent++;
+	return 1;
+}
+
+/**
+ * \brief Close the connection of the module.
+ *
+ * If the server closed the connection before answering all of the pipelined requests,
+ * The rest of them are sent again on a new connection without notifying the application.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  reason          Reason of the disconnection. It is reported if the connection is not opened again.
+ */
+static void _http_client_pipeline_reconnect(struct http_client_module *const module, int reason)
+{
+	if (module->pipeline_count == 0 || module->pipeline_retry >= HTTP_CLIENT_PIPELINE_MAX_RETRY) {
+		_http_client_clear_conn(module, reason);
+		return;
+	}
+	module->pipeline_retry++;
+	if (reason < 0) {
+		/* Server may not handle the pipeline. Send the rest of requests one by one. */
+		module->pipeline_serial = 1;
+	}
+
+	close(module->sock);
+	module_ref_inst[module->sock] = NULL;
+	module->sock = -1;
+	if (module->config.timeout > 0) {
+		sw_timer_disable_callback(module->config.timer_inst, module->timer_id);
+	}
+	module->req.state = STATE_INIT;
+	module->permanent = 0;
+	module->recved_size = 0;
+	module->recv_head = 0;
+	module->send_inflight = 0;
+	module->send_inflight_count = 0;
+	module->pipeline_sent = 0;
+	module->waiting_response = 1;
+	_http_client_reset_response(module);
+
+	if (_http_client_pipeline_load(module) < 0 || _http_client_open(module) < 0) {
+		_http_client_clear_conn(module, reason);
+	}
+}
+
+void http_client_socket_event_handler(SOCKET sock, uint8_t msg_type, void *msg_data)
+{
+	tstrSocketConnectMsg *msg_connect;
+	tstrSocketRecvMsg *msg_recv;
+	int16_t send_ret;
+	union http_client_data data;
+
+	/* Find instance using the socket descriptor. */
+	struct http_client_module *module = module_ref_inst[sock];
+	/* If cannot found reference, This socket is not HTTP client socket or it is in the pool. */
 	if (module == NULL) {
-		return -EINVAL;
+		_http_client_pool_event(sock, msg_type);
+		return;
+	}
+	switch (msg_type) {
+	case SOCKET_MSG_CONNECT:
+    	msg_connect = (tstrSocketConnectMsg*)msg_data;
+    	data.sock_connected.result = msg_connect->s8Error;
+    	if (msg_connect->s8Error < 0) {
+			/* Cached address can be changed. It is resolved again in the next try. */
+			_http_client_dns_remove(module->host);
+			/* Remove reference. */
+			_http_client_clear_conn(module, _hwerr_to_stderr(msg_connect->s8Error));
+		} else {
+			_http_client_timing_mark(module, HTTP_CLIENT_PHASE_CONNECT);
+			/* Send event to callback. */
+			if (module->cb != NULL) {
+				module->cb(module, HTTP_CLIENT_CALLBACK_SOCK_CONNECTED, &data);
+			}
+			module->req.state = STATE_REQ_SEND_HEADER;
+			module->keep_alive_timeout = 0;
+			module->keep_alive_max = 0xFFFF;
+			/* New connection starts with the full send window. */
+			module->send_window = module->config.send_buffer_size * module->config.send_window_max;
+			module->send_inflight = 0;
+			module->send_inflight_count = 0;
+			/* Start timer. */
+			if (module->config.timeout > 0) {
+				sw_timer_enable_callback(module->config.timer_inst, module->timer_id, module->config.timeout);
+			}
+    		/* Start receive packet. */
+    		_http_client_recv_packet(module);
+			/* Try to check the FSM. */
+			_http_client_request(module);
+		}
+    	break;
+	case SOCKET_MSG_RECV:
+    	msg_recv = (tstrSocketRecvMsg*)msg_data;
+    	/* Start post processing. */
+    	if (msg_recv->s16BufferSize > 0) {
+    		_http_client_recved_packet(module, msg_recv->s16BufferSize);
+		} else {
+			/* Socket was occurred errors. Close this session. */
+			_http_client_pipeline_reconnect(module, _hwerr_to_stderr(msg_recv->s16BufferSize));
+		}
+		if (module_ref_inst[sock] != module || module->req.state == STATE_TRY_SOCK_CONNECT) {
+			/* Session was closed or it is opened again. */
+			break;
+		}
+		if (_http_client_pool_put(module) == 0) {
+			/*
+			 * Response was finished. The idle connection is parked in the pool until the next request,
+			 * or closed if the server does not allow more requests.
+			 */
+			break;
+		}
+		/* COntinue to receive the packet. */
+		_http_client_recv_packet(module);
+		break;
+	case SOCKET_MSG_SEND:
+		send_ret = *(int16_t*)msg_data;
+		if (send_ret < 0) {
+			/* Send failed. */
+			_http_client_clear_conn(module, _hwerr_to_stderr(send_ret));
+			break;
+		}
+		if (module->send_inflight_count == 0) {
+			/* Not our packet. */
+			break;
+		}
+		/* Completions are received in order of the send. */
+		module->send_inflight_count--;
+		if (module->config.timeout > 0 && module->req.state > STATE_SOCK_CONNECTED) {
+			/* Request is progressing. The timeout is counted from the last completion. */
+			sw_timer_enable_callback(module->config.timer_inst, module->timer_id, module->config.timeout);
+		}
+		if (module->send_inflight_count == 0 || module->send_inflight < (uint32_t)send_ret) {
+			module->send_inflight = 0;
+		} else {
+			module->send_inflight -= send_ret;
+		}
+		/* Grow the window about one packet per window. */
+		if (module->send_window < module->config.send_buffer_size * module->config.send_window_max) {
+			module->send_window += module->config.send_buffer_size * module->config.send_buffer_size / module->send_window;
+			if (module->send_window > module->config.send_buffer_size * module->config.send_window_max) {
+				module->send_window = module->config.send_buffer_size * module->config.send_window_max;
+			}
+		}
+		/* Try to check the FSM. */
+		_http_client_request(module);
+    	break;
+	default:
+		break;
 	}
 
-	if (module->req.state > STATE_SOCK_CONNECTED) {
-		return -EBUSY;
+}
+
+void http_client_socket_resolve_handler(uint8_t *doamin_name, uint32_t server_ip)
+{
+	int i;
+	struct http_client_module *module;
+	struct sockaddr_in addr_in;
+
+	if (http_client_dns_timer_inst != NULL) {
+		_http_client_dns_store((const char *)doamin_name, server_ip, sw_timer_get_time(http_client_dns_timer_inst));
+	}
+
+	/* Several modules can wait for the same host. All of them are connected by one result. */
+	for (i = 0; i < TCP_SOCK_MAX; i++) {
+		if (module_ref_inst[i] != NULL) {
+			module = module_ref_inst[i];
+			if (module->resolving && !strcmp((const char*)doamin_name, module->host) && module->req.state == STATE_TRY_SOCK_CONNECT) {
+				module->resolving = 0;
+				if (server_ip == 0) { /* Host was not found or was not reachable. */ 
+					_http_client_clear_conn(module, -EHOSTUNREACH);
+					continue;
+				}
+				addr_in.sin_family = AF_INET;
+				addr_in.sin_port = _htons(module->config.port);
+				addr_in.sin_addr.s_addr = server_ip;
+				_http_client_timing_mark(module, HTTP_CLIENT_PHASE_RESOLVE);
+				connect(module->sock, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
+			}
+		}
+	}
+}
+
+void http_client_timer_callback(struct sw_timer_module *const module, int timer_id, void *context, int period)
+{
+	struct http_client_module *module_inst = (struct http_client_module *)context;
+
+	/* Checks invalid arguments. */
+	if (module_inst == NULL) {
+		return;
+	}
+	_http_client_clear_conn(module_inst, -ETIME);
+}
+
+/**
+ * \brief Serialize the default headers of the current host.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ *
+ * \return     0 if success, -ENOSPC if the headers are bigger than the template buffer.
+ */
+static int _http_client_build_header_template(struct http_client_module *const module)
+{
+	struct http_client_config *config = &module->config;
+	char *buffer = module->header_template;
+	int length;
+
+	length = snprintf(buffer, HTTP_MAX_HEADER_TEMPLATE_LENGTH, "%s%s%s%s%sHost: %s\r\n%s%s",
+		(config->default_headers & HTTP_CLIENT_HEADER_CACHE_CONTROL) ? "cache-control: no-cache\r\n" : "",
+		(config->default_headers & HTTP_CLIENT_HEADER_USER_AGENT) ? "User-Agent: " : "",
+		(config->default_headers & HTTP_CLIENT_HEADER_USER_AGENT) ? config->user_agent : "",
+		(config->default_headers & HTTP_CLIENT_HEADER_USER_AGENT) ? "\r\n" : "",
+		(config->default_headers & HTTP_CLIENT_HEADER_ACCEPT) ? "Accept: */*\r\n" : "",
+		module->host,
+		/* Compressed response can be received only if the decoder is enabled. */
+		((config->default_headers & HTTP_CLIENT_HEADER_ACCEPT_ENCODING) && module->inflate != NULL) ? "accept-encoding: gzip, deflate\r\n" : "",
+		(config->default_headers & HTTP_CLIENT_HEADER_CONNECTION) ? "Connection: keep-alive\r\n" : "");
+	if (length < 0 || length >= HTTP_MAX_HEADER_TEMPLATE_LENGTH) {
+		module->header_template_length = 0;
+		return -ENOSPC;
+	}
+
+	module->header_template_length = (uint16_t)length;
+	return 0;
+}
+
+int http_client_send_request(struct http_client_module *const module, const char *url,
+	enum http_method method, struct http_entity *const entity, const char *ext_header)
+{
+	return http_client_send_request_range(module, url, method, entity, ext_header, NULL);
+}
+
+int http_client_send_request_range(struct http_client_module *const module, const char *url,
+	enum http_method method, struct http_entity *const entity, const char *ext_header,
+	const struct http_client_range *range)
+{
+	struct http_client_response_record *record;
+	const char *uri = NULL;
+	char host[HOSTNAME_MAX_SIZE];
+	int i = 0, j = 0, reconnect = 0, pipelined, result;
+
+	if (module == NULL) {
+		return -EINVAL;
 	}
 
 	/* Separate host and uri */
@@ -435,16 +1687,17 @@ int http_client_send_request(struct http_client_module *const module, const char
 	} else if (!strncmp(url, "https://", 8)) {
 		i = 8;
 	}
-	reconnect = strncmp(module->host, url + i, strlen(module->host));
-
 	for (; url[i] != '\0' && url[i] != '/'; i++) {
-		module->host[j++] = url[i];
+		if (j >= HOSTNAME_MAX_SIZE - 1) {
+			return -ENAMETOOLONG;
+		}
+		host[j++] = url[i];
 	}
-	module->host[j] = '\0';
+	host[j] = '\0';
 	uri = url + i;
 
 	/* Checks the parameters. */
-	if (strlen(module->host) == 0) {
+	if (j == 0) {
 		return -EINVAL;
 	}
 
@@ -452,11 +1705,69 @@ int http_client_send_request(struct http_client_module *const module, const char
 		return -ENAMETOOLONG;
 	}
 
+	if (range != NULL && range->validator != NULL && strlen(range->validator) >= HTTP_MAX_HEADER_VALUE_LENGTH) {
+		return -ENAMETOOLONG;
+	}
+
+	if (module->response_cache != NULL) {
+		if (method == HTTP_METHOD_GET && entity == NULL && range == NULL && module->pipeline_count == 0
+			&& !module->waiting_response && module->req.state <= STATE_SOCK_CONNECTED) {
+			if (_http_client_response_cache_answer(module, host, (uri[0] != '\0') ? uri : "/")) {
+				return 0;
+			}
+		} else if (method != HTTP_METHOD_GET && method != HTTP_METHOD_HEAD && method != HTTP_METHOD_OPTIONS) {
+			/* Resource can be changed by this request. */
+			record = _http_client_response_cache_find(module, host, (uri[0] != '\0') ? uri : "/");
+			if (record != NULL) {
+				_http_client_response_cache_remove(module, record);
+			}
+		}
+	}
+
+	pipelined = _http_client_pipeline_allowed(module, method, entity, range);
+	if (module->pipeline_count > 0) {
+		/* Only the request which can be pipelined to the same server is queued. */
+		if (!pipelined || strcmp(module->host, host) || module->pipeline_count >= module->config.pipeline_depth) {
+			return -EAGAIN;
+		}
+		result = _http_client_pipeline_push(module, method, uri, ext_header);
+		if (result == 0 && module->req.state == STATE_SOCK_CONNECTED) {
+			/* All of the previous requests were sent. Send it immediately. */
+			_http_client_request(module);
+		}
+		return result;
+	}
+
+	if (module->req.state > STATE_SOCK_CONNECTED) {
+		return -EBUSY;
+	}
+
+	if (pipelined && module->waiting_response) {
+		/* Response of the previous request cannot be matched with the pipeline. */
+		return -EAGAIN;
+	}
+
+	reconnect = strcmp(module->host, host);
+	if (reconnect) {
+		if (module->req.state >= STATE_TRY_SOCK_CONNECT
+			&& (module->req.state != STATE_SOCK_CONNECTED || _http_client_pool_put(module) < 0)) {
+			/* Request to another peer. Disconnect and try connect again. */
+			_http_client_clear_conn(module, 0);
+		}
+		/* Host was changed. Default headers must be serialized again. */
+		strcpy(module->host, host);
+		module->header_template_length = 0;
+	}
+
+	if (module->header_template_length == 0 && _http_client_build_header_template(module) < 0) {
+		return -ENAMETOOLONG;
+	}
+
 	if (module->req.ext_header != NULL) {
-		free(module->req.ext_header);
+		_http_client_free(module->config.string_pool, module->req.ext_header);
 	}
 	if (ext_header != NULL) {
-		module->req.ext_header = strdup(ext_header);
+		module->req.ext_header = _http_client_strdup(module->config.string_pool, ext_header);
 		if (module->req.ext_header == NULL) {
 			return -ENOMEM;
 		}
@@ -464,8 +1775,22 @@ int http_client_send_request(struct http_client_module *const module, const char
 		module->req.ext_header = NULL;
 	}
 
-	module->sending = 0;
+	if (range != NULL) {
+		module->req.range_requested = 1;
+		module->req.range_start = range->start;
+		module->req.range_length = range->length;
+		if (range->validator != NULL) {
+			strcpy(module->req.if_range, range->validator);
+		} else {
+			module->req.if_range[0] = '\0';
+		}
+	} else {
+		module->req.range_requested = 0;
+	}
+
+	module->req.header_sent = 0;
 	module->recved_size = 0;
+	module->recv_head = 0;
 	if (uri[0] == '/') {
 		strcpy(module->req.uri, uri);
 		} else {
@@ -482,42 +1807,43 @@ int http_client_send_request(struct http_client_module *const module, const char
 	}
 
 	module->req.method = method;
+
+	module->req.cache_hit = 0;
+	if (module->config.cache != NULL && method == HTTP_METHOD_GET && entity == NULL && range == NULL && !pipelined
+		&& http_cache_lookup(module->config.cache, url, module->cache_entry) == 0) {
+		/* Server responds 304 if the cached file is still valid. */
+		module->req.cache_hit = 1;
+	}
+
+	if (pipelined) {
+		/* Keep the request until its response is received. It is sent again if the connection is closed. */
+		result = _http_client_pipeline_push(module, method, uri, ext_header);
+		if (result < 0) {
+			return result;
+		}
+		module->pipeline_sent = 1;
+	}
+	module->waiting_response = 1;
+	_http_client_timing_start(module, HTTP_CLIENT_PHASE_RESOLVE, sw_timer_get_time(module->config.timer_inst));
+	module->timing.reused = (module->req.state == STATE_SOCK_CONNECTED);
 	
 	switch (module->req.state) {
 	case STATE_TRY_SOCK_CONNECT:
-		if (!reconnect) {
-			break; /* Currently try to connect to the same server. */
-		}
+		break; /* Currently try to connect to the same server. */
 	case STATE_SOCK_CONNECTED:
-		if (!reconnect) {
-			module->req.state = STATE_REQ_SEND_HEADER;
-			/* Send request immediately. */
-			_http_client_request(module);
-			break;
-		} else {
-			printf("HTTTP LOG6\r\n");
-			/* Request to another peer. Disconnect and try connect again. */
-			_http_client_clear_conn(module, 0);
-		}
-	case STATE_INIT:
-		if (module->config.tls) {
-			flag |= SOCKET_FLAGS_SSL;
-		}
-		module->sock = socket(AF_INET, SOCK_STREAM, flag);
-		if (module->sock >= 0) {
-			module_ref_inst[module->sock] = module;
-			
-			if (_is_ip(module->host)) {
-				addr_in.sin_family = AF_INET;
-				addr_in.sin_port = _htons(module->config.port);
-				addr_in.sin_addr.s_addr = nmi_inet_addr((char *)module->host);
-				connect(module->sock, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
-			} else {
-				gethostbyname((uint8*)module->host);
-			}
-			module->req.state = STATE_TRY_SOCK_CONNECT;
-		} else {
-			return -ENOSPC;
+		module->req.state = STATE_REQ_SEND_HEADER;
+		if (module->config.timeout > 0) {
+			sw_timer_enable_callback(module->config.timer_inst, module->timer_id, module->config.timeout);
+		}
+		/* Send request immediately. */
+		_http_client_request(module);
+		break;
+	case STATE_INIT:
+		result = _http_client_open(module);
+		if (result < 0) {
+			_http_client_pipeline_flush(module);
+			module->waiting_response = 0;
+			return result;
 		}
 		break;
 	default:
@@ -531,16 +1857,62 @@ int http_client_send_request(struct http_client_module *const module, const char
 	return 0;
 }
 
+void http_client_print_timing(struct http_client_module *const module)
+{
+	static const char *const phase_names[HTTP_CLIENT_PHASE_MAX] = {
+		"resolve", "connect", "header", "entity", "wait", "receive", "total"
+	};
+	struct http_client_timing_stats *stats;
+	int i, j;
+
+	if (module == NULL) {
+		return;
+	}
+
+	stats = &module->timing_stats;
+	printf("http_client: %lu completed, %lu failed, %lu bytes sent, %lu bytes received\r\n",
+		(unsigned long)stats->completed, (unsigned long)stats->failed,
+		(unsigned long)stats->bytes_sent, (unsigned long)stats->bytes_received);
+	printf("http_client: %lu bytes read from the socket, %lu bytes copied in the receive buffer\r\n",
+		(unsigned long)module->recv_total, (unsigned long)module->recv_copied);
+	/* Lower bound of each bucket in milliseconds. */
+	printf("phase       avg    max |");
+	for (j = 0; j < HTTP_CLIENT_TIMING_BUCKETS; j++) {
+		printf("%6lu", (j == 0) ? 0UL : 1UL << (j - 1));
+	}
+	printf("\r\n");
+	for (i = 0; i < HTTP_CLIENT_PHASE_MAX; i++) {
+		printf("%-8s %6lu %6lu |", phase_names[i],
+			(unsigned long)((stats->completed > 0) ? stats->sum[i] / stats->completed : 0), (unsigned long)stats->max[i]);
+		for (j = 0; j < HTTP_CLIENT_TIMING_BUCKETS; j++) {
+			printf("%6u", (unsigned int)stats->histogram[i][j]);
+		}
+		printf("\r\n");
+	}
+}
+
+void http_client_reset_timing(struct http_client_module *const module)
+{
+	if (module == NULL) {
+		return;
+	}
+
+	memset(&module->timing_stats, 0, sizeof(struct http_client_timing_stats));
+	module->recv_total = 0;
+	module->recv_copied = 0;
+}
+
 int http_client_close(struct http_client_module *const module)
 {
 	if (module == NULL) {
 		return -EINVAL;
 	}
 
-	if (module->req.state < STATE_SOCK_CONNECTED) {
+	if (module->req.state < STATE_TRY_SOCK_CONNECT) {
 		return 0;
 	}
 
+	/* The socket which is connecting is also closed. */
 	_http_client_clear_conn(module, 0);
 
 	return 0;
@@ -548,7 +1920,6 @@ int http_client_close(struct http_client_module *const module)
 
 void _http_client_clear_conn(struct http_client_module *const module, int reason)
 {
-	printf("_http_client_clear_conn [In] \r\n");
 	union http_client_data data;
 
 	if (module->req.entity.close) {
@@ -560,14 +1931,33 @@ void _http_client_clear_conn(struct http_client_module *const module, int reason
 	if (module->req.state >= STATE_TRY_SOCK_CONNECT) {
 		close(module->sock);
 	}
+	if (module->config.timeout > 0) {
+		sw_timer_disable_callback(module->config.timer_inst, module->timer_id);
+	}
 
-	module_ref_inst[module->sock] = NULL;
+	if (module->sock >= 0 && module_ref_inst[module->sock] == module) {
+		module_ref_inst[module->sock] = NULL;
+	}
+	module->sock = -1;
+	module->resolving = 0;
+	if (module->waiting_response) {
+		/* Request was not completed. */
+		module->timing_stats.failed++;
+	}
+	module->waiting_response = 0;
+	_http_client_pipeline_flush(module);
+	if (module->req.ext_header != NULL) {
+		_http_client_free(module->config.string_pool, module->req.ext_header);
+	}
 	memset(&module->req, 0, sizeof(struct http_client_req));
 	memset(&module->resp, 0, sizeof(struct http_client_resp));
 	module->req.state = STATE_INIT;
 	module->resp.state = STATE_PARSE_HEADER;
 
-	module->sending = 0;
+	module->recved_size = 0;
+	module->recv_head = 0;
+	module->send_inflight = 0;
+	module->send_inflight_count = 0;
 	module->permanent = 0;
 	data.disconnected.reason = reason;
 	if (module->cb) {
@@ -575,21 +1965,32 @@ void _http_client_clear_conn(struct http_client_module *const module, int reason
 	}
 }
 
-int _http_client_send_wait(void *_module, char *buffer, size_t buffer_len)
+int _http_client_send_header(void *priv, char *buffer, size_t buffer_len)
 {
+	struct http_client_header_writer *ctx = (struct http_client_header_writer *)priv;
+	struct http_client_module *const module = ctx->module;
 	int result;
-	struct http_client_module *const module = (struct http_client_module *const)_module;
-	
-	module->sending = 1;
+
+	if (ctx->result < 0) {
+		return ctx->result;
+	}
+
+	/* Skip the part which was already sent in the previous try. */
+	if (ctx->skip >= buffer_len) {
+		ctx->skip -= buffer_len;
+		return 0;
+	}
+	buffer += ctx->skip;
+	buffer_len -= ctx->skip;
+	ctx->skip = 0;
 
 	if ((result = send(module->sock, (void*)buffer, buffer_len, 0)) < 0) {
-		module->sending = 0;
+		ctx->result = result;
 		return result;
 	}
-	while (module->sending == 1 && module->req.state > STATE_SOCK_CONNECTED){
-		m2m_wifi_handle_events(NULL);
-		sw_timer_task(module->config.timer_inst);
-	}
+	module->req.header_sent += buffer_len;
+	module->send_inflight += buffer_len;
+	module->send_inflight_count++;
 
 	return 0;
 }
@@ -598,26 +1999,25 @@ int _http_client_send_wait(void *_module, char *buffer, size_t buffer_len)
 void _http_client_request(struct http_client_module *const module)
 {
 	struct stream_writer writer;
-	int size;
+	struct http_client_header_writer header_writer;
+	int size = -1;
+	int length;
 	int result;
-	char length[11];
+	struct stream_writer_iov iov[4];
+	const char *content_type = NULL;
 	char *ptr;
 	const char CH_LUT[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
 	struct http_entity * entity;
 	union http_client_data data;
 #define HTTP_CHUNKED_MAX_LENGTH 3 /*TCP MTU is 1400(0x578) */
-	char buffer[module->config.send_buffer_size];
+	char *buffer;
 
 	if (module == NULL) {
 		return;
 	}
 
-	if (module->sending != 0) {
-		/* Device is busy. */
-		return;
-	}
-
 	entity = &module->req.entity;
+	buffer = module->config.send_buffer;
 
 	switch (module->req.state) {
 	case STATE_REQ_SEND_HEADER:
@@ -625,91 +2025,106 @@ void _http_client_request(struct http_client_module *const module)
 		module->req.content_length = 0;
 		module->req.sent_length = 0;
 
-		stream_writer_init(&writer, buffer, module->config.send_buffer_size, _http_client_send_wait, (void *)module);
-		/* Write Method. */
-		if (module->req.method == HTTP_METHOD_GET) {
-			stream_writer_send_buffer(&writer, "GET ", 4);
-		} else if (module->req.method == HTTP_METHOD_POST) {
-			stream_writer_send_buffer(&writer, "POST ", 5);
-		} else if (module->req.method == HTTP_METHOD_DELETE) {
-			stream_writer_send_buffer(&writer, "DELETE ", 7);
-		} else if (module->req.method == HTTP_METHOD_PUT) {
-			stream_writer_send_buffer(&writer, "PUT ", 4);
-		} else if (module->req.method == HTTP_METHOD_OPTIONS) {
-			stream_writer_send_buffer(&writer, "OPTIONS ", 8);
-		} else if (module->req.method == HTTP_METHOD_HEAD) {
-			stream_writer_send_buffer(&writer, "HEAD ", 5);
-		}
-
-		/* Write URI. */
-		stream_writer_send_buffer(&writer, module->req.uri, strlen(module->req.uri));
-
-		stream_writer_send_buffer(&writer, " "HTTP_PROTO_NAME"\r\n", strlen(" "HTTP_PROTO_NAME"\r\n"));
-		//stream_writer_send_buffer(&writer, HTTP_PROTO_NAME, strlen(HTTP_PROTO_NAME));
-
-		/* Write HTTP headers. */
-		/* Default value. */
-		stream_writer_send_buffer(&writer, "cache-control: no-cache\r\n", strlen("cache-control: no-cache\r\n"));
-		stream_writer_send_buffer(&writer, "Postman-Token: 31447a89-5b5e-4887-a8c8-875aa1561f84\r\n", strlen("Postman-Token: 31447a89-5b5e-4887-a8c8-875aa1561f84\r\n"));
-		
-		stream_writer_send_buffer(&writer, "User-Agent: ", strlen("User-agent: "));
-		printf("user agent=%s, len=%d\r\n", module->config.user_agent, strlen(module->config.user_agent));
-		stream_writer_send_buffer(&writer, (char *)module->config.user_agent, strlen(module->config.user_agent));
-		stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
-		
-		stream_writer_send_buffer(&writer, "Accept: */*\r\n", strlen("Accept: */*\r\n"));
-		
-		stream_writer_send_buffer(&writer, "Host: ", strlen("Host: "));
-		stream_writer_send_buffer(&writer, module->host, strlen(module->host));
-		stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
-		
-		stream_writer_send_buffer(&writer, "accept-encoding: gzip, deflate\r\n", strlen("accept-encoding: gzip, deflate\r\n"));
-		
-		if (entity->read == NULL)
-			stream_writer_send_buffer(&writer, "Content-Length: 0\r\n", strlen("Content-Length: 0\r\n"));
-		
-		/* It supported persistent connection. */
-		//stream_writer_send_buffer(&writer, "Connection: Keep-Alive\r\n", strlen("Connection: Keep-Alive\r\n"));
-		/* Notify supported encoding type and character set. */
-		
-		//stream_writer_send_buffer(&writer, "Accept-Charset: utf-8\r\n", strlen("Accept-Charset: utf-8\r\n"));
-
-		if (entity->read != NULL) {
+		/*
+		 * The header is written without waiting the completion.
+		 * If the socket was full, The header is serialized again at the next completion
+		 * and the part which was already sent is skipped.
+		 */
+		header_writer.module = module;
+		header_writer.skip = module->req.header_sent;
+		header_writer.result = 0;
+		stream_writer_init(&writer, buffer, module->config.send_buffer_size, _http_client_send_header, (void *)&header_writer);
+		/* Write request line and the default headers which were serialized already. */
+		iov[0].buffer = method_names[module->req.method].name;
+		iov[0].length = method_names[module->req.method].length;
+		iov[1].buffer = module->req.uri;
+		iov[1].length = strlen(module->req.uri);
+		iov[2].buffer = " "HTTP_PROTO_NAME"\r\n";
+		iov[2].length = sizeof(" "HTTP_PROTO_NAME"\r\n") - 1;
+		iov[3].buffer = module->header_template;
+		iov[3].length = module->header_template_length;
+		stream_writer_send_iov(&writer, iov, 4);
+
+		if (entity->read == NULL) {
+			stream_writer_send_buffer(&writer, "Content-Length: 0\r\n", sizeof("Content-Length: 0\r\n") - 1);
+		} else {
 			/* HTTP Entity is exist. */
+			if (entity->get_contents_type) {
+				content_type = entity->get_contents_type(entity->priv_data);
+			}
 			if (entity->is_chunked) {
 				/* Chunked mode. */
 				module->req.content_length = -1;
-				stream_writer_send_buffer(&writer, "Transfer-Encoding: chunked\r\n", strlen("Transfer-Encoding: chunked\r\n"));
+				stream_writer_send_buffer(&writer, "Transfer-Encoding: chunked\r\n", sizeof("Transfer-Encoding: chunked\r\n") - 1);
 			} else if(entity->get_contents_length) {
 				module->req.content_length = entity->get_contents_length(entity->priv_data);
-				if (entity->file_format > 0)
-					module->req.content_length = module->req.content_length + entity->file_object.fsize + strlen("----------------------------698985598735098622010494") + 6;
-					
 				if (module->req.content_length < 0) {
 					/* Error was occurred. */
 					/* Does not send any entity. */
 					module->req.content_length = 0;
 				} else {
-					
-					if( entity->get_contents_type )
-					{
-						stream_writer_send_buffer(&writer, "content-type: ", strlen("Content-Type: "));
-						stream_writer_send_buffer(&writer, entity->get_contents_type(entity->priv_data), strlen(entity->get_contents_type(entity->priv_data)));
-						stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
+					/* Format the length directly into the writer buffer. */
+					ptr = stream_writer_reserve(&writer, sizeof("Content-Length: 4294967295\r\n"));
+					if (ptr == NULL) {
+						/* Send buffer is smaller than the header line. */
+						_http_client_clear_conn(module, -EINVAL);
+						return;
 					}
-					
-					sprintf(length, "%u", (unsigned int)module->req.content_length);
-					stream_writer_send_buffer(&writer, "Content-Length: ", strlen("Content-Length: "));
-					stream_writer_send_buffer(&writer, length, strlen(length));
-					stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
-					
-					
-					
-					/* It supported persistent connection. */
-					stream_writer_send_buffer(&writer, "Connection: keep-alive\r\n", strlen("Connection: keep-alive\r\n"));
-					//stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
+					stream_writer_commit(&writer, sprintf(ptr, "Content-Length: %u\r\n", (unsigned int)module->req.content_length));
 				}
 			}
+			if (content_type != NULL) {
+				iov[0].buffer = "Content-Type: ";
+				iov[0].length = sizeof("Content-Type: ") - 1;
+				iov[1].buffer = content_type;
+				iov[1].length = strlen(content_type);
+				iov[2].buffer = "\r\n";
+				iov[2].length = 2;
+				stream_writer_send_iov(&writer, iov, 3);
+			}
+		}
+		if (module->req.range_requested) {
+			ptr = stream_writer_reserve(&writer, sizeof("Range: bytes=4294967295-4294967295\r\n"));
+			if (ptr == NULL) {
+				_http_client_clear_conn(module, -EINVAL);
+				return;
+			}
+			if (module->req.range_length > 0) {
+				length = sprintf(ptr, "Range: bytes=%lu-%lu\r\n", (unsigned long)module->req.range_start,
+					(unsigned long)(module->req.range_start + module->req.range_length - 1));
+			} else {
+				length = sprintf(ptr, "Range: bytes=%lu-\r\n", (unsigned long)module->req.range_start);
+			}
+			stream_writer_commit(&writer, length);
+			if (module->req.if_range[0] != '\0') {
+				iov[0].buffer = "If-Range: ";
+				iov[0].length = sizeof("If-Range: ") - 1;
+				iov[1].buffer = module->req.if_range;
+				iov[1].length = strlen(module->req.if_range);
+				iov[2].buffer = "\r\n";
+				iov[2].length = 2;
+				stream_writer_send_iov(&writer, iov, 3);
+			}
+		}
+		if (module->req.cache_hit) {
+			if (module->cache_entry->etag[0] != '\0') {
+				iov[0].buffer = "If-None-Match: ";
+				iov[0].length = sizeof("If-None-Match: ") - 1;
+				iov[1].buffer = module->cache_entry->etag;
+				iov[1].length = strlen(module->cache_entry->etag);
+				iov[2].buffer = "\r\n";
+				iov[2].length = 2;
+				stream_writer_send_iov(&writer, iov, 3);
+			}
+			if (module->cache_entry->last_modified[0] != '\0') {
+				iov[0].buffer = "If-Modified-Since: ";
+				iov[0].length = sizeof("If-Modified-Since: ") - 1;
+				iov[1].buffer = module->cache_entry->last_modified;
+				iov[1].length = strlen(module->cache_entry->last_modified);
+				iov[2].buffer = "\r\n";
+				iov[2].length = 2;
+				stream_writer_send_iov(&writer, iov, 3);
+			}
 		}
 		if (module->req.ext_header != NULL ) {
 			stream_writer_send_buffer(&writer,
@@ -717,405 +2132,1022 @@ void _http_client_request(struct http_client_module *const module)
 				strlen(module->req.ext_header));
 		}
 
-		//See the module->header
-		stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
-		stream_writer_send_remain(&writer);
+		//See the module->header
+		stream_writer_send_buffer(&writer, "\r\n", strlen("\r\n"));
+		stream_writer_send_remain(&writer);
+
+		if (header_writer.result == SOCK_ERR_BUFFER_FULL && module->send_inflight_count > 0) {
+			/* Try again after the next completion. */
+			return;
+		} else if (header_writer.result < 0) {
+			_http_client_clear_conn(module, _hwerr_to_stderr(header_writer.result));
+			return;
+		}
+
+		module->req.state = STATE_REQ_WAIT_HEADER;
+	case STATE_REQ_WAIT_HEADER:
+		if (module->send_inflight_count > 0) {
+			/* Send buffer is released when all of the header packets are completed. */
+			break;
+		}
+		module->req.state = STATE_REQ_SEND_ENTITY;
+		_http_client_timing_mark(module, HTTP_CLIENT_PHASE_HEADER);
+		/* Send first part of entity. */
+	case STATE_REQ_SEND_ENTITY:
+		if (entity->read == NULL || module->req.content_length == 0) {
+			/* Has not any entity. */
+			module->req.state = STATE_SOCK_CONNECTED;
+			_http_client_timing_mark(module, HTTP_CLIENT_PHASE_ENTITY);
+			if (module->cb) {
+				module->cb(module, HTTP_CLIENT_CALLBACK_REQUESTED, &data);
+			}
+			break;
+		}
+		/* Send packets while the window has a room for the one more packet. */
+		while (module->send_inflight + module->config.send_buffer_size <= module->send_window) {
+			if (module->req.content_length < 0) {
+				/* Send chunked packet. */
+				/*  Chunked header (size + \r\n) tail (\r\n) */
+				size = entity->read(entity->priv_data, buffer + HTTP_CHUNKED_MAX_LENGTH + 2,
+					module->config.send_buffer_size - HTTP_CHUNKED_MAX_LENGTH - 4, module->req.sent_length);
+				if (size < 0) {
+					/* If occurs problem during the operation, Close this socket. */
+					_http_client_clear_conn(module, -EIO);
+					return;
+				}
+				buffer[HTTP_CHUNKED_MAX_LENGTH + 1] = '\n';
+				buffer[HTTP_CHUNKED_MAX_LENGTH] = '\r';
+				buffer[size + HTTP_CHUNKED_MAX_LENGTH + 2] = '\r';
+				buffer[size + HTTP_CHUNKED_MAX_LENGTH + 3] = '\n';
+				if (size >= 0) {
+					ptr = buffer + 2;
+					*ptr = CH_LUT[size % 16];
+				}
+				if (size >= 0x10) {
+					ptr = buffer + 1;
+					*ptr = CH_LUT[(size / 0x10) % 16];
+				}
+				if (size >= 0x100) {
+					ptr = buffer;
+					*ptr = CH_LUT[(size / 0x100) % 16];
+				}
+				length = (buffer + HTTP_CHUNKED_MAX_LENGTH + 2 + size + 2) - ptr;
+			} else {
+				if (module->req.sent_length >= module->req.content_length) {
+					/* Complete to send the buffer. */
+					break;
+				}
+				size = entity->read(entity->priv_data, buffer, module->config.send_buffer_size, module->req.sent_length);
+				if (size <= 0) {
+					/* Entity occurs errors or EOS. */
+					/* Disconnect it. */
+					_http_client_clear_conn(module, (size == 0)?-EBADMSG:-EIO);
+					return;
+				}
+				if (size > module->req.content_length - module->req.sent_length) {
+					size = module->req.content_length - module->req.sent_length;
+				}
+				ptr = buffer;
+				length = size;
+			}
+
+			result = send(module->sock, (void*)ptr, length, 0);
+			if (result == SOCK_ERR_BUFFER_FULL && module->send_inflight_count > 0) {
+				/* WINC is congested. Shrink the window and send this packet again after the next completion. */
+				module->send_window /= 2;
+				if (module->send_window < module->config.send_buffer_size) {
+					module->send_window = module->config.send_buffer_size;
+				}
+				return;
+			} else if (result < 0) {
+				_http_client_clear_conn(module, _hwerr_to_stderr(result));
+				return;
+			}
+			module->send_inflight += length;
+			module->send_inflight_count++;
+			module->req.sent_length += size;
+
+			if (size == 0) {
+				/* Last chunk was sent. */
+				break;
+			}
+		}
+
+		if ((module->req.content_length < 0 && size == 0)
+			|| (module->req.content_length > 0 && module->req.sent_length >= module->req.content_length)) {
+			/* Complete to send the entity. */
+			if (module->req.entity.close) {
+				module->req.entity.close(module->req.entity.priv_data);
+			}
+			module->req.state = STATE_SOCK_CONNECTED;
+			_http_client_timing_mark(module, HTTP_CLIENT_PHASE_ENTITY);
+			if (module->cb) {
+				module->cb(module, HTTP_CLIENT_CALLBACK_REQUESTED, &data);
+			}
+		}
+		break;
+	default:
+		/* Invalid status. */
+		break;
+	}
+
+	/* Write the next pipelined request without waiting the response. Depth is bounded by the pipeline queue. */
+	if (module->req.state == STATE_SOCK_CONNECTED && (result = _http_client_pipeline_load(module)) != 0) {
+		if (result < 0) {
+			_http_client_clear_conn(module, result);
+			return;
+		}
+		module->req.state = STATE_REQ_SEND_HEADER;
+		_http_client_request(module);
+	}
+}
+
+void _http_client_recv_packet(struct http_client_module *const module)
+{
+	uint32_t tail, size;
+
+	if (module == NULL) {
+		return;
+	}
+	
+	if (module->recved_size >= module->config.recv_buffer_size) {
+		/* Has not enough memory. */
+		_http_client_clear_conn(module, -EOVERFLOW);
+		return;
+	}
+
+	if (module->recved_size == 0) {
+		/* Buffer is empty. Receive to the start of the buffer for getting the largest space. */
+		module->recv_head = 0;
+	}
+
+	/* Receive to the largest contiguous free space after the unread data. */
+	tail = module->recv_head + module->recved_size;
+	if (tail >= module->config.recv_buffer_size) {
+		tail -= module->config.recv_buffer_size;
+		size = module->recv_head - tail;
+	} else {
+		size = module->config.recv_buffer_size - tail;
+	}
+	
+	/* Executing read until receiving operation is started. */
+	/*
+	while (recv(module->sock,
+		module->config.recv_buffer + module->recved_size,
+		module->config.recv_buffer_size - module->recved_size, 0) != 0);
+	*/
+	recv(module->sock, module->config.recv_buffer + tail, size, 0);
+}
+
+void _http_client_recved_packet(struct http_client_module *const module, int read_len)
+{
+	module->recved_size += read_len;
+	module->recv_total += read_len;
+	if (module->config.timeout > 0) {
+		sw_timer_disable_callback(module->config.timer_inst, module->timer_id);
+	}
+
+	/* Recursive function call can be occurred overflow. */
+	while(_http_client_handle_response(module) != 0);
+
+	if (module->req.state == STATE_SOCK_CONNECTED) {
+		/* Send the pipelined request which was waiting the response. */
+		_http_client_request(module);
+	}
+}
+
+int _http_client_rx_peek(struct http_client_module *const module, char **data)
+{
+	uint32_t length = module->config.recv_buffer_size - module->recv_head;
+
+	*data = module->config.recv_buffer + module->recv_head;
+	if (length > module->recved_size) {
+		length = module->recved_size;
+	}
+	return (int)length;
+}
+
+void _http_client_rx_consume(struct http_client_module *const module, int length)
+{
+	if ((uint32_t)length >= module->recved_size) {
+		/* Ring can be reset by the request which was sent in the callback. */
+		module->timing.bytes_received += module->recved_size;
+		module->recved_size = 0;
+		module->recv_head = 0;
+		return;
+	}
+	module->timing.bytes_received += length;
+	module->recved_size -= length;
+	module->recv_head += length;
+	if (module->recv_head >= module->config.recv_buffer_size) {
+		module->recv_head -= module->config.recv_buffer_size;
+	}
+}
+
+/**
+ * \brief Reverse the order of bytes in the buffer.
+ */
+static void _http_client_reverse(char *start, char *end)
+{
+	char ch;
+
+	while (start < --end) {
+		ch = *start;
+		*start++ = *end;
+		*end = ch;
+	}
+}
+
+void _http_client_rx_linearize(struct http_client_module *const module)
+{
+	char *buffer = module->config.recv_buffer;
+	uint32_t size = module->config.recv_buffer_size;
+	uint32_t head = module->recv_head;
+	uint32_t first = size - head;
+
+	if (head == 0) {
+		return;
+	}
+
+	if (module->recved_size > first) {
+		/* Data is wrapped. */
+		if (module->recved_size <= head) {
+			/* Free space is enough to hold the first part. */
+			memmove(buffer + first, buffer, module->recved_size - first);
+			memcpy(buffer, buffer + head, first);
+		} else {
+			/* Rotate the whole buffer in place. */
+			_http_client_reverse(buffer, buffer + head);
+			_http_client_reverse(buffer + head, buffer + size);
+			_http_client_reverse(buffer, buffer + size);
+		}
+	} else {
+		memmove(buffer, buffer + head, module->recved_size);
+	}
+	module->recv_copied += module->recved_size;
+	module->recv_head = 0;
+}
+
+int _http_client_handle_response(struct http_client_module *const module)
+{
+	switch(module->resp.state) {
+	case STATE_PARSE_HEADER:
+		if (module->timing.next == HTTP_CLIENT_PHASE_MAX && module->waiting_response) {
+			/* Response of the pipelined request follows the previous one. */
+			_http_client_timing_start(module, HTTP_CLIENT_PHASE_WAIT, module->timing.mark);
+			module->timing.reused = 1;
+		}
+		_http_client_timing_mark(module, HTTP_CLIENT_PHASE_WAIT);
+		return _http_client_handle_header(module);
+	case STATE_PARSE_ENTITY:
+		return _http_client_handle_entity(module);
+	}
+	return 0;
+}
+
+/**
+ * \brief Checks the comma separated header value contains the token.
+ *
+ * \param[in]  value           Header value.
+ * \param[in]  token           Lower case token.
+ *
+ * \return     1 if token is exist, 0 otherwise.
+ */
+static int _http_client_has_token(const char *value, const char *token)
+{
+	const char *ptr;
+	char ch;
+
+	for (;;) {
+		while (*value == ' ' || *value == '\t' || *value == ',') {
+			value++;
+		}
+		if (*value == '\0') {
+			return 0;
+		}
+		/* Compare case-insensitively. */
+		for (ptr = token; *ptr != '\0'; ptr++, value++) {
+			ch = *value;
+			if (ch >= 'A' && ch <= 'Z') {
+				ch += 'a' - 'A';
+			}
+			if (ch != *ptr) {
+				break;
+			}
+		}
+		if (*ptr == '\0' && (*value == '\0' || *value == ',' || *value == ' ' || *value == ';')) {
+			return 1;
+		}
+		while (*value != '\0' && *value != ',') {
+			value++;
+		}
+	}
+}
+
+/**
+ * \brief Parse the Content-Range header. e.g. "bytes 0-499/1234"
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[in]  value           Value of the header.
+ */
+static void _http_client_parse_content_range(struct http_client_module *const module, const char *value)
+{
+	char *end;
+
+	if (strncmp(value, "bytes", 5) != 0) {
+		/* Unknown range unit. */
+		return;
+	}
+	value += 5;
+	while (*value == ' ') {
+		value++;
+	}
+	if (*value != '*') {
+		module->resp.range_start = strtoul(value, &end, 10);
+		value = strchr(end, '/');
+		if (value == NULL) {
+			return;
+		}
+	} else {
+		value++;
+	}
+	if (*value == '/' && value[1] != '*') {
+		module->resp.total_length = strtoul(value + 1, NULL, 10);
+	}
+}
+
+/**
+ * \brief Parse the HTTP-date in the IMF-fixdate format. e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+ *
+ * \param[in]  value           Value of the header.
+ *
+ * \return     Seconds since 1970. Zero if the date is invalid or in the obsolete format.
+ */
+static uint32_t _http_client_parse_date(const char *value)
+{
+	static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+	const char *ptr;
+	char *end;
+	uint32_t day, month, year, hour, minute, second, days;
+
+	ptr = strchr(value, ',');
+	if (ptr == NULL) {
+		return 0;
+	}
+	day = strtoul(ptr + 1, &end, 10);
+	while (*end == ' ') {
+		end++;
+	}
+	for (month = 0; month < 12; month++) {
+		if (!strncmp(end, &months[month * 3], 3)) {
+			break;
+		}
+	}
+	if (month >= 12 || end[3] != ' ') {
+		return 0;
+	}
+	year = strtoul(end + 4, &end, 10);
+	hour = strtoul(end, &end, 10);
+	if (*end != ':') {
+		return 0;
+	}
+	minute = strtoul(end + 1, &end, 10);
+	if (*end != ':') {
+		return 0;
+	}
+	second = strtoul(end + 1, &end, 10);
+	if (year < 1970 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+		return 0;
+	}
+
+	/* Days from 1970-01-01. The year starts in March to put the leap day at the end. */
+	if (month < 2) {
+		year--;
+		month += 12;
+	}
+	days = 365 * year + year / 4 - year / 100 + year / 400 + (153 * (month - 2) + 2) / 5 + day - 1 - 719468;
+	return days * 86400 + hour * 3600 + minute * 60 + second;
+}
 
-		module->req.state = STATE_REQ_SEND_ENTITY;
-		/* Send first part of entity. */
-	case STATE_REQ_SEND_ENTITY:
-		if (module->req.content_length < 0 && entity->read) {
-			/* Send chunked packet. */
-			/*  Chunked header (size + \r\n) tail (\r\n) */
-			size = entity->read(entity->priv_data, buffer + HTTP_CHUNKED_MAX_LENGTH + 2,
-				module->config.send_buffer_size - HTTP_CHUNKED_MAX_LENGTH - 4, module->req.sent_length);
-			if (size < 0) {
-				/* If occurs problem during the operation, Close this socket. */
-				size = 0;
+/**
+ * \brief Interpret the value of the parsed header.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ *
+ * \return     0 if success, Negative value if the session was closed.
+ */
+static int _http_client_handle_header_value(struct http_client_module *const module)
+{
+	char *value = module->resp.value;
+	char *ptr;
+	int number;
+
+	switch (module->resp.header_id) {
+	case HEADER_CONTENT_LENGTH:
+		/* Transfer-Encoding overrides Content-Length. */
+		if (module->resp.content_length >= 0) {
+			module->resp.content_length = atoi(value);
+		}
+		break;
+	case HEADER_TRANSFER_ENCODING:
+		if (_http_client_has_token(value, "chunked")) {
+			/* Chunked transfer */
+			module->resp.content_length = -1;
+		} else if (!_http_client_has_token(value, "identity")) {
+			/* Currently does not support gzip or deflate encoding. If received this header, disconnect session immediately*/
+			_http_client_clear_conn(module, -ENOTSUP);
+			return -1;
+		}
+		break;
+	case HEADER_CONTENT_ENCODING:
+		if (_http_client_has_token(value, "gzip") || _http_client_has_token(value, "x-gzip")) {
+			module->resp.content_encoding = HTTP_INFLATE_GZIP;
+		} else if (_http_client_has_token(value, "deflate")) {
+			module->resp.content_encoding = HTTP_INFLATE_ZLIB;
+		} else if (!_http_client_has_token(value, "identity")) {
+			_http_client_clear_conn(module, -ENOTSUP);
+			return -1;
+		}
+		if (module->resp.content_encoding != 0 && module->inflate == NULL) {
+			/* Decoder was not enabled. */
+			_http_client_clear_conn(module, -ENOTSUP);
+			return -1;
+		}
+		break;
+	case HEADER_CONTENT_RANGE:
+		_http_client_parse_content_range(module, value);
+		break;
+	case HEADER_ETAG:
+		/* Truncated value can not be used. */
+		if (strlen(value) < HTTP_MAX_HEADER_VALUE_LENGTH - 1) {
+			strcpy(module->resp.etag, value);
+		}
+		break;
+	case HEADER_LAST_MODIFIED:
+		if (strlen(value) < HTTP_MAX_HEADER_VALUE_LENGTH - 1) {
+			strcpy(module->resp.last_modified, value);
+		}
+		break;
+	case HEADER_KEEP_ALIVE:
+		/* timeout=5, max=100 */
+		for (ptr = value; *ptr != '\0'; ptr++) {
+			if (ptr != value && ptr[-1] != ' ' && ptr[-1] != ',') {
+				continue;
 			}
-			buffer[HTTP_CHUNKED_MAX_LENGTH + 1] = '\n';
-			buffer[HTTP_CHUNKED_MAX_LENGTH] = '\r';
-			buffer[size + HTTP_CHUNKED_MAX_LENGTH + 2] = '\r';
-			buffer[size + HTTP_CHUNKED_MAX_LENGTH + 3] = '\n';
-			if (size >= 0) {
-				ptr = buffer + 2;
-				*ptr = CH_LUT[size % 16];
+			if (!strncmp(ptr, "timeout=", 8)) {
+				module->keep_alive_timeout = (uint16_t)atoi(ptr + 8);
+			} else if (!strncmp(ptr, "max=", 4)) {
+				number = atoi(ptr + 4);
+				module->keep_alive_max = (number < 0xFFFF) ? (uint16_t)number : 0xFFFE;
 			}
-			if (size >= 0x10) {
-				ptr = buffer + 1;
-				*ptr = CH_LUT[(size / 0x10) % 16];
+		}
+		break;
+	case HEADER_CACHE_CONTROL:
+		if (_http_client_has_token(value, "no-store") || _http_client_has_token(value, "no-cache")) {
+			module->resp.no_store = 1;
+		}
+		for (ptr = value; *ptr != '\0'; ptr++) {
+			if (ptr != value && ptr[-1] != ' ' && ptr[-1] != ',') {
+				continue;
 			}
-			if (size >= 0x100) {
-				ptr = buffer;
-				*ptr = CH_LUT[(size / 0x100) % 16];
-			}		
-			//module->sending = 1;
-			if ((result = send(module->sock, (void*)ptr, ptr + HTTP_CHUNKED_MAX_LENGTH - buffer + size + 4, 0)) < 0) {	
-				_http_client_clear_conn(module, -EIO);
-				return;
+			if (!strncmp(ptr, "max-age=", 8)) {
+				module->resp.max_age = strtoul(ptr + 8, NULL, 10);
+				module->resp.has_max_age = 1;
 			}
+		}
+		break;
+	case HEADER_EXPIRES:
+		/* Invalid date means that the response is already expired. */
+		module->resp.expires = _http_client_parse_date(value);
+		if (module->resp.expires == 0) {
+			module->resp.expires = 1;
+		}
+		break;
+	case HEADER_DATE:
+		module->resp.date = _http_client_parse_date(value);
+		break;
+	case HEADER_AGE:
+		module->resp.age = strtoul(value, NULL, 10);
+		break;
+	case HEADER_CONNECTION:
+		if (_http_client_has_token(value, "close")) {
+			module->permanent = 0;
+		} else if (_http_client_has_token(value, "keep-alive")) {
+			module->permanent = 1;
+		}
+		break;
+	}
+	return 0;
+}
 
-			module->req.sent_length += size;
-
-			if(size == 0) {
-				if (module->req.entity.close) {
-					module->req.entity.close(module->req.entity.priv_data);
-				}
-				module->req.state = STATE_SOCK_CONNECTED;
-				if (module->cb) {
-					module->cb(module, HTTP_CLIENT_CALLBACK_REQUESTED, &data);
+int _http_client_parse_header(struct http_client_module *const module, const char *data, int length)
+{
+	struct http_client_resp *const resp = &module->resp;
+	const char *ptr = data, *end = data + length, *line_end;
+	char ch;
+	int index;
+
+	while (ptr < end) {
+		ch = *ptr++;
+		switch (resp->header_state) {
+		case HEADER_STATUS_VERSION:
+			/* HTTP/{Ver} {Code} {Desc} : HTTP/1.1 200 OK */
+			if (resp->header_pos == 0 && (ch == '\r' || ch == '\n')) {
+				/* Ignore the empty lines before the status line. */
+				break;
+			}
+			if (resp->header_pos < 5) {
+				if (ch != "HTTP/"[resp->header_pos]) {
+					_http_client_clear_conn(module, -EBADMSG);
+					return -1;
 				}
+			} else if (ch == ' ') {
+				resp->header_state = HEADER_STATUS_CODE;
+				break;
+			} else if (resp->header_pos == 5) {
+				/* persistent connection is turn on in the HTTP 1.1 or above version of protocols. */
+				module->permanent = (ch > '1');
+			} else if (resp->header_pos == 7 && ch > '0') {
+				module->permanent = 1;
+			}
+			if (resp->header_pos < 0xFF) {
+				resp->header_pos++;
+			}
+			break;
+		case HEADER_STATUS_CODE:
+			if (ch >= '0' && ch <= '9') {
+				resp->response_code = resp->response_code * 10 + ch - '0';
+			} else if (ch == '\n') {
+				resp->header_state = HEADER_LINE_START;
+			} else if (ch != ' ' || resp->response_code != 0) {
+				resp->header_state = HEADER_STATUS_REASON;
+			}
+			break;
+		case HEADER_STATUS_REASON:
+		case HEADER_SKIP_LINE:
+			/* Skip the rest of line without buffering it. */
+			line_end = memchr(ptr - 1, '\n', end - ptr + 1);
+			if (line_end == NULL) {
+				ptr = end;
+			} else {
+				ptr = line_end + 1;
+				resp->header_state = HEADER_LINE_START;
+			}
+			break;
+		case HEADER_LINE_START:
+			if (ch == '\r') {
 				break;
 			}
-		} else if (module->req.content_length > 0 && entity->read) {
-			/* Send entity. */
-			if (module->req.sent_length >= module->req.content_length) {
-				/* Complete to send the buffer. */
-				if (module->req.entity.close) {
-					module->req.entity.close(module->req.entity.priv_data);
+			if (ch == '\n') {
+				/* End of the header. */
+				module->resp.state = STATE_PARSE_ENTITY;
+				return ptr - data;
+			}
+			resp->header_state = HEADER_NAME;
+			resp->header_pos = 0;
+			resp->header_candidates = (1UL << HEADER_MAX) - 1;
+			/* No break. */
+		case HEADER_NAME:
+			if (ch == ':') {
+				resp->header_state = HEADER_SKIP_LINE;
+				for (index = 0; index < HEADER_MAX; index++) {
+					if ((resp->header_candidates & (1UL << index)) && header_names[index][resp->header_pos] == '\0') {
+						resp->header_id = index;
+						resp->value_length = 0;
+						resp->header_state = HEADER_VALUE_START;
+						break;
+					}
 				}
-				module->req.state = STATE_SOCK_CONNECTED;
-				if (module->cb) {
-					module->cb(module, HTTP_CLIENT_CALLBACK_REQUESTED, &data);
+				break;
+			}
+			if (ch == '\n') {
+				/* Malformed line. */
+				resp->header_state = HEADER_LINE_START;
+				break;
+			}
+			if (ch >= 'A' && ch <= 'Z') {
+				ch += 'a' - 'A';
+			}
+			for (index = 0; index < HEADER_MAX; index++) {
+				if ((resp->header_candidates & (1UL << index)) && header_names[index][resp->header_pos] != ch) {
+					resp->header_candidates &= ~(1UL << index);
 				}
+			}
+			if (resp->header_candidates == 0) {
+				/* Not interested in this header. */
+				resp->header_state = HEADER_SKIP_LINE;
+			}
+			if (resp->header_pos < 0xFF) {
+				resp->header_pos++;
+			}
+			break;
+		case HEADER_VALUE_START:
+			if (ch == ' ' || ch == '\t') {
 				break;
 			}
-			
-			
-			do {
-				if (entity->file_format > 0)
-				size = entity->read_file(entity->priv_data, &entity->file_object, buffer, module->config.send_buffer_size, module->req.sent_length);
-				else
-				size = entity->read(entity->priv_data, buffer, module->config.send_buffer_size, module->req.sent_length);
-
-				if (size < 0) {
-					/* Entity occurs errors or EOS. */
-					/* Disconnect it. */
-					_http_client_clear_conn(module, (size == 0)?-EBADMSG:-EIO);
-				} else {
-					if (size > module->req.content_length - module->req.sent_length) {
-						size = module->req.content_length - module->req.sent_length;
-					}
-				
-					//module->sending = 1;
-					if (size > 0)
-					{
-					
-					//do{
-						//delay_ms(50);
-					if ((result = send(module->sock, (void*)buffer, size, 0)) < 0) {
-						//printf("send fail, result = %d\r\n", result);
-						_http_client_clear_conn(module, -EIO);
-						return;
-					}
-					//} while (result <0);
-					module->req.sent_length += size;
-					}
+			resp->header_state = HEADER_VALUE;
+			/* No break. */
+		case HEADER_VALUE:
+			if (ch == '\n') {
+				while (resp->value_length > 0 && resp->value[resp->value_length - 1] == ' ') {
+					resp->value_length--;
 				}
-				g_send_pkg_cnt++;
-				} while (g_send_pkg_cnt < 6);
-			//} while (size > 0);
+				resp->value[resp->value_length] = '\0';
+				resp->header_state = HEADER_LINE_START;
+				if (_http_client_handle_header_value(module) < 0) {
+					return -1;
 				}
-			 else {
-			/* Has not any entity. */
-			module->req.state = STATE_SOCK_CONNECTED;
-			if (module->cb) {
-				module->cb(module, HTTP_CLIENT_CALLBACK_REQUESTED, &data);
+			} else if (ch != '\r' && resp->value_length < HTTP_MAX_HEADER_VALUE_LENGTH - 1) {
+				resp->value[resp->value_length++] = ch;
 			}
 			break;
 		}
-
-		break;
-	default:
-		/* Invalid status. */
-		break;
 	}
+
+	return ptr - data;
 }
 
-void _http_client_recv_packet(struct http_client_module *const module)
+/**
+ * \brief Fill the validators of the response in the callback data.
+ *
+ * \param[in]  module          Module instance of HTTP.
+ * \param[out] data            Callback data of the response.
+ */
+static void _http_client_get_validators(struct http_client_module *const module, struct http_client_data_recv_response *data)
 {
-	if (module == NULL) {
-		return;
+	struct http_client_resp *const resp = &module->resp;
+
+	data->etag = (resp->etag[0] != '\0') ? resp->etag : NULL;
+	data->last_modified = (resp->last_modified[0] != '\0') ? resp->last_modified : NULL;
+	/* Weak ETag can not be used in the If-Range. Strong ETag is preferred. */
+	data->validator = (resp->etag[0] == '"') ? resp->etag : data->last_modified;
+	data->cache_path = NULL;
+	if (resp->response_code == 304 && module->req.cache_hit) {
+		/* Entity is not sent. The cached file is used. */
+		data->cache_path = module->cache_entry->path;
 	}
-	
-	if (module->recved_size >= module->config.recv_buffer_size) {
-		/* Has not enough memory. */
-		_http_client_clear_conn(module, -EOVERFLOW);
-		return;
-	}
-	
-	/* Executing read until receiving operation is started. */
-	/*
-	while (recv(module->sock,
-		module->config.recv_buffer + module->recved_size,
-		module->config.recv_buffer_size - module->recved_size, 0) != 0);
-	*/
-	recv(module->sock,
-		module->config.recv_buffer + module->recved_size,
-		module->config.recv_buffer_size - module->recved_size, 0);
 }
 
-void _http_client_recved_packet(struct http_client_module *const module, int read_len)
+int _http_client_handle_header(struct http_client_module *const module)
 {
-	module->recved_size += read_len;
-	if (module->config.timeout > 0) {
-		sw_timer_disable_callback(module->config.timer_inst, module->timer_id);
+	union http_client_data data;
+	int consumed;
+	int method;
+
+	char *buffer;
+	int length;
+
+	/* The unread data can be divided in the two parts in the circular buffer. */
+	while (module->resp.state == STATE_PARSE_HEADER && module->recved_size > 0) {
+		length = _http_client_rx_peek(module, &buffer);
+		consumed = _http_client_parse_header(module, buffer, length);
+		if (consumed < 0) {
+			/* Session was closed. */
+			return 0;
+		}
+		/* Parsed data is never scanned again. */
+		_http_client_rx_consume(module, consumed);
 	}
 
-	/* Recursive function call can be occurred overflow. */
-	while(_http_client_handle_response(module) != 0);
-}
+	if (module->resp.state != STATE_PARSE_ENTITY) {
+		/* not enough buffer. */
+		return 0;
+	}
 
-int _http_client_handle_response(struct http_client_module *const module)
-{
-	switch(module->resp.state) {
-	case STATE_PARSE_HEADER:
-		return _http_client_handle_header(module);
-	case STATE_PARSE_ENTITY:
-		return _http_client_handle_entity(module);
+	/* These responses never have the entity. The next response follows the header immediately. */
+	method = (module->pipeline_count > 0) ? module->pipeline[module->pipeline_head].method : module->req.method;
+	if (method == HTTP_METHOD_HEAD || module->resp.response_code == 204 || module->resp.response_code == 304) {
+		module->resp.content_length = 0;
 	}
-	return 0;
+
+	/* In chunked mode, Chunk size line is expected first. */
+	module->resp.read_length = (module->resp.content_length < 0) ? -1 : 0;
+	module->resp.chunk_state = CHUNK_SIZE;
+
+	if (module->resp.content_encoding != 0) {
+		if (module->resp.content_length == 0) {
+			/* Nothing to decode. */
+			module->resp.content_encoding = 0;
+		} else {
+			http_inflate_init(module->inflate, (enum http_inflate_format)module->resp.content_encoding,
+				(uint8_t *)(module->inflate + 1), module->config.inflate_window_size, _http_client_inflate_output, (void *)module);
+		}
+	}
+
+	/* Check validation first. */
+	if (module->cb && module->resp.response_code) {
+		/* Chunked transfer or compressed entity */
+		if (module->resp.content_length < 0 || module->resp.content_encoding != 0) {
+			data.recv_response.response_code = module->resp.response_code;
+			data.recv_response.is_chunked = 1;
+			data.recv_response.content_length = 0;
+			data.recv_response.range_start = module->resp.range_start;
+			data.recv_response.total_length = module->resp.total_length;
+			_http_client_get_validators(module, &data.recv_response);
+			data.recv_response.content = NULL;
+			data.recv_response.timing = NULL;
+			module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
+		} else if (module->resp.content_length > (int)module->config.recv_buffer_size) {
+			/* Entity is bigger than receive buffer. Sending the buffer to user like chunked transfer. */
+			data.recv_response.response_code = module->resp.response_code;
+			data.recv_response.is_chunked = 0;
+			data.recv_response.content_length = module->resp.content_length;
+			data.recv_response.range_start = module->resp.range_start;
+			data.recv_response.total_length = module->resp.total_length;
+			_http_client_get_validators(module, &data.recv_response);
+			data.recv_response.content = NULL;
+			data.recv_response.timing = NULL;
+			module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
+		}
+	}
+
+	return 1;
 }
 
-int _http_client_handle_header(struct http_client_module *const module)
+static int _http_client_read_chuked_entity(struct http_client_module *const module)
 {
-	char *ptr_line_end, *ptr;
+	/* In chunked mode, read_length variable is means to remain data in the current chunk. */
 	union http_client_data data;
-	/* New line character only used in this function. So variable registered in the code region. */
-	static const char *new_line = "\r\n";
+	char *buffer, *ptr, *end;
+	int length, digit;
+	int complete = 0;
 
-	//TODO : header filter
-
-	for (ptr = module->config.recv_buffer ; ; ) {
-		ptr_line_end = strstr(ptr, new_line);
-		if (ptr_line_end == NULL || ptr_line_end >= module->config.recv_buffer + module->recved_size) {
-			/* not enough buffer. */
-			_http_client_move_buffer(module, ptr);
-			return 0;
-		}
+	while (module->recved_size > 0) {
+		length = _http_client_rx_peek(module, &buffer);
 
-		if (!strncmp(ptr, new_line, strlen(new_line))) {
-			/* Move remain data to forward part of buffer. */
-			_http_client_move_buffer(module, ptr + strlen(new_line));
-
-			/* Check validation first. */
-			if (module->cb && module->resp.response_code) {
-				/* Chunked transfer */
-				if (module->resp.content_length < 0) {
-					data.recv_response.response_code = module->resp.response_code;
-					data.recv_response.is_chunked = 1;
-					module->resp.read_length = 0;
-					data.recv_response.content = NULL;
-					module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
-				} else if (module->resp.content_length > (int)module->config.recv_buffer_size) {
-					/* Entity is bigger than receive buffer. Sending the buffer to user like chunked transfer. */
-					data.recv_response.response_code = module->resp.response_code;
-					data.recv_response.content_length = module->resp.content_length;
-					data.recv_response.content = NULL;
-					module->resp.read_length = 0;
-					module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
-				}
+		if (module->resp.chunk_state == CHUNK_DATA) {
+			/* Pass the received part of the chunk without waiting the rest of it. */
+			if (length > module->resp.read_length) {
+				length = module->resp.read_length;
+			}
+			if (_http_client_send_entity(module, buffer, length, 0) < 0) {
+				/* Session was closed. */
+				return 0;
 			}
+			_http_client_rx_consume(module, length);
+			module->resp.read_length -= length;
+			if (module->resp.read_length == 0) {
+				module->resp.chunk_state = CHUNK_DATA_END;
+			}
+			continue;
+		}
 
-			module->resp.state = STATE_PARSE_ENTITY;
-			return 1;
-		} else if (!strncmp(ptr, "Content-Length: ", strlen("Content-Length: "))) {
-			module->resp.content_length = atoi(ptr + strlen("Content-Length: "));
-		} else if (!strncmp(ptr, "Transfer-Encoding: ", strlen("Transfer-Encoding: "))) {
-			/* Currently does not support gzip or deflate encoding. If received this header, disconnect session immediately*/
-			char *type_ptr = ptr + strlen("Transfer-Encoding: ");
-			for (; ptr_line_end > type_ptr; type_ptr++) {
-				if (*type_ptr == ' ') {
-					continue;
-				} else if (*type_ptr == 'C' || *type_ptr == 'c') {
-					/* Chunked transfer */
-					module->req.content_length = -1;
+		/* Lines between the chunks are parsed byte by byte, so they can be divided in the multiple packets. */
+		ptr = buffer;
+		end = buffer + length;
+		while (ptr < end && module->resp.chunk_state != CHUNK_DATA && !complete) {
+			switch (module->resp.chunk_state) {
+			case CHUNK_SIZE:
+				if (*ptr >= '0' && *ptr <= '9') {
+					digit = *ptr - '0';
+				} else if ((*ptr | 0x20) >= 'a' && (*ptr | 0x20) <= 'f') {
+					digit = (*ptr | 0x20) - 'a' + 10;
 				} else {
-					_http_client_clear_conn(module, -ENOTSUP);
+					digit = -1;
+				}
+				if (digit >= 0) {
+					/* Size was set to -1 until the first digit. */
+					if (module->resp.read_length < 0) {
+						module->resp.read_length = 0;
+					}
+					if (module->resp.read_length > (0x7FFFFFFF >> 4)) {
+						/* Chunk size cannot be represented. */
+						_http_client_clear_conn(module, -EOVERFLOW);
+						return 0;
+					}
+					module->resp.read_length = module->resp.read_length * 0x10 + digit;
+				} else if (module->resp.read_length < 0) {
+					/* Chunk size is missing. */
+					_http_client_clear_conn(module, -EBADMSG);
+					return 0;
+				} else if (*ptr == '\n') {
+					module->resp.chunk_state = (module->resp.read_length == 0) ? CHUNK_TRAILER : CHUNK_DATA;
+				} else if (*ptr == ';' || *ptr == ' ' || *ptr == '\t') {
+					module->resp.chunk_state = CHUNK_EXTENSION;
+				} else if (*ptr != '\r') {
+					_http_client_clear_conn(module, -EBADMSG);
 					return 0;
 				}
+				ptr++;
 				break;
-			}
-		} else if (!strncmp(ptr, "Connection: ", strlen("Connection: "))) {
-			char *type_ptr = ptr + strlen("Connection: ");
-			for (; ptr_line_end > type_ptr; type_ptr++) {
-				if (*type_ptr == ' ') {
-					continue;
-				} else if (*type_ptr == 'K' || *type_ptr == 'k') {
-					module->permanent = 1;
+			case CHUNK_TRAILER:
+				if (*ptr == '\n') {
+					/* Empty line. End of the entity. */
+					complete = 1;
+				} else if (*ptr != '\r') {
+					module->resp.chunk_state = CHUNK_TRAILER_LINE;
+				}
+				ptr++;
+				break;
+			default:
+				/* Skip the rest of line. */
+				ptr = memchr(ptr, '\n', end - ptr);
+				if (ptr == NULL) {
+					ptr = end;
+					break;
+				}
+				ptr++;
+				if (module->resp.chunk_state == CHUNK_EXTENSION) {
+					module->resp.chunk_state = (module->resp.read_length == 0) ? CHUNK_TRAILER : CHUNK_DATA;
+				} else if (module->resp.chunk_state == CHUNK_DATA_END) {
+					module->resp.chunk_state = CHUNK_SIZE;
+					module->resp.read_length = -1;
 				} else {
-					module->permanent = 0;
+					module->resp.chunk_state = CHUNK_TRAILER;
 				}
 				break;
 			}
-		} else if (!strncmp(ptr, "HTTP/", 5)) {
-			module->resp.response_code = atoi(ptr + 9); /* HTTP/{Ver} {Code} {Desc} : HTTP/1.1 200 OK */
-			/* Initializing the variables */
-			module->resp.content_length = 0;
-			/* persistent connection is turn on in the HTTP 1.1 or above version of protocols. */  
-			if (ptr [5] > '1' || ptr[7] > '0') {
-				module->permanent = 1;
-			} else {
-				module->permanent = 0;
+		}
+		_http_client_rx_consume(module, ptr - buffer);
+
+		if (complete) {
+			/* Complete to receive the buffer. */
+			if (module->resp.content_encoding != 0 && !http_inflate_is_done(module->inflate)) {
+				/* Compressed stream was truncated. */
+				_http_client_clear_conn(module, -EBADMSG);
+				return 0;
+			}
+			_http_client_finish_response(module);
+			_http_client_reset_response(module);
+			data.recv_chunked_data.is_complete = 1;
+			data.recv_chunked_data.length = 0;
+			data.recv_chunked_data.data = NULL;
+			data.recv_chunked_data.timing = _http_client_timing_complete(module, 0);
+			if (module->cb) {
+				module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &data);
+			}
+			if (module->permanent == 0) {
+				/* This server was not supported keep alive. */
+				_http_client_pipeline_reconnect(module, 0);
+				return 0;
 			}
+			return module->recved_size;
 		}
+	}
+
+	return 0;
+}
 
-		ptr = ptr_line_end + strlen(new_line);
+void _http_client_inflate_output(void *priv_data, const char *data, size_t length)
+{
+	struct http_client_module *const module = (struct http_client_module *)priv_data;
+	union http_client_data cb_data;
+
+	cb_data.recv_chunked_data.length = length;
+	cb_data.recv_chunked_data.data = (char *)data;
+	cb_data.recv_chunked_data.is_complete = 0;
+	cb_data.recv_chunked_data.timing = NULL;
+	if (module->cb) {
+		module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &cb_data);
 	}
 }
 
-static void _http_client_read_chuked_entity(struct http_client_module *const module)
+int _http_client_send_entity(struct http_client_module *const module, char *buffer, int length, int is_complete)
 {
-	/* In chunked mode, read_length variable is means to remain data in the chunk. */
 	union http_client_data data;
-	int length = (int)module->recved_size;
-	int extension = 0;
-	char *buffer= module->config.recv_buffer;
-
-	do {
-		if (module->resp.read_length >= 0) {
-			if (module->resp.read_length == 0) {
-				/* Complete to receive the buffer. */
-				module->resp.state = STATE_PARSE_HEADER;
-				module->resp.response_code = 0;
-				data.recv_chunked_data.is_complete = 1;
-				data.recv_chunked_data.length = 0;
-				data.recv_chunked_data.data = NULL;
-				if (module->cb) {
-					module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &data);
-				}
-				if (module->permanent == 0) {
-					/* This server was not supported keep alive. */
-					_http_client_clear_conn(module, 0);
-					return;
-				}
-				_http_client_move_buffer(module, buffer + 2);
-			} else if (module->resp.read_length <= length) {
-				data.recv_chunked_data.length = module->resp.read_length;
-				data.recv_chunked_data.data = buffer;
-				data.recv_chunked_data.is_complete = 0;
-
-				if (module->cb) {
-					module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &data);
-				}
-				/* Last two character in the chunk is '\r\n'. */
-				_http_client_move_buffer(module, buffer + module->resp.read_length + 2 /* sizeof newline character */);
-				length = (int)module->recved_size;
-				buffer = module->config.recv_buffer;
-				module->resp.read_length = -1;
-			}
-		} else {
-			/* Read chunked length. */
-			module->resp.read_length = 0;
-			for (; length > 0; buffer++, length--) {
-				if (*buffer == '\n') {
-					buffer++;
-					length--;
-					break;
-				}
-				if (extension != 0) {
-					continue;
-				}
-				if (*buffer >= '0' && *buffer <= '9') {
-					module->resp.read_length = module->resp.read_length * 0x10 + *buffer - '0';
-				} else if (*buffer >= 'a' && *buffer <= 'f') {
-					module->resp.read_length = module->resp.read_length * 0x10 + *buffer - 'a';
-				} else if (*buffer >= 'A' && *buffer <= 'F') {
-					module->resp.read_length = module->resp.read_length * 0x10 + *buffer - 'A';
-				} else if (*buffer == ';') {
-					extension = 1;
-				}
-			}
+	int result;
 
-			if (module->resp.read_length > (int)module->config.recv_buffer_size) {
-				/* Chunked size is too big. */
-				/* Through exception. */
-				_http_client_clear_conn(module, -EOVERFLOW);
-				return;
-			}
+	if (module->resp.content_encoding == 0) {
+		data.recv_chunked_data.length = length;
+		data.recv_chunked_data.data = buffer;
+		data.recv_chunked_data.is_complete = is_complete;
+		data.recv_chunked_data.timing = is_complete ? _http_client_timing_complete(module, length) : NULL;
+		if (is_complete) {
+			_http_client_finish_response(module);
+		}
+		if (module->cb) {
+			module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &data);
+		}
+		return 0;
+	}
 
-			if (length  == 0) {
-				/* currently not received packet yet. */
-				module->resp.read_length = -1;
-				return;
-			}
+	/* Decoded data is passed to the application through _http_client_inflate_output. */
+	result = http_inflate_feed(module->inflate, buffer, length);
+	if (result < 0 || (is_complete && result == 0)) {
+		/* Stream is corrupted or truncated. */
+		_http_client_clear_conn(module, (result < 0) ? result : -EBADMSG);
+		return -1;
+	}
+	if (is_complete) {
+		data.recv_chunked_data.length = 0;
+		data.recv_chunked_data.data = NULL;
+		data.recv_chunked_data.is_complete = 1;
+		data.recv_chunked_data.timing = _http_client_timing_complete(module, length);
+		_http_client_finish_response(module);
+		if (module->cb) {
+			module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &data);
 		}
-	} while(module->recved_size > 0);
+	}
+	return 0;
 }
 
 int _http_client_handle_entity(struct http_client_module *const module)
 {
 	union http_client_data data;
-	char *buffer = module->config.recv_buffer;
+	const struct http_client_timing *timing;
+	char *buffer;
+	int length;
+	int is_complete;
+
+	if (module->resp.content_length < 0) {
+		return _http_client_read_chuked_entity(module);
+	}
 
 	/* If data size is lesser than buffer size, read all buffer and retransmission it to application. */
-	if (module->resp.content_length >= 0 && module->resp.content_length <= (int)module->config.recv_buffer_size) {
-		if ((int)module->recved_size >= module->resp.content_length) {
-			if (module->cb && module->resp.response_code) {
-				data.recv_response.response_code = module->resp.response_code;
-				data.recv_response.is_chunked = 0;
-				data.recv_response.content_length = module->resp.content_length;
-				data.recv_response.content = buffer;
-				module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
-			}
-			module->resp.state = STATE_PARSE_HEADER;
-			module->resp.response_code = 0;
-			
-			if (module->permanent == 0) {
-				/* This server was not supported keep alive. */
-				printf("HTTTP LOG1\r\n");
-				_http_client_clear_conn(module, 0);
-			} else {
-				_http_client_move_buffer(module, buffer + module->resp.content_length);
-				return module->recved_size;
-			}
+	if (module->resp.content_length <= (int)module->config.recv_buffer_size && module->resp.content_encoding == 0) {
+		if ((int)module->recved_size < module->resp.content_length) {
+			/* buffer was not received enough size yet. */
+			return 0;
 		}
-		/* else, buffer was not received enough size yet. */
-	} else {
-		if (module->resp.content_length >= 0) {
-			data.recv_chunked_data.length = module->recved_size;
-			data.recv_chunked_data.data = buffer;
-			module->resp.read_length += (int)module->recved_size;
-			if (module->resp.content_length <= module->resp.read_length) {
-				/* Complete to receive the buffer. */
-				module->resp.state = STATE_PARSE_HEADER;
-				module->resp.response_code = 0;
-				data.recv_chunked_data.is_complete = 1;
-			} else {
-				data.recv_chunked_data.is_complete = 0;
+		if (_http_client_rx_peek(module, &buffer) < module->resp.content_length) {
+			/* Entity is wrapped around the end of the buffer. */
+			_http_client_rx_linearize(module);
+			_http_client_rx_peek(module, &buffer);
+		}
+		_http_client_response_cache_store(module, buffer);
+		timing = _http_client_timing_complete(module, module->resp.content_length);
+		_http_client_finish_response(module);
+		if (module->cb && module->resp.response_code) {
+			data.recv_response.response_code = module->resp.response_code;
+			data.recv_response.is_chunked = 0;
+			data.recv_response.content_length = module->resp.content_length;
+			data.recv_response.range_start = module->resp.range_start;
+			data.recv_response.total_length = module->resp.total_length;
+			_http_client_get_validators(module, &data.recv_response);
+			data.recv_response.content = buffer;
+			data.recv_response.timing = timing;
+			if (data.recv_response.cache_path != NULL) {
+				/* Size of the cached file is reported instead of the empty entity. */
+				data.recv_response.content_length = module->cache_entry->length;
+				data.recv_response.content = NULL;
 			}
+			module->cb(module, HTTP_CLIENT_CALLBACK_RECV_RESPONSE, &data);
+		}
+		_http_client_rx_consume(module, module->resp.content_length);
 
-			if (module->cb) {
-				module->cb(module, HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA, &data);
-			}
-			
-			if (data.recv_chunked_data.is_complete == 1) {
-				if (module->permanent == 0) {
-					/* This server was not supported keep alive. */
-					printf("1\r\n");
-					_http_client_clear_conn(module, 0);
-					return 0;
-				}
+		if (module->permanent == 0) {
+			/* This server was not supported keep alive. */
+			_http_client_reset_response(module);
+			_http_client_pipeline_reconnect(module, 0);
+			return 0;
+		}
+		_http_client_reset_response(module);
+		return module->recved_size;
+	}
+
+	/* Pass the received data to the application without copying. At most two slices are needed. */
+	while (module->recved_size > 0) {
+		length = _http_client_rx_peek(module, &buffer);
+		if (length > module->resp.content_length - module->resp.read_length) {
+			length = module->resp.content_length - module->resp.read_length;
+		}
+		module->resp.read_length += length;
+		is_complete = (module->resp.content_length <= module->resp.read_length);
+
+		if (_http_client_send_entity(module, buffer, length, is_complete) < 0) {
+			/* Session was closed. */
+			return 0;
+		}
+		_http_client_rx_consume(module, length);
+
+		if (is_complete) {
+			if (module->permanent == 0) {
+				/* This server was not supported keep alive. */
+				_http_client_reset_response(module);
+				_http_client_pipeline_reconnect(module, 0);
+				return 0;
 			}
-			_http_client_move_buffer(module, buffer + module->recved_size);
-		} else {
-			_http_client_read_chuked_entity(module);
+			_http_client_reset_response(module);
+			return module->recved_size;
 		}
 	}
 
 	return 0;
 }
 
-void _http_client_move_buffer(struct http_client_module *const module, char *base)
+void _http_client_reset_response(struct http_client_module *const module)
 {
-	char *buffer = module->config.recv_buffer;
-	int remain = (int)module->recved_size - (int)base + (int)buffer;
+	module->resp.state = STATE_PARSE_HEADER;
+	module->resp.response_code = 0;
+	module->resp.content_length = 0;
+	module->resp.content_encoding = 0;
+	module->resp.range_start = 0;
+	module->resp.total_length = 0;
+	module->resp.etag[0] = '\0';
+	module->resp.last_modified[0] = '\0';
+	module->resp.has_max_age = 0;
+	module->resp.no_store = 0;
+	module->resp.expires = 0;
+	module->resp.date = 0;
+	module->resp.age = 0;
+	module->resp.header_state = HEADER_STATUS_VERSION;
+	module->resp.header_pos = 0;
+}
 
-	if (remain > 0) {
-		memmove(buffer, base, remain);
-		module->recved_size = remain;
-	} else {
-		module->recved_size = 0;
-	}
+void _http_client_finish_response(struct http_client_module *const module)
+{
+	/* Response of the oldest pipelined request was finished. */
+	_http_client_pipeline_pop(module);
+	module->waiting_response = (module->pipeline_count > 0);
 }
 
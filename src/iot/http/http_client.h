@@ -53,6 +53,8 @@
 #include "common/include/nm_common.h"
 #include "iot/sw_timer.h"
 #include "http_entity.h"
+#include "http_inflate.h"
+#include "http_pool.h"
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -64,6 +66,54 @@ extern "C" {
 /** Max size of URI. */
 //#define HTTP_MAX_URI_LENGTH           64
 #define HTTP_MAX_URI_LENGTH           1000
+/**
+ * Max size of the header value which is kept by the response parser.
+ * Only the values of the headers interpreted by the client are buffered, longer values are truncated.
+ */
+#define HTTP_MAX_HEADER_VALUE_LENGTH  64
+/** Max size of the serialized default request headers. It includes the Host header. */
+#define HTTP_MAX_HEADER_TEMPLATE_LENGTH 256
+/** Number of the idle persistent connections which can be kept in the connection pool. It is shared by all modules. */
+#define HTTP_CLIENT_POOL_SIZE         4
+/** Time to keep the idle connection in the pool if the server did not send the Keep-Alive timeout. Unit is milliseconds. */
+#define HTTP_CLIENT_POOL_IDLE_TIMEOUT 4000
+/** Number of the host names whose address is cached. It is shared by all modules. */
+#define HTTP_CLIENT_DNS_CACHE_SIZE    4
+/** Time to keep the resolved address. The resolver does not report the TTL of the record. Unit is milliseconds. */
+#define HTTP_CLIENT_DNS_CACHE_TTL     300000
+/** Time to keep the result of the failed resolution. Unit is milliseconds. */
+#define HTTP_CLIENT_DNS_NEGATIVE_TTL  10000
+/** Maximum number of the requests which can be pipelined in a module. */
+#define HTTP_CLIENT_PIPELINE_MAX_DEPTH 8
+/** Number of the times that the unanswered pipelined requests are sent again on a new connection. */
+#define HTTP_CLIENT_PIPELINE_MAX_RETRY 2
+/** Longest freshness lifetime of the response in the response cache. Longer lifetime is shortened to this value. Unit is seconds. */
+#define HTTP_CLIENT_RESPONSE_CACHE_MAX_AGE 2000000
+/** Number of the buckets in the latency histogram. The last bucket counts all of the longer phases. */
+#define HTTP_CLIENT_TIMING_BUCKETS    16
+/** Size of the memory of the decoder and its history window. See \ref http_client_config.inflate_buffer. */
+#define HTTP_CLIENT_INFLATE_BUFFER_SIZE(window_size) (sizeof(struct http_inflate) + (window_size))
+
+/**
+ * \brief Default headers which can be included in every request.
+ * Host header is always included.
+ */
+enum http_client_default_header {
+	/** cache-control: no-cache */
+	HTTP_CLIENT_HEADER_CACHE_CONTROL   = (1 << 0),
+	/** User-Agent: {user_agent} */
+	HTTP_CLIENT_HEADER_USER_AGENT      = (1 << 1),
+	/** Accept header for any media type. */
+	HTTP_CLIENT_HEADER_ACCEPT          = (1 << 2),
+	/** accept-encoding: gzip, deflate */
+	HTTP_CLIENT_HEADER_ACCEPT_ENCODING = (1 << 3),
+	/** Connection: keep-alive */
+	HTTP_CLIENT_HEADER_CONNECTION      = (1 << 4),
+};
+
+/** Default header set of the HTTP client. */
+#define HTTP_CLIENT_DEFAULT_HEADERS   (HTTP_CLIENT_HEADER_CACHE_CONTROL | HTTP_CLIENT_HEADER_USER_AGENT \
+	| HTTP_CLIENT_HEADER_ACCEPT | HTTP_CLIENT_HEADER_ACCEPT_ENCODING | HTTP_CLIENT_HEADER_CONNECTION)
 
 /**
  * \brief A type of HTTP method.
@@ -102,6 +152,73 @@ enum http_client_callback_type {
 	HTTP_CLIENT_CALLBACK_DISCONNECTED,
 };
 
+/**
+ * \brief Phases of the request which are measured in \ref http_client_timing.
+ */
+enum http_client_phase {
+	/** From the request to the end of the DNS query. Zero if the address was cached or the connection was reused. */
+	HTTP_CLIENT_PHASE_RESOLVE = 0,
+	/** Until the socket was connected. It includes the TLS handshake which is done by the WINC. */
+	HTTP_CLIENT_PHASE_CONNECT,
+	/** Until all of the header packets were completed. */
+	HTTP_CLIENT_PHASE_HEADER,
+	/** Until the entity was sent. */
+	HTTP_CLIENT_PHASE_ENTITY,
+	/** Until the first byte of the response was received. (time to first byte) */
+	HTTP_CLIENT_PHASE_WAIT,
+	/** Until the whole response was received. */
+	HTTP_CLIENT_PHASE_RECEIVE,
+	/** From the request to the end of the response. */
+	HTTP_CLIENT_PHASE_TOTAL,
+	HTTP_CLIENT_PHASE_MAX,
+};
+
+/**
+ * \brief Latency breakdown of the request.
+ *
+ * Elapsed times are in milliseconds and the resolution is the accuracy of the sw_timer.
+ * The phases which were skipped are zero.
+ * The response of the pipelined request is measured from the end of the previous response.
+ */
+struct http_client_timing {
+	/** Time when the request was started. See \ref sw_timer_get_time. */
+	uint32_t start;
+	/** Time when the last phase was finished. See \ref sw_timer_get_time. */
+	uint32_t mark;
+	/** Elapsed time of each phase. See \ref http_client_phase. */
+	uint32_t phase[HTTP_CLIENT_PHASE_MAX];
+	/** Size of the request header and entity which was accepted by the socket. */
+	uint32_t bytes_sent;
+	/** Size of the response header and entity which was received. */
+	uint32_t bytes_received;
+	/** Phase which is measured next. HTTP_CLIENT_PHASE_MAX if the request was finished. */
+	uint8_t next;
+	/** A flag that the connection was reused. */
+	uint8_t reused;
+};
+
+/**
+ * \brief Latency histograms of the finished requests.
+ *
+ * Bucket 0 counts zero milliseconds and bucket n counts from 2^(n-1) to 2^n - 1 milliseconds.
+ */
+struct http_client_timing_stats {
+	/** Number of the requests which were completed. */
+	uint32_t completed;
+	/** Number of the requests which were closed before the response was completed. */
+	uint32_t failed;
+	/** Total size of the requests which were completed. */
+	uint32_t bytes_sent;
+	/** Total size of the responses which were completed. */
+	uint32_t bytes_received;
+	/** Sum of the elapsed time of each phase. */
+	uint32_t sum[HTTP_CLIENT_PHASE_MAX];
+	/** Longest elapsed time of each phase. */
+	uint32_t max[HTTP_CLIENT_PHASE_MAX];
+	/** Histogram of each phase. The counters saturate at 0xFFFF. */
+	uint16_t histogram[HTTP_CLIENT_PHASE_MAX][HTTP_CLIENT_TIMING_BUCKETS];
+};
+
 /**
  * \brief Structure of the HTTP_CLIENT_CALLBACK_SOCK_CONNECTED callback.
  */
@@ -144,16 +261,43 @@ struct http_client_data_recv_response {
 	 * http://www.w3.org/Protocols/rfc2616/rfc2616-sec10.html
 	 */
 	uint16_t response_code;
-	/** If this flag is set to zero, This data is used chunked encoding. */
+	/**
+	 * If this flag is set to zero, This data is used chunked encoding.
+	 * Compressed entity is also reported as chunked because the decoded length is unknown.
+	 */
 	uint8_t is_chunked;
 	/** Length of entity. */
 	uint32_t content_length;
+	/** Position of the entity in the whole resource. It is only meaningful in the 206 Partial Content response. */
+	uint32_t range_start;
+	/** Size of the whole resource which was reported in the Content-Range header. Zero if it is unknown. */
+	uint32_t total_length;
+	/**
+	 * ETag or Last-Modified of the resource. NULL if the server did not send any strong validator.
+	 * It is valid only in the callback. Keep a copy of it to resume the download with \ref http_client_send_request_range.
+	 */
+	const char *validator;
+	/** ETag of the response including the weak one. NULL if the server did not send it. It is valid only in the callback. */
+	const char *etag;
+	/** Last-Modified of the response. NULL if the server did not send it. It is valid only in the callback. */
+	const char *last_modified;
+	/**
+	 * Path of the cached file which is still valid.
+	 * It is only set in the 304 Not Modified response of the request which was validated with \ref http_client_config.cache.
+	 * In this case, No entity is received. content is NULL and content_length is the size of the cached file.
+	 */
+	const char *cache_path;
 	/**
 	 * Content buffer.
 	 * If this value is equal to zero, it means This data is too big compared with the receive buffer.
 	 * In this situation, Data will be transmitted through HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA callback.
 	 */
 	char *content;
+	/**
+	 * Latency breakdown of the request. It is only set when the whole response was received in this callback.
+	 * It is valid only in the callback.
+	 */
+	const struct http_client_timing *timing;
 };
 
 /**
@@ -166,6 +310,8 @@ struct http_client_data_recv_chunked_data {
 	char *data;
 	/** A flag for the indicating whether the last data. */
 	char is_complete;
+	/** Latency breakdown of the request. It is only set with is_complete. It is valid only in the callback. */
+	const struct http_client_timing *timing;
 };
 
 /**
@@ -207,6 +353,9 @@ union http_client_data {
 
 /* Before declaring for the callback type. */
 struct http_client_module;
+/* Cache is optional. See iot/http/http_cache.h. */
+struct http_cache_module;
+struct http_cache_entry;
 /**
  * \brief Callback interface of HTTP client service.
  *
@@ -255,23 +404,125 @@ struct http_client_config {
 	 * Default value is 256.
 	 */
 	uint32_t recv_buffer_size;
+	/**
+	 * Tx buffer.
+	 * If this value is NULL, The buffer is allocated in the heap when the module is initialized.
+	 * The buffer is used until the request was sent. So it cannot be shared with the other module.
+	 * Default value is NULL.
+	 */
+	char *send_buffer;
 	/**
 	 * Send buffer size in the HTTP client service.
-	 * This buffer is located in the stack.
-	 * Therefore, The size of the buffer increases the speed will increase, but it may cause a stack overflow.
+	 * This is the maximum size of the each packet which is passed to the socket.
 	 * Apache server is not supported that packet header is divided in the multiple packets.
-	 * So, it MUST bigger than 192.
-	 * Default value is 192.
+	 * So, it MUST be between MIN_SEND_BUFFER_SIZE and SOCKET_BUFFER_MAX_LENGTH.
+	 * Default value is MIN_SEND_BUFFER_SIZE.
 	 */
 	uint32_t send_buffer_size;
+	/**
+	 * Maximum number of the entity packets which can be in flight at the same time.
+	 * The send window is started with this value and it is adjusted between one packet and this value.
+	 * It grows one packet per window on each completion and halves when WINC reports that its buffer is full.
+	 * Default value is 6.
+	 */
+	uint8_t send_window_max;
+	/**
+	 * Size of the history window for the gzip and deflate content encoding.
+	 * If this value is zero, The encoding is not requested and the compressed response is rejected.
+	 * Otherwise, It MUST be between HTTP_INFLATE_MIN_WINDOW_SIZE and HTTP_INFLATE_MAX_WINDOW_SIZE.
+	 * Server which uses the bigger window than this value can be failed.
+	 * Default value is 0.
+	 */
+	uint32_t inflate_window_size;
+	/**
+	 * Memory of the decoder and its window. Its size MUST be HTTP_CLIENT_INFLATE_BUFFER_SIZE(inflate_window_size)
+	 * and it MUST be aligned to the word.
+	 * If this value is NULL, The memory is taken from the buffer pool, or allocated in the heap if the pool is not configured.
+	 * Default value is NULL.
+	 */
+	void *inflate_buffer;
 	/**
 	 * User agent of this client.
 	 * This value is must located in the Heap or code region.
 	 * Default value is Atmel/{version}
 	 */
 	const char *user_agent;
+	/**
+	 * Default headers which are sent in every request. Bit mask of \ref http_client_default_header.
+	 * These headers are serialized once per host and reused for the following requests.
+	 * Default value is HTTP_CLIENT_DEFAULT_HEADERS.
+	 */
+	uint32_t default_headers;
+	/**
+	 * Maximum number of the requests which are sent without waiting the responses of the previous requests.
+	 * Only GET, HEAD and OPTIONS requests without the entity and the range are pipelined.
+	 * While the pipelined requests are not answered, The other requests return -EAGAIN.
+	 * If this value is zero, The pipelining is disabled.
+	 * It MUST NOT be bigger than HTTP_CLIENT_PIPELINE_MAX_DEPTH.
+	 * Default value is 0.
+	 */
+	uint8_t pipeline_depth;
+	/**
+	 * Cache of the resources which were stored in the files. See \ref http_cache_init.
+	 * If the GET request is found in the cache, If-None-Match and If-Modified-Since headers are sent
+	 * and the 304 response is reported with the path of the cached file.
+	 * The application records the downloaded file with \ref http_cache_store.
+	 * The pipelined requests and the range requests are not validated.
+	 * The entry of the current request is taken from the buffer pool, or allocated in the heap if the pool is not configured.
+	 * Default value is NULL.
+	 */
+	struct http_cache_module *cache;
+	/**
+	 * Size of the memory which keeps the small GET responses. Unit is bytes.
+	 * Response which fits in the receive buffer is kept if its freshness lifetime is known
+	 * from the Cache-Control max-age directive or the Expires header.
+	 * Until the response is expired, The same URL is answered in \ref http_client_send_request without the socket.
+	 * The least recently used response is removed when the memory is full.
+	 * If this value is zero, The response cache is disabled.
+	 * Default value is 0.
+	 */
+	uint32_t response_cache_size;
+	/**
+	 * Memory of the response cache. Its size MUST be response_cache_size and it MUST be aligned to the word.
+	 * If this value is NULL, The memory is taken from the buffer pool, or allocated in the heap if the pool is not configured.
+	 * Default value is NULL.
+	 */
+	char *response_cache_buffer;
+	/**
+	 * Pool of the memory of the module. See \ref http_pool_init.
+	 * The receive and send buffers, The decoder and the response cache which are not given in recv_buffer, send_buffer,
+	 * inflate_buffer and response_cache_buffer are taken from this pool instead of the heap. So is the entry of the cache.
+	 * Its block size MUST NOT be smaller than any of them, or \ref http_client_init fails with -ENOMEM.
+	 * The pool can be shared by the modules. The heap is not used by \ref http_client_init if this pool is set.
+	 * Default value is NULL.
+	 */
+	struct http_pool *buffer_pool;
+	/**
+	 * Pool of the strings of each request. They are the extension header and the URI of the pipelined request.
+	 * If it is set, The strings are not allocated in the heap for every request.
+	 * Request whose string is longer than the block size is failed with -ENOMEM.
+	 * Default value is NULL.
+	 */
+	struct http_pool *string_pool;
 };
 
+/**
+ * \brief Byte range of the request.
+ *
+ * It is used to resume the interrupted download. See \ref http_client_send_request_range.
+ */
+struct http_client_range {
+	/** Position of the first byte to be requested. */
+	uint32_t start;
+	/** Number of bytes to be requested. Zero requests the rest of the resource. */
+	uint32_t length;
+	/**
+	 * ETag or Last-Modified of the partially received resource. It is sent in the If-Range header.
+	 * If the resource was changed, The server sends the whole resource with 200 OK instead of 206 Partial Content.
+	 * NULL sends the range request unconditionally.
+	 */
+	const char *validator;
+};
 
 /**
  * \brief HTTP client request instance.
@@ -289,9 +540,21 @@ struct http_client_req {
 	int content_length;
 	/** The size of the data sent. */
 	int sent_length;
-	/** 
-	 * Extension header of the HTTP request. It is located in the heap memory. 
-	 * Use of a little size of the extension header can be caused memory fragmentation.
+	/** The size of the header which was accepted by the socket. */
+	uint32_t header_sent;
+	/** A flag that whether the Range header is sent or not. */
+	uint8_t range_requested;
+	/** First byte position of the requested range. */
+	uint32_t range_start;
+	/** Size of the requested range. Zero means the rest of the resource. */
+	uint32_t range_length;
+	/** Value of the If-Range header. Empty string if the range is requested unconditionally. */
+	char if_range[HTTP_MAX_HEADER_VALUE_LENGTH];
+	/** A flag that whether the request is validated with the cached resource in \ref http_client_module.cache_entry. */
+	uint8_t cache_hit;
+	/**
+	 * Extension header of the HTTP request. It is located in \ref http_client_config.string_pool or the heap memory.
+	 * Without the pool, Use of a little size of the extension header can be caused memory fragmentation.
 	 */
 	char *ext_header;
 };
@@ -308,6 +571,56 @@ struct http_client_resp {
 	int read_length;
 	/** Response code of this response. */
 	uint16_t response_code;
+	/** State of the chunked transfer decoder. */
+	uint8_t chunk_state;
+	/** Content-Encoding of this response. See \ref http_inflate_format. Zero means the identity encoding. */
+	uint8_t content_encoding;
+	/** First byte position from the Content-Range header. */
+	uint32_t range_start;
+	/** Size of the whole resource from the Content-Range header. Zero if it is unknown. */
+	uint32_t total_length;
+	/** ETag of this response. */
+	char etag[HTTP_MAX_HEADER_VALUE_LENGTH];
+	/** Last-Modified of this response. */
+	char last_modified[HTTP_MAX_HEADER_VALUE_LENGTH];
+	/** max-age directive of the Cache-Control header. Unit is seconds. It is valid only if has_max_age is set. */
+	uint32_t max_age;
+	/** A flag that the max-age directive was received. */
+	uint8_t has_max_age;
+	/** A flag that the response must not be reused. (no-store or no-cache directive) */
+	uint8_t no_store;
+	/** Expires header in seconds since 1970. Zero if it was not received. */
+	uint32_t expires;
+	/** Date header in seconds since 1970. Zero if it was not received. */
+	uint32_t date;
+	/** Age header. Unit is seconds. */
+	uint32_t age;
+	/** Position of the header parser. It is kept across the received packets. */
+	uint8_t header_state;
+	/** Header which is currently parsed. */
+	uint8_t header_id;
+	/** Offset in the current header name or status line. */
+	uint8_t header_pos;
+	/** Length of the buffered header value. */
+	uint8_t value_length;
+	/** Bit mask of the known header names which still match the parsed name. */
+	uint32_t header_candidates;
+	/** Value of the current header. Only filled for the headers which are interpreted. */
+	char value[HTTP_MAX_HEADER_VALUE_LENGTH];
+};
+
+/**
+ * \brief Pipelined request which was not answered yet.
+ *
+ * It is kept until the response is received for sending it again when the server closed the connection.
+ */
+struct http_client_pipeline_entry {
+	/** Method of the request. */
+	uint8_t method;
+	/** URI of the request. It is located in \ref http_client_config.string_pool or the heap memory. */
+	char *uri;
+	/** Extension header of the request. It is located in the same memory as the uri. NULL if it is not used. */
+	char *ext_header;
 };
 
 /**
@@ -319,15 +632,42 @@ struct http_client_module {
 	/** Destination host address of the session. */
 	char host[HOSTNAME_MAX_SIZE];
 
-	/** A flag for the socket is sending. */
-	uint8_t sending	        : 1;
 	/** A flag that whether using the permanent connection or not. */
 	uint8_t permanent       : 1;
-	/** A flag for the receive buffer located in the heap. */
+	/** A flag for the receive buffer located in the heap or the buffer pool. */
 	uint8_t alloc_buffer    : 1;
-
-	/** Size that received. */
+	/** A flag for the send buffer located in the heap or the buffer pool. */
+	uint8_t alloc_send_buffer : 1;
+	/** A flag that whether waiting the result of gethostbyname or not. */
+	uint8_t resolving       : 1;
+	/** A flag that whether the response of the sent request is not finished yet. */
+	uint8_t waiting_response : 1;
+	/** A flag that the pipelined requests are sent one by one because the server dropped the pipeline. */
+	uint8_t pipeline_serial : 1;
+
+	/** Idle timeout of the connection from the Keep-Alive header. Unit is seconds. Zero if it is unknown. */
+	uint16_t keep_alive_timeout;
+	/** Number of the requests which are allowed in the connection from the Keep-Alive header. 0xFFFF if it is unknown. */
+	uint16_t keep_alive_max;
+
+	/** Size of the unread data in the receive buffer. */
 	uint32_t recved_size;
+	/** Read position of the receive buffer. The receive buffer is used as a circular buffer. */
+	uint32_t recv_head;
+	/** Total size of the data received from the socket. See \ref http_client_print_timing. */
+	uint32_t recv_total;
+	/**
+	 * Total size of the received data which was copied inside of the receive buffer.
+	 * Divided by recv_total, it is the number of the copies of each received byte.
+	 */
+	uint32_t recv_copied;
+
+	/** Current size of the send window in bytes. */
+	uint32_t send_window;
+	/** Size of the data which was sent but its completion was not received yet. */
+	uint32_t send_inflight;
+	/** Number of the packets which were sent but its completion was not received yet. */
+	uint8_t send_inflight_count;
 
 	/** SW Timer ID for the request time out. */
 	int timer_id;
@@ -338,6 +678,44 @@ struct http_client_module {
 	/** Configuration instance of HTTP client module. That was registered from the \ref http_client_init*/
 	struct http_client_config config;
 
+	/** Decoder of the compressed entity. The window is located after this instance. It is inflate_buffer or allocated. */
+	struct http_inflate *inflate;
+
+	/** Cached resource of the current request. It is allocated in the buffer pool or the heap if the cache is configured. */
+	struct http_cache_entry *cache_entry;
+
+	/** Memory of the response cache. The records are packed from the start of it. */
+	char *response_cache;
+	/** Size of the records in the response cache. */
+	uint32_t response_cache_used;
+	/** Counter which is increased on every use of the response cache. The records are ordered by it. */
+	uint32_t response_cache_clock;
+	/** Number of the requests which were answered from the response cache. */
+	uint32_t response_cache_hits;
+	/** Number of the cacheable requests which were not found in the response cache. */
+	uint32_t response_cache_misses;
+
+	/** Latency breakdown of the current request. */
+	struct http_client_timing timing;
+	/** Latency histograms of the finished requests. See \ref http_client_print_timing. */
+	struct http_client_timing_stats timing_stats;
+
+	/** Serialized default headers for the current host. */
+	char header_template[HTTP_MAX_HEADER_TEMPLATE_LENGTH];
+	/** Size of the serialized default headers. If this value is zero, it will be rebuilt in the next request. */
+	uint16_t header_template_length;
+
+	/** Queue of the pipelined requests. It is used as a circular buffer of config.pipeline_depth entries. */
+	struct http_client_pipeline_entry pipeline[HTTP_CLIENT_PIPELINE_MAX_DEPTH];
+	/** Index of the oldest request in the pipeline queue. Next response is matched with it. */
+	uint8_t pipeline_head;
+	/** Number of the requests in the pipeline queue. */
+	uint8_t pipeline_count;
+	/** Number of the requests in the pipeline queue which were passed to the request writer. */
+	uint8_t pipeline_sent;
+	/** Number of the times that the queue was sent again after the last response. */
+	uint8_t pipeline_retry;
+
 	/** Data relating the request. */
 	struct http_client_req req;
 
@@ -473,6 +851,14 @@ void http_client_socket_resolve_handler(uint8_t *doamin_name, uint32_t server_ip
 /**
  * \brief Event handler of gethostbyname.
  *
+ * If \ref http_client_config.pipeline_depth is not zero, The request can be sent
+ * while the responses of the previous requests are not received yet.
+ * The responses are reported in the order of the requests.
+ *
+ * If the response of the GET request is found in the response cache, See \ref http_client_config.response_cache_size,
+ * HTTP_CLIENT_CALLBACK_RECV_RESPONSE is called before this function returns and nothing is sent.
+ * It is only used while no other response is waited. Request with the other method removes the response of the URL.
+ *
  * \param[in]  module_inst     Instance of HTTP client module.
  * \param[in]  url             URL of request.
  * \param[in]  method          Method of request.
@@ -496,13 +882,40 @@ void http_client_socket_resolve_handler(uint8_t *doamin_name, uint32_t server_ip
  * \return     -EBADMSG        Not a data message.
  * \return     -ENOMEM         Out of memory.
  * \return     -ENOTSUP        Unsupported operation.
+ * \return     -EHOSTUNREACH   Host was not found in the recent resolution.
  */
 int http_client_send_request(struct http_client_module *const module, const char *url,
 	enum http_method method, struct http_entity *const entity, const char *ext_header);
 
+/**
+ * \brief Send the request which requires the part of the resource.
+ *
+ * Range and If-Range headers are added to the request.
+ * If the server supports the range, The response code is 206 and the position of the entity is reported in
+ * \ref http_client_data_recv_response. Otherwise, The whole resource is received with 200 OK.
+ *
+ * \param[in]  module_inst     Instance of HTTP client module.
+ * \param[in]  url             URL of request.
+ * \param[in]  method          Method of request.
+ * \param[in]  entity          Entity of request. Entity is consist of Entity header and Entity body Please refer to \ref http_entity.
+ * \param[in]  ext_header      Extension header of the request.It must ends with new line character(\r\n).
+ * \param[in]  range           Byte range of the request. NULL is same as \ref http_client_send_request.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENAMETOOLONG   Validator or URI is too long.
+ * \return     Others          Same as \ref http_client_send_request.
+ */
+int http_client_send_request_range(struct http_client_module *const module, const char *url,
+	enum http_method method, struct http_entity *const entity, const char *ext_header,
+	const struct http_client_range *range);
+
 /**
  * \brief Force close HTTP connection.
  *
+ * The keep-alive connection is moved to the connection pool when its response was finished.
+ * Such an idle connection is not owned by the module any more, so it is not closed by this function.
+ *
  * \param[in]  module_inst     Instance of HTTP client module.
  *
  * \return     0               Function succeeded
@@ -525,6 +938,22 @@ int http_client_send_request(struct http_client_module *const module, const char
  */
 int http_client_close(struct http_client_module *const module);
 
+/**
+ * \brief Print the latency histograms of the finished requests to the console.
+ *
+ * The received bytes and the bytes which were copied inside of the receive buffer are printed too.
+ *
+ * \param[in]  module          Instance of HTTP client module.
+ */
+void http_client_print_timing(struct http_client_module *const module);
+
+/**
+ * \brief Clear the latency histograms and the receive counters.
+ *
+ * \param[in]  module          Instance of HTTP client module.
+ */
+void http_client_reset_timing(struct http_client_module *const module);
+
 
 #ifdef __cplusplus
 }
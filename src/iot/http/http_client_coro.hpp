@@ -0,0 +1,711 @@
+/**
+ * \file
+ *
+ * \brief C++20 coroutine interface of the HTTP client service.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_CLIENT_CORO_HPP_INCLUDED
+#define HTTP_CLIENT_CORO_HPP_INCLUDED
+
+/*
+ * Sequential request code on top of the callbacks of http_client and sw_timer.
+ * Everything is in this header and no heap is used. Coroutine frames come from a static pool.
+ *
+ * \code
+ *    static char body_buffer[1460];
+ *    iot::http_client client(&http_client_module_inst, &reactor_inst, body_buffer, sizeof(body_buffer));
+ *    iot::timer timer(&swt_module_inst, &reactor_inst);
+ *
+ *    iot::task upload_then_poll(iot::http_client &client, iot::timer &timer)
+ *    {
+ *        if (co_await client.send_request(MAIN_HTTP_POST_URL, HTTP_METHOD_POST, &entity) < 0) {
+ *            co_return;
+ *        }
+ *        iot::http_response resp = co_await client.response();
+ *        for (;;) {
+ *            iot::http_chunk chunk = co_await client.read_body_chunk();
+ *            ...
+ *            if (chunk.last) break;
+ *        }
+ *        co_await timer.sleep(1000);
+ *        ...
+ *    }
+ * \endcode
+ *
+ * The callback of the event does not run the coroutine. It posts the resumption to the reactor
+ * (See iot/reactor.h), so the coroutine runs after the callback returned and may start the next request.
+ * The entity is copied to the buffer of \ref iot::http_client, because the receive buffer of the module
+ * is reused when the callback returns. Parts which arrive before the coroutine reads them are appended.
+ * The pointer in \ref iot::http_chunk is valid until the next co_await.
+ * If the buffer overflows, The rest is discarded and the next chunk has -ENOBUFS in its result.
+ */
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <errno.h>
+/* WINC driver headers use the C11 keyword which C++ does not have. */
+#define _Static_assert static_assert
+#include "iot/http/http_client.h"
+#include "iot/sw_timer.h"
+#include "iot/reactor.h"
+#undef _Static_assert
+
+#ifndef CONF_HTTP_CORO_FRAME_SIZE
+/** Size of the one coroutine frame. See \ref iot::frame_pool_stats.largest for the actual size. */
+#  define CONF_HTTP_CORO_FRAME_SIZE    512
+#endif
+#ifndef CONF_HTTP_CORO_FRAME_COUNT
+/** Maximum number of the coroutines which are running at the same time. */
+#  define CONF_HTTP_CORO_FRAME_COUNT   2
+#endif
+#ifndef CONF_HTTP_CORO_CLIENT_COUNT
+/** Maximum number of the \ref iot::http_client which exist at the same time. */
+#  define CONF_HTTP_CORO_CLIENT_COUNT  1
+#endif
+
+static_assert(CONF_HTTP_CORO_FRAME_COUNT <= 32, "CONF_HTTP_CORO_FRAME_COUNT must not be greater than 32.");
+
+namespace iot {
+
+/**
+ * \brief Handler of the reactor event which resumes the coroutine.
+ */
+inline void resume_posted(struct reactor_module *const, void *context)
+{
+	std::coroutine_handle<>::from_address(context).resume();
+}
+
+/**
+ * \brief Resume the coroutine from the reactor instead of the callback which completed its wait.
+ *
+ * If the queue of the reactor is full, It is resumed immediately. That is better than losing it.
+ */
+inline void resume_later(struct reactor_module *reactor, std::coroutine_handle<> handle) noexcept
+{
+	if (reactor == nullptr || reactor_post(reactor, &resume_posted, handle.address()) < 0) {
+		handle.resume();
+	}
+}
+
+/**
+ * \brief Statistics of the frame pool.
+ */
+struct frame_pool_stats {
+	/** Number of the frames in use. */
+	uint8_t used;
+	/** Maximum number of the frames which were used at the same time. */
+	uint8_t peak;
+	/** Size of the biggest frame which was requested. */
+	uint16_t largest;
+	/** Number of the coroutines which could not be started. */
+	uint32_t failed;
+};
+
+/**
+ * \brief Static pool of the coroutine frames.
+ *
+ * Frames are allocated and released only in the main context, so no locking is needed.
+ */
+class frame_pool {
+public:
+	/**
+	 * \brief Take a free block for the frame.
+	 *
+	 * \return     Block of the frame. nullptr if the frame is too big or all of the blocks are used.
+	 */
+	static void *allocate(std::size_t size) noexcept
+	{
+		if (size > stats_.largest) {
+			stats_.largest = (uint16_t)size;
+		}
+		if (size <= CONF_HTTP_CORO_FRAME_SIZE) {
+			for (uint8_t i = 0; i < CONF_HTTP_CORO_FRAME_COUNT; i++) {
+				if (!(used_ & (1UL << i))) {
+					used_ |= 1UL << i;
+					if (++stats_.used > stats_.peak) {
+						stats_.peak = stats_.used;
+					}
+					return blocks_[i].data;
+				}
+			}
+		}
+		stats_.failed++;
+		return nullptr;
+	}
+
+	/**
+	 * \brief Return the block of the finished coroutine.
+	 */
+	static void release(void *frame) noexcept
+	{
+		std::size_t i = static_cast<block *>(frame) - blocks_;
+
+		used_ &= ~(1UL << i);
+		stats_.used--;
+	}
+
+	/**
+	 * \brief Get the usage of the pool.
+	 */
+	static const frame_pool_stats &stats() noexcept
+	{
+		return stats_;
+	}
+
+private:
+	/** One frame. */
+	struct alignas(std::max_align_t) block {
+		unsigned char data[CONF_HTTP_CORO_FRAME_SIZE];
+	};
+
+	static inline block blocks_[CONF_HTTP_CORO_FRAME_COUNT];
+	/** Bitmap of the blocks in use. */
+	static inline uint32_t used_;
+	static inline frame_pool_stats stats_;
+};
+
+/**
+ * \brief Return type of the coroutine which is started immediately and destroys itself when it returns.
+ *
+ * It is false if the frame could not be allocated. In that case, The body was not run.
+ */
+class task {
+public:
+	struct promise_type {
+		static void *operator new(std::size_t size) noexcept
+		{
+			return frame_pool::allocate(size);
+		}
+		static void operator delete(void *frame) noexcept
+		{
+			frame_pool::release(frame);
+		}
+		static task get_return_object_on_allocation_failure() noexcept
+		{
+			return task(false);
+		}
+		task get_return_object() noexcept
+		{
+			return task(true);
+		}
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+		void return_void() noexcept
+		{
+		}
+		void unhandled_exception() noexcept
+		{
+		}
+	};
+
+	explicit operator bool() const noexcept
+	{
+		return started_;
+	}
+
+private:
+	explicit task(bool started) noexcept : started_(started)
+	{
+	}
+
+	bool started_;
+};
+
+/**
+ * \brief Response header which is returned by \ref http_client::response.
+ */
+struct http_response {
+	/** 0 if the response was received. Otherwise, The reason of the disconnection. */
+	int result;
+	/** Response code of HTTP request. */
+	uint16_t response_code;
+	/** A flag that the length of the entity is not known. */
+	uint8_t is_chunked;
+	/** Length of entity. */
+	uint32_t content_length;
+	/** Position of the entity in the whole resource. See \ref http_client_data_recv_response. */
+	uint32_t range_start;
+	/** Size of the whole resource. See \ref http_client_data_recv_response. */
+	uint32_t total_length;
+};
+
+/**
+ * \brief Part of the entity which is returned by \ref http_client::read_body_chunk.
+ */
+struct http_chunk {
+	/**
+	 * 0 if the data was received. -ENOBUFS if some data before the end of this part was discarded.
+	 * Otherwise, The reason of the disconnection.
+	 */
+	int result;
+	/** Received data. It is valid until the next co_await. */
+	const char *data;
+	/** Length of the data. */
+	uint32_t length;
+	/** A flag that this is the last part of the entity. */
+	bool last;
+};
+
+/**
+ * \brief Awaitable wrapper of the HTTP client module.
+ *
+ * The wrapper registers the callback of the module. One request is handled at a time.
+ */
+class http_client {
+public:
+	/**
+	 * \param[in]  module          Module instance of HTTP.
+	 * \param[in]  reactor         Reactor which resumes the coroutine.
+	 * \param[in]  buffer          Buffer of the entity. Size of the receive buffer of the module is enough
+	 *                             if the coroutine reads each part before the next one arrives.
+	 * \param[in]  buffer_size     Size of the buffer.
+	 */
+	http_client(struct http_client_module *module, struct reactor_module *reactor, char *buffer, uint32_t buffer_size) noexcept
+		: module_(module), reactor_(reactor), buffer_(buffer), buffer_size_(buffer_size)
+	{
+		for (auto &slot : clients_) {
+			if (slot == nullptr) {
+				slot = this;
+				http_client_register_callback(module_, &http_client::callback);
+				return;
+			}
+		}
+		module_ = nullptr;
+	}
+
+	~http_client()
+	{
+		for (auto &slot : clients_) {
+			if (slot == this) {
+				http_client_unregister_callback(module_);
+				slot = nullptr;
+			}
+		}
+	}
+
+	http_client(const http_client &) = delete;
+	http_client &operator=(const http_client &) = delete;
+
+	/**
+	 * \brief Send the request and wait until it was sent.
+	 *
+	 * \return     0 if the request was sent. Otherwise, The error of \ref http_client_send_request or the disconnection.
+	 */
+	auto send_request(const char *url, enum http_method method = HTTP_METHOD_GET,
+		struct http_entity *entity = nullptr, const char *ext_header = nullptr) noexcept
+	{
+		struct awaiter : waiter {
+			int await_resume() noexcept
+			{
+				return client.finish_send(mask);
+			}
+		};
+		return awaiter{{*this, start(url, method, entity, ext_header), REQUESTED}};
+	}
+
+	/**
+	 * \brief Send the request and wait until the socket was connected.
+	 *
+	 * The request is sent after the connection. Use \ref requested to wait for it.
+	 * If the connection of the previous request was reused, It completes when the request was sent.
+	 *
+	 * \return     Result of the connection. See \ref http_client_data_sock_connected.
+	 */
+	auto connect(const char *url, enum http_method method = HTTP_METHOD_GET,
+		struct http_entity *entity = nullptr, const char *ext_header = nullptr) noexcept
+	{
+		struct awaiter : waiter {
+			int await_resume() noexcept
+			{
+				return client.finish_send(mask);
+			}
+		};
+		return awaiter{{*this, start(url, method, entity, ext_header), CONNECTED | REQUESTED}};
+	}
+
+	/**
+	 * \brief Wait until the request which was started by \ref connect was sent.
+	 */
+	auto requested() noexcept
+	{
+		struct awaiter : waiter {
+			int await_resume() noexcept
+			{
+				return client.finish_send(mask);
+			}
+		};
+		return awaiter{{*this, 0, REQUESTED}};
+	}
+
+	/**
+	 * \brief Wait for the response header.
+	 */
+	auto response() noexcept
+	{
+		struct awaiter : waiter {
+			http_response await_resume() noexcept
+			{
+				if (!(client.pending_ & RESPONSE)) {
+					return http_response{client.reason(), 0, 0, 0, 0, 0};
+				}
+				client.pending_ &= ~RESPONSE;
+				return client.response_;
+			}
+		};
+		return awaiter{{*this, 0, RESPONSE}};
+	}
+
+	/**
+	 * \brief Wait for the next part of the entity.
+	 *
+	 * After the last part, It returns an empty chunk with the last flag immediately.
+	 */
+	auto read_body_chunk() noexcept
+	{
+		struct awaiter : waiter {
+			http_chunk await_resume() noexcept
+			{
+				http_chunk chunk = client.chunk_;
+
+				if (client.pending_ & BODY) {
+					client.pending_ &= ~BODY;
+					if (chunk.last) {
+						/* Later calls return the end of the entity. */
+						client.chunk_ = http_chunk{0, nullptr, 0, true};
+						client.pending_ |= BODY;
+					}
+				} else {
+					chunk = http_chunk{client.reason(), nullptr, 0, true};
+				}
+				return chunk;
+			}
+		};
+		return awaiter{{*this, 0, BODY}};
+	}
+
+	/**
+	 * \brief Close the connection.
+	 */
+	int close() noexcept
+	{
+		return http_client_close(module_);
+	}
+
+	/**
+	 * \brief Number of the entity bytes which were discarded because the buffer was full.
+	 */
+	uint32_t dropped() const noexcept
+	{
+		return dropped_;
+	}
+
+	/**
+	 * \brief A flag that the callback was registered. It is false if there are too many clients.
+	 */
+	explicit operator bool() const noexcept
+	{
+		return module_ != nullptr;
+	}
+
+private:
+	/** Events which were received but not consumed yet. */
+	enum : uint8_t {
+		CONNECTED = 0x01,
+		REQUESTED = 0x02,
+		RESPONSE = 0x04,
+		BODY = 0x08,
+		DISCONNECTED = 0x10,
+	};
+
+	/**
+	 * \brief Common part of the awaiters.
+	 *
+	 * It is ready if the event was received already or the request was failed to start.
+	 */
+	struct waiter {
+		http_client &client;
+		int error;
+		uint8_t mask;
+
+		bool await_ready() const noexcept
+		{
+			return error < 0 || (client.pending_ & (mask | DISCONNECTED));
+		}
+		void await_suspend(std::coroutine_handle<> handle) noexcept
+		{
+			client.handle_ = handle;
+			client.wait_mask_ = mask;
+		}
+	};
+
+	/**
+	 * \brief Start the new request and forget the events of the previous one.
+	 */
+	int start(const char *url, enum http_method method, struct http_entity *entity, const char *ext_header) noexcept
+	{
+		int ret;
+
+		if (module_ == nullptr) {
+			return -EINVAL;
+		}
+		pending_ = 0;
+		ret = http_client_send_request(module_, url, method, entity, ext_header);
+		if (ret < 0) {
+			error_ = ret;
+		}
+		return ret;
+	}
+
+	/**
+	 * \brief Result of \ref send_request, \ref connect and \ref requested.
+	 */
+	int finish_send(uint8_t mask) noexcept
+	{
+		int ret;
+
+		if (error_ < 0) {
+			ret = error_;
+			error_ = 0;
+			return ret;
+		}
+		if (!(pending_ & mask)) {
+			return reason();
+		}
+		if (pending_ & CONNECTED & mask) {
+			pending_ &= ~CONNECTED;
+			return connect_result_;
+		}
+		if (!(mask & CONNECTED)) {
+			/* Reused connection completes connect with REQUESTED. It is left for requested. */
+			pending_ &= ~REQUESTED;
+		}
+		pending_ &= ~CONNECTED;
+		return 0;
+	}
+
+	/**
+	 * \brief Reason of the disconnection which ended the waiting.
+	 */
+	int reason() const noexcept
+	{
+		return reason_ < 0 ? reason_ : -ECONNRESET;
+	}
+
+	/**
+	 * \brief Record the event and resume the coroutine which is waiting for it.
+	 */
+	void handle(int type, union http_client_data *data) noexcept
+	{
+		std::coroutine_handle<> waiting;
+		uint8_t event;
+
+		switch (type) {
+		case HTTP_CLIENT_CALLBACK_SOCK_CONNECTED:
+			connect_result_ = data->sock_connected.result;
+			event = CONNECTED;
+			break;
+		case HTTP_CLIENT_CALLBACK_REQUESTED:
+			event = REQUESTED;
+			break;
+		case HTTP_CLIENT_CALLBACK_RECV_RESPONSE:
+			response_ = http_response{0, data->recv_response.response_code, data->recv_response.is_chunked,
+				data->recv_response.content_length, data->recv_response.range_start, data->recv_response.total_length};
+			event = RESPONSE;
+			if (data->recv_response.content != nullptr || (!data->recv_response.is_chunked && data->recv_response.content_length == 0)) {
+				/* Whole entity is in the buffer. */
+				body(data->recv_response.content, data->recv_response.content != nullptr ? data->recv_response.content_length : 0, true);
+			}
+			break;
+		case HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA:
+			body(data->recv_chunked_data.data, data->recv_chunked_data.length, data->recv_chunked_data.is_complete);
+			event = 0;
+			break;
+		case HTTP_CLIENT_CALLBACK_DISCONNECTED:
+			reason_ = data->disconnected.reason;
+			event = DISCONNECTED;
+			break;
+		default:
+			return;
+		}
+		pending_ |= event;
+		if (handle_ && (pending_ & (wait_mask_ | DISCONNECTED))) {
+			waiting = handle_;
+			handle_ = nullptr;
+			/* The wrapper can be destroyed by the coroutine. Nothing is touched after this. */
+			resume_later(reactor_, waiting);
+		}
+	}
+
+	/**
+	 * \brief Copy the part of the entity to the buffer until the coroutine reads it.
+	 */
+	void body(const char *data, uint32_t length, bool last) noexcept
+	{
+		uint32_t room;
+
+		if (!(pending_ & BODY) || chunk_.last) {
+			/* Previous part was read. */
+			chunk_ = http_chunk{0, buffer_, 0, false};
+		}
+		room = buffer_size_ - chunk_.length;
+		if (length > room) {
+			/* The coroutine finds the gap in the result. */
+			dropped_ += length - room;
+			chunk_.result = -ENOBUFS;
+			length = room;
+		}
+		if (length > 0) {
+			std::memcpy(buffer_ + chunk_.length, data, length);
+			chunk_.length += length;
+		}
+		chunk_.last = last;
+		pending_ |= BODY;
+	}
+
+	/**
+	 * \brief Callback of the HTTP client module.
+	 */
+	static void callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+	{
+		for (auto *client : clients_) {
+			if (client != nullptr && client->module_ == module_inst) {
+				client->handle(type, data);
+				return;
+			}
+		}
+	}
+
+	static inline http_client *clients_[CONF_HTTP_CORO_CLIENT_COUNT];
+
+	struct http_client_module *module_;
+	struct reactor_module *reactor_;
+	char *buffer_;
+	uint32_t buffer_size_;
+	std::coroutine_handle<> handle_;
+	http_response response_{};
+	http_chunk chunk_{};
+	int connect_result_ = 0;
+	int reason_ = 0;
+	int error_ = 0;
+	uint32_t dropped_ = 0;
+	uint8_t pending_ = 0;
+	uint8_t wait_mask_ = 0;
+};
+
+/**
+ * \brief Awaitable one-shot timer on the SW timer.
+ *
+ * The timer slot is registered in the constructor, so waiting never fails for the lack of the slot.
+ */
+class timer {
+public:
+	timer(struct sw_timer_module *module, struct reactor_module *reactor) noexcept
+		: module_(module), reactor_(reactor), id_(sw_timer_register_callback(module, &timer::expired, this, 0))
+	{
+	}
+
+	~timer()
+	{
+		if (id_ >= 0) {
+			sw_timer_unregister_callback(module_, id_);
+		}
+	}
+
+	timer(const timer &) = delete;
+	timer &operator=(const timer &) = delete;
+
+	/**
+	 * \brief Wait for the time.
+	 *
+	 * \param[in]  delay           Time to wait. Unit is milliseconds.
+	 *
+	 * \return     0 if the time was passed. -ENOSPC if no timer slot was free.
+	 */
+	auto sleep(uint32_t delay) noexcept
+	{
+		struct awaiter {
+			timer &owner;
+			uint32_t delay;
+
+			bool await_ready() const noexcept
+			{
+				return owner.id_ < 0;
+			}
+			void await_suspend(std::coroutine_handle<> handle) noexcept
+			{
+				owner.handle_ = handle;
+				sw_timer_enable_callback(owner.module_, owner.id_, delay);
+			}
+			int await_resume() const noexcept
+			{
+				return owner.id_ < 0 ? -ENOSPC : 0;
+			}
+		};
+		return awaiter{*this, delay};
+	}
+
+private:
+	static void expired(struct sw_timer_module *const, int, void *context, int)
+	{
+		timer *owner = static_cast<timer *>(context);
+		std::coroutine_handle<> handle = owner->handle_;
+
+		owner->handle_ = nullptr;
+		if (handle) {
+			resume_later(owner->reactor_, handle);
+		}
+	}
+
+	struct sw_timer_module *module_;
+	struct reactor_module *reactor_;
+	int id_;
+	std::coroutine_handle<> handle_;
+};
+
+} /* namespace iot */
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_CLIENT_CORO_HPP_INCLUDED */
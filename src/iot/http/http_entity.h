@@ -43,23 +43,10 @@
 extern "C" {
 #endif
 
-typedef enum{
-	HTTP_FILE_FORMAT_NONE = 0,
-	HTTP_FILE_FORMAT_FIT = 1,
-	HTTP_FILE_FORMAT_TXT = 2,
-}fileFormat;
-
 /**
  * \brief A structure that the implementation of HTTP entity.
  */
 struct http_entity {
-	
-	/** A flag for indication of the file type. */
-	fileFormat file_format;
-	
-	/** File Object if post file to http server */
-	FIL file_object;
-	
 	/** A flag for the using the chunked encoding transfer or not. */
 	uint8_t is_chunked;
 	/**
@@ -90,20 +77,6 @@ struct http_entity {
 	 * \return     Read size.
 	 */
 	int (*read)(void *priv_data, char *buffer, uint32_t size, uint32_t written);
-	
-	
-	/**
-	 * \brief Read the content.
-	 *
-	 * \param[in]  file			   file object that need to post to HTTP server
-	 * \param[in]  buffer          A buffer that stored read data.
-	 * \param[in]  size            Maximum size of the buffer.
-	 * \param[in]  written         total size of ever read.
-	 *
-	 * \return     Read size.
-	 */
-	int (*read_file)(void *priv_data, FIL* file, char *buffer, uint32_t size, uint32_t written);
-	
 	/**
 	 * \brief Close the entity.
 	 * Completed to send request. So release the resource.
@@ -113,7 +86,6 @@ struct http_entity {
 	void (*close)(void *priv_data);
 	/** Private data of this entity. Stored various data necessary for the operation of the entity. */
 	void *priv_data;
-
 };
 
 #ifdef __cplusplus
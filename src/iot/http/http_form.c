@@ -0,0 +1,244 @@
+/**
+ * \file
+ *
+ * \brief Streaming encoder of the application/x-www-form-urlencoded entity.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/http/http_form.h"
+#include <string.h>
+#include <errno.h>
+
+/**
+ * \brief Parts of the encoded field. "&{name}={value}"
+ */
+enum http_form_part {
+	PART_SEPARATOR = 0,
+	PART_NAME,
+	PART_EQUAL,
+	PART_VALUE,
+	PART_MAX,
+};
+
+/**
+ * \brief Check whether the character is sent without the encoding.
+ */
+static inline int _http_form_is_plain(uint8_t ch)
+{
+	return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9')
+		|| ch == '-' || ch == '.' || ch == '_' || ch == '*';
+}
+
+/**
+ * \brief Get the string of the part.
+ *
+ * \param[in]  form            Instance of the form.
+ * \param[in]  field           Index of the field.
+ * \param[in]  part            Part of the field. See \ref http_form_part.
+ * \param[out] encode          A flag that whether the string is percent-encoded or not.
+ *
+ * \return     String of the part.
+ */
+static const char *_http_form_part(struct http_form *const form, uint16_t field, uint8_t part, int *encode)
+{
+	*encode = 0;
+	switch (part) {
+	case PART_SEPARATOR:
+		return (field > 0) ? "&" : "";
+	case PART_NAME:
+		*encode = 1;
+		return form->fields[field].name;
+	case PART_EQUAL:
+		return "=";
+	default:
+		*encode = 1;
+		return (form->fields[field].value != NULL) ? form->fields[field].value : "";
+	}
+}
+
+int http_form_init(struct http_form *const form, const struct http_form_field *fields, uint16_t field_count)
+{
+	uint16_t i;
+
+	if (form == NULL || (fields == NULL && field_count > 0)) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < field_count; i++) {
+		if (fields[i].name == NULL) {
+			return -EINVAL;
+		}
+	}
+
+	memset(form, 0, sizeof(struct http_form));
+	form->fields = fields;
+	form->field_count = field_count;
+
+	return 0;
+}
+
+uint32_t http_form_get_length(struct http_form *const form)
+{
+	const uint8_t *ptr;
+	uint32_t length = 0;
+	uint16_t field;
+	uint8_t part;
+	int encode;
+
+	for (field = 0; field < form->field_count; field++) {
+		for (part = 0; part < PART_MAX; part++) {
+			ptr = (const uint8_t *)_http_form_part(form, field, part, &encode);
+			for (; *ptr != '\0'; ptr++) {
+				/* Space is encoded as '+'. */
+				length += (encode && *ptr != ' ' && !_http_form_is_plain(*ptr)) ? 3 : 1;
+			}
+		}
+	}
+	return length;
+}
+
+/**
+ * \brief Encode the form from the current position.
+ *
+ * \param[in]  form            Instance of the form.
+ * \param[out] buffer          Buffer which receives the encoded data.
+ * \param[in]  size            Size of the buffer.
+ *
+ * \return     Size of the encoded data. Zero if the whole form was encoded.
+ */
+static uint32_t _http_form_encode(struct http_form *const form, char *buffer, uint32_t size)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	const char *str;
+	uint32_t filled = 0;
+	uint8_t ch;
+	int encode;
+
+	while (filled < size && form->field < form->field_count) {
+		str = _http_form_part(form, form->field, form->part, &encode);
+		ch = (uint8_t)str[form->offset];
+		if (ch == '\0') {
+			/* Move to the next part. */
+			form->offset = 0;
+			if (++form->part >= PART_MAX) {
+				form->part = PART_SEPARATOR;
+				form->field++;
+			}
+			continue;
+		}
+
+		if (!encode || _http_form_is_plain(ch)) {
+			buffer[filled++] = ch;
+		} else if (ch == ' ') {
+			buffer[filled++] = '+';
+		} else {
+			/* The buffer can be ended in the middle of the escape. */
+			buffer[filled++] = (form->escape == 0) ? '%' : hex[(form->escape == 1) ? (ch >> 4) : (ch & 0xF)];
+			if (++form->escape < 3) {
+				continue;
+			}
+			form->escape = 0;
+		}
+		form->offset++;
+	}
+
+	form->position += filled;
+	return filled;
+}
+
+/**
+ * \brief Restart the encoding from the first field.
+ */
+static void _http_form_rewind(struct http_form *const form)
+{
+	form->field = 0;
+	form->part = PART_SEPARATOR;
+	form->escape = 0;
+	form->offset = 0;
+	form->position = 0;
+}
+
+int http_form_write(struct http_form *const form, char *buffer, uint32_t size)
+{
+	uint32_t length = http_form_get_length(form);
+
+	if (length >= size) {
+		return -ENOSPC;
+	}
+
+	_http_form_rewind(form);
+	_http_form_encode(form, buffer, length);
+	buffer[length] = '\0';
+	_http_form_rewind(form);
+
+	return (int)length;
+}
+
+/**
+ * \brief Get content mime type of the entity. See \ref http_entity.
+ */
+static const char *_http_form_get_contents_type(void *priv_data)
+{
+	return HTTP_FORM_CONTENT_TYPE;
+}
+
+/**
+ * \brief Get content length of the entity. See \ref http_entity.
+ */
+static int _http_form_get_contents_length(void *priv_data)
+{
+	return (int)http_form_get_length((struct http_form *)priv_data);
+}
+
+/**
+ * \brief Read the encoded form. See \ref http_entity.
+ */
+static int _http_form_read(void *priv_data, char *buffer, uint32_t size, uint32_t written)
+{
+	struct http_form *const form = (struct http_form *)priv_data;
+
+	if (written == 0 && form->position != 0) {
+		/* Request is sent again. */
+		_http_form_rewind(form);
+	}
+
+	return (int)_http_form_encode(form, buffer, size);
+}
+
+void http_form_get_entity(struct http_form *const form, struct http_entity *entity)
+{
+	memset(entity, 0, sizeof(struct http_entity));
+	entity->is_chunked = 0;
+	entity->get_contents_type = _http_form_get_contents_type;
+	entity->get_contents_length = _http_form_get_contents_length;
+	entity->read = _http_form_read;
+	entity->priv_data = form;
+
+	_http_form_rewind(form);
+}
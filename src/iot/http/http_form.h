@@ -0,0 +1,138 @@
+/**
+ * \file
+ *
+ * \brief Streaming encoder of the application/x-www-form-urlencoded entity.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_FORM_H_INCLUDED
+#define HTTP_FORM_H_INCLUDED
+
+#include "iot/http/http_client.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Content type of the encoded form. */
+#define HTTP_FORM_CONTENT_TYPE         "application/x-www-form-urlencoded"
+
+/**
+ * \brief Field of the form.
+ *
+ * The strings are not copied. They MUST be kept until the request is sent.
+ */
+struct http_form_field {
+	/** Name of the field. */
+	const char *name;
+	/** Value of the field. NULL is same as the empty string. */
+	const char *value;
+};
+
+/**
+ * \brief Instance of the application/x-www-form-urlencoded entity.
+ *
+ * The fields are percent-encoded while they are read. So the size of this instance
+ * does not depend on the number and the size of the fields.
+ */
+struct http_form {
+	/** Fields of the form. */
+	const struct http_form_field *fields;
+	/** Number of the fields. */
+	uint16_t field_count;
+	/** Field which is currently encoded. */
+	uint16_t field;
+	/** Part of the field which is currently encoded. The separator, the name, '=' or the value. */
+	uint8_t part;
+	/** Number of the bytes which were written in the current percent-encoded byte. */
+	uint8_t escape;
+	/** Offset in the current part. */
+	uint32_t offset;
+	/** Total size of the encoded data. */
+	uint32_t position;
+};
+
+/**
+ * \brief Initialize the form.
+ *
+ * \param[in]  form            Instance of the form.
+ * \param[in]  fields          Fields of the form. The array MUST be kept until the request is sent.
+ * \param[in]  field_count     Number of the fields.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_form_init(struct http_form *const form, const struct http_form_field *fields, uint16_t field_count);
+
+/**
+ * \brief Get the size of the encoded form without encoding it.
+ *
+ * \param[in]  form            Instance of the form.
+ *
+ * \return     Size of the encoded form.
+ */
+uint32_t http_form_get_length(struct http_form *const form);
+
+/**
+ * \brief Encode the whole form in the buffer. It is used to make the query string of the URL.
+ *
+ * \param[in]  form            Instance of the form.
+ * \param[out] buffer          Buffer which receives the encoded form and the null terminator.
+ * \param[in]  size            Size of the buffer.
+ *
+ * \return     Size of the encoded form if success.
+ * \return     -ENOSPC         Buffer is too small.
+ */
+int http_form_write(struct http_form *const form, char *buffer, uint32_t size);
+
+/**
+ * \brief Fill the entity interface which is passed to \ref http_client_send_request.
+ *
+ * The entity is sent with the exact Content-Length. The encoding is restarted if the entity is sent again.
+ *
+ * \param[in]  form            Instance of the form.
+ * \param[out] entity          Entity interface.
+ */
+void http_form_get_entity(struct http_form *const form, struct http_entity *entity);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_FORM_H_INCLUDED */
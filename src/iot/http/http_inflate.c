@@ -0,0 +1,667 @@
+/**
+ * \file
+ *
+ * \brief Streaming decoder of the deflate content encoding.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/http/http_inflate.h"
+#include <string.h>
+#include <errno.h>
+
+enum http_inflate_state {
+	INFLATE_ZLIB_HEADER = 0,
+	INFLATE_GZIP_HEADER,
+	INFLATE_GZIP_EXTRA_LENGTH,
+	INFLATE_GZIP_EXTRA,
+	INFLATE_GZIP_NAME,
+	INFLATE_GZIP_COMMENT,
+	INFLATE_GZIP_HCRC,
+	INFLATE_BLOCK,
+	INFLATE_STORED,
+	INFLATE_STORED_CHECK,
+	INFLATE_STORED_COPY,
+	INFLATE_TABLE,
+	INFLATE_CODE_LENGTHS,
+	INFLATE_LENGTHS,
+	INFLATE_CODES,
+	INFLATE_LENGTH_EXTRA,
+	INFLATE_DISTANCE,
+	INFLATE_DISTANCE_EXTRA,
+	INFLATE_COPY,
+	INFLATE_TRAILER,
+	INFLATE_DONE,
+};
+
+/** Flags of the gzip header. */
+#define GZIP_FLAG_HCRC     0x02
+#define GZIP_FLAG_EXTRA    0x04
+#define GZIP_FLAG_NAME     0x08
+#define GZIP_FLAG_COMMENT  0x10
+
+/** Base length and extra bits of the length symbols 257..285. */
+static const uint16_t length_base[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+/** Base distance and extra bits of the distance symbols 0..29. */
+static const uint16_t distance_base[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t distance_extra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+/** Order of the code length code lengths. */
+static const uint8_t code_length_order[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+/** CRC-32 table for the 4bit at a time. It is small enough for the flash. */
+static const uint32_t crc_table[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+/** Get the low n bits from the bit buffer. */
+#define BITS(n)       (inflate->bit_buffer & ((1UL << (n)) - 1))
+/** Remove the low n bits from the bit buffer. */
+#define DROP_BITS(n)  do { inflate->bit_buffer >>= (n); inflate->bit_count -= (n); } while (0)
+/** Pull one byte from the input to the bit buffer. */
+#define PULL_BYTE()   do { inflate->bit_buffer |= (uint32_t)*in++ << inflate->bit_count; inflate->bit_count += 8; } while (0)
+/** Ensure the bit buffer has at least n bits. If the input is empty, Stop here and continue at the next feed. */
+#define NEED_BITS(n)  do { while (inflate->bit_count < (n)) { if (in == end) goto suspend; PULL_BYTE(); } } while (0)
+/** Decode a symbol. If the input is empty, Stop here and continue at the next feed. */
+#define DECODE(code)  do { while ((symbol = _http_inflate_decode(inflate, (code))) == -EAGAIN) { if (in == end) goto suspend; PULL_BYTE(); } } while (0)
+
+/**
+ * \brief Build the canonical huffman code from the code lengths.
+ *
+ * \param[out] code            Huffman code.
+ * \param[in]  lengths         Code length of each symbols.
+ * \param[in]  count           Number of the symbols.
+ *
+ * \return     0 if success, -EBADMSG if the code lengths are over-subscribed.
+ */
+static int _http_inflate_build(struct http_inflate_huffman *code, const uint8_t *lengths, int count)
+{
+	uint16_t offset[16];
+	int left, len, symbol;
+
+	memset(code->count, 0, sizeof(code->count));
+	for (symbol = 0; symbol < count; symbol++) {
+		code->count[lengths[symbol]]++;
+	}
+	if (code->count[0] == count) {
+		/* Has not any code. Decoding with this code is failed. */
+		return 0;
+	}
+
+	left = 1;
+	for (len = 1; len < 16; len++) {
+		left <<= 1;
+		left -= code->count[len];
+		if (left < 0) {
+			return -EBADMSG;
+		}
+	}
+
+	offset[1] = 0;
+	for (len = 1; len < 15; len++) {
+		offset[len + 1] = offset[len] + code->count[len];
+	}
+	for (symbol = 0; symbol < count; symbol++) {
+		if (lengths[symbol] != 0) {
+			code->symbol[offset[lengths[symbol]]++] = symbol;
+		}
+	}
+
+	/* Incomplete code is allowed. The unused codes are detected in the decoding. */
+	return 0;
+}
+
+/**
+ * \brief Decode a symbol from the bit buffer.
+ *
+ * \param[in]  inflate         Instance of the decoder.
+ * \param[in]  code            Huffman code.
+ *
+ * \return     Decoded symbol, -EAGAIN if more bits are needed, -EBADMSG if the code is invalid.
+ */
+static int _http_inflate_decode(struct http_inflate *const inflate, const struct http_inflate_huffman *code)
+{
+	uint32_t bits = inflate->bit_buffer;
+	int value = 0, first = 0, index = 0, count, len;
+
+	for (len = 1; len < 16; len++) {
+		if (len > inflate->bit_count) {
+			return -EAGAIN;
+		}
+		/* Huffman codes are packed from the most significant bit. */
+		value |= bits & 1;
+		bits >>= 1;
+		count = code->count[len];
+		if (value - count < first) {
+			DROP_BITS(len);
+			return code->symbol[index + (value - first)];
+		}
+		index += count;
+		first += count;
+		first <<= 1;
+		value <<= 1;
+	}
+
+	return -EBADMSG;
+}
+
+/**
+ * \brief Update the check value and pass the decompressed data to the application.
+ *
+ * \param[in]  inflate         Instance of the decoder.
+ */
+static void _http_inflate_flush(struct http_inflate *const inflate)
+{
+	const uint8_t *data = inflate->window + inflate->output_pos, *ptr;
+	uint32_t length = inflate->window_pos - inflate->output_pos;
+	uint32_t crc, a, b, i, n;
+
+	if (length == 0) {
+		return;
+	}
+
+	if (inflate->format == HTTP_INFLATE_GZIP) {
+		crc = ~inflate->check;
+		for (i = 0; i < length; i++) {
+			crc ^= data[i];
+			crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+			crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+		}
+		inflate->check = ~crc;
+	} else if (inflate->format == HTTP_INFLATE_ZLIB) {
+		a = inflate->check & 0xFFFF;
+		b = inflate->check >> 16;
+		ptr = data;
+		for (i = length; i > 0; i -= n) {
+			/* 5552 is the largest n that b cannot overflow before the modulo. */
+			n = (i > 5552) ? 5552 : i;
+			while (ptr < data + length - i + n) {
+				a += *ptr++;
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+		inflate->check = (b << 16) | a;
+	}
+
+	inflate->total += length;
+	inflate->output_pos = inflate->window_pos;
+	if (inflate->output) {
+		inflate->output(inflate->priv_data, (const char *)data, length);
+	}
+}
+
+/**
+ * \brief Put a decompressed byte to the window.
+ *
+ * \param[in]  inflate         Instance of the decoder.
+ * \param[in]  value           Decompressed byte.
+ */
+static inline void _http_inflate_put(struct http_inflate *const inflate, uint8_t value)
+{
+	inflate->window[inflate->window_pos++] = value;
+	if (inflate->window_fill < inflate->window_size) {
+		inflate->window_fill++;
+	}
+	if (inflate->window_pos == inflate->window_size) {
+		/* Window is full. Pass it to the application and reuse it as a circular buffer. */
+		_http_inflate_flush(inflate);
+		inflate->window_pos = 0;
+		inflate->output_pos = 0;
+	}
+}
+
+int http_inflate_init(struct http_inflate *const inflate, enum http_inflate_format format,
+	uint8_t *window, uint32_t window_size, http_inflate_output_t output, void *priv_data)
+{
+	if (inflate == NULL || window == NULL) {
+		return -EINVAL;
+	}
+
+	if (window_size < HTTP_INFLATE_MIN_WINDOW_SIZE || window_size > HTTP_INFLATE_MAX_WINDOW_SIZE) {
+		return -EINVAL;
+	}
+
+	memset(inflate, 0, sizeof(struct http_inflate));
+	inflate->format = format;
+	inflate->window = window;
+	inflate->window_size = window_size;
+	inflate->output = output;
+	inflate->priv_data = priv_data;
+
+	switch (format) {
+	case HTTP_INFLATE_ZLIB:
+		inflate->state = INFLATE_ZLIB_HEADER;
+		inflate->check = 1;
+		break;
+	case HTTP_INFLATE_GZIP:
+		inflate->state = INFLATE_GZIP_HEADER;
+		break;
+	default:
+		inflate->state = INFLATE_BLOCK;
+		break;
+	}
+
+	return 0;
+}
+
+int http_inflate_feed(struct http_inflate *const inflate, const char *data, size_t length)
+{
+	const uint8_t *in = (const uint8_t *)data, *end = in + length;
+	uint32_t size, index;
+	int symbol, result = 0;
+
+	for (;;) {
+		switch (inflate->state) {
+		case INFLATE_ZLIB_HEADER:
+			NEED_BITS(16);
+			/* CMF and FLG are stored in the big endian. */
+			index = (BITS(8) << 8) | ((inflate->bit_buffer >> 8) & 0xFF);
+			if ((index & 0x0F00) != 0x0800 || index % 31 != 0) {
+				/* Not a zlib header. Decode it as the raw deflate stream. */
+				inflate->format = HTTP_INFLATE_RAW;
+				inflate->state = INFLATE_BLOCK;
+				break;
+			}
+			if (index & 0x20) {
+				/* Preset dictionary is not used in the HTTP. */
+				result = -ENOTSUP;
+				goto suspend;
+			}
+			DROP_BITS(16);
+			inflate->state = INFLATE_BLOCK;
+			break;
+
+		case INFLATE_GZIP_HEADER:
+			/* ID1 ID2 CM FLG MTIME(4) XFL OS */
+			NEED_BITS(8);
+			if ((inflate->index == 0 && BITS(8) != 0x1F) || (inflate->index == 1 && BITS(8) != 0x8B)
+				|| (inflate->index == 2 && BITS(8) != 8)) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			if (inflate->index == 3) {
+				inflate->flags = BITS(8);
+			}
+			DROP_BITS(8);
+			if (++inflate->index < 10) {
+				break;
+			}
+			inflate->index = 0;
+			inflate->state = INFLATE_GZIP_EXTRA_LENGTH;
+			/* No break. */
+		case INFLATE_GZIP_EXTRA_LENGTH:
+			if (inflate->flags & GZIP_FLAG_EXTRA) {
+				NEED_BITS(16);
+				inflate->length = BITS(16);
+				DROP_BITS(16);
+			}
+			inflate->state = INFLATE_GZIP_EXTRA;
+			/* No break. */
+		case INFLATE_GZIP_EXTRA:
+			if (inflate->flags & GZIP_FLAG_EXTRA) {
+				while (inflate->length > 0) {
+					NEED_BITS(8);
+					DROP_BITS(8);
+					inflate->length--;
+				}
+			}
+			inflate->state = INFLATE_GZIP_NAME;
+			/* No break. */
+		case INFLATE_GZIP_NAME:
+			if (inflate->flags & GZIP_FLAG_NAME) {
+				do {
+					NEED_BITS(8);
+					index = BITS(8);
+					DROP_BITS(8);
+				} while (index != 0);
+			}
+			inflate->state = INFLATE_GZIP_COMMENT;
+			/* No break. */
+		case INFLATE_GZIP_COMMENT:
+			if (inflate->flags & GZIP_FLAG_COMMENT) {
+				do {
+					NEED_BITS(8);
+					index = BITS(8);
+					DROP_BITS(8);
+				} while (index != 0);
+			}
+			inflate->state = INFLATE_GZIP_HCRC;
+			/* No break. */
+		case INFLATE_GZIP_HCRC:
+			if (inflate->flags & GZIP_FLAG_HCRC) {
+				NEED_BITS(16);
+				DROP_BITS(16);
+			}
+			inflate->state = INFLATE_BLOCK;
+			/* No break. */
+		case INFLATE_BLOCK:
+			if (inflate->last) {
+				inflate->index = 0;
+				inflate->trailer = 0;
+				inflate->state = INFLATE_TRAILER;
+				break;
+			}
+			NEED_BITS(3);
+			inflate->last = BITS(1);
+			DROP_BITS(1);
+			switch (BITS(2)) {
+			case 0:
+				inflate->state = INFLATE_STORED;
+				break;
+			case 1:
+				/* Fixed huffman codes. */
+				memset(inflate->lengths, 8, 144);
+				memset(inflate->lengths + 144, 9, 112);
+				memset(inflate->lengths + 256, 7, 24);
+				memset(inflate->lengths + 280, 8, 8);
+				_http_inflate_build(&inflate->lencode, inflate->lengths, 288);
+				memset(inflate->lengths, 5, 30);
+				_http_inflate_build(&inflate->distcode, inflate->lengths, 30);
+				inflate->state = INFLATE_CODES;
+				break;
+			case 2:
+				inflate->state = INFLATE_TABLE;
+				break;
+			default:
+				result = -EBADMSG;
+				goto suspend;
+			}
+			DROP_BITS(2);
+			break;
+
+		case INFLATE_STORED:
+			/* Go to the byte boundary. */
+			DROP_BITS(inflate->bit_count & 7);
+			NEED_BITS(16);
+			inflate->length = BITS(16);
+			DROP_BITS(16);
+			inflate->state = INFLATE_STORED_CHECK;
+			/* No break. */
+		case INFLATE_STORED_CHECK:
+			/* Ones complement of the length. */
+			NEED_BITS(16);
+			if (BITS(16) != (uint16_t)~inflate->length) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			DROP_BITS(16);
+			inflate->state = INFLATE_STORED_COPY;
+			/* No break. */
+		case INFLATE_STORED_COPY:
+			/* Bytes in the bit buffer are used first. */
+			while (inflate->length > 0 && inflate->bit_count >= 8) {
+				_http_inflate_put(inflate, BITS(8));
+				DROP_BITS(8);
+				inflate->length--;
+			}
+			while (inflate->length > 0) {
+				if (in == end) {
+					goto suspend;
+				}
+				size = end - in;
+				if (size > inflate->length) {
+					size = inflate->length;
+				}
+				if (size > inflate->window_size - inflate->window_pos) {
+					size = inflate->window_size - inflate->window_pos;
+				}
+				memcpy(inflate->window + inflate->window_pos, in, size);
+				in += size;
+				inflate->length -= size;
+				inflate->window_pos += size;
+				inflate->window_fill += size;
+				if (inflate->window_fill > inflate->window_size) {
+					inflate->window_fill = inflate->window_size;
+				}
+				if (inflate->window_pos == inflate->window_size) {
+					_http_inflate_flush(inflate);
+					inflate->window_pos = 0;
+					inflate->output_pos = 0;
+				}
+			}
+			inflate->state = INFLATE_BLOCK;
+			break;
+
+		case INFLATE_TABLE:
+			NEED_BITS(14);
+			inflate->nlen = BITS(5) + 257;
+			DROP_BITS(5);
+			inflate->ndist = BITS(5) + 1;
+			DROP_BITS(5);
+			inflate->ncode = BITS(4) + 4;
+			DROP_BITS(4);
+			if (inflate->nlen > 286 || inflate->ndist > 30) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			inflate->index = 0;
+			inflate->state = INFLATE_CODE_LENGTHS;
+			/* No break. */
+		case INFLATE_CODE_LENGTHS:
+			while (inflate->index < inflate->ncode) {
+				NEED_BITS(3);
+				inflate->lengths[code_length_order[inflate->index++]] = BITS(3);
+				DROP_BITS(3);
+			}
+			while (inflate->index < 19) {
+				inflate->lengths[code_length_order[inflate->index++]] = 0;
+			}
+			if (_http_inflate_build(&inflate->lencode, inflate->lengths, 19) < 0) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			inflate->index = 0;
+			inflate->symbol = 0;
+			inflate->state = INFLATE_LENGTHS;
+			/* No break. */
+		case INFLATE_LENGTHS:
+			while (inflate->index < inflate->nlen + inflate->ndist) {
+				if (inflate->symbol == 0) {
+					DECODE(&inflate->lencode);
+					if (symbol < 0) {
+						result = -EBADMSG;
+						goto suspend;
+					}
+					if (symbol < 16) {
+						inflate->lengths[inflate->index++] = symbol;
+						continue;
+					}
+					if (symbol == 16 && inflate->index == 0) {
+						/* No previous length to repeat. */
+						result = -EBADMSG;
+						goto suspend;
+					}
+					/* Keep the repeat symbol until its extra bits are received. */
+					inflate->symbol = symbol;
+				}
+				/* 16: Copy the previous length 3-6 times, 17: 3-10 zeros, 18: 11-138 zeros. */
+				if (inflate->symbol == 16) {
+					NEED_BITS(2);
+					symbol = inflate->lengths[inflate->index - 1];
+					size = 3 + BITS(2);
+					DROP_BITS(2);
+				} else if (inflate->symbol == 17) {
+					NEED_BITS(3);
+					symbol = 0;
+					size = 3 + BITS(3);
+					DROP_BITS(3);
+				} else {
+					NEED_BITS(7);
+					symbol = 0;
+					size = 11 + BITS(7);
+					DROP_BITS(7);
+				}
+				if (inflate->index + size > (uint32_t)(inflate->nlen + inflate->ndist)) {
+					result = -EBADMSG;
+					goto suspend;
+				}
+				while (size--) {
+					inflate->lengths[inflate->index++] = symbol;
+				}
+				inflate->symbol = 0;
+			}
+			if (inflate->lengths[256] == 0) {
+				/* End of block code is missing. */
+				result = -EBADMSG;
+				goto suspend;
+			}
+			if (_http_inflate_build(&inflate->lencode, inflate->lengths, inflate->nlen) < 0
+				|| _http_inflate_build(&inflate->distcode, inflate->lengths + inflate->nlen, inflate->ndist) < 0) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			inflate->state = INFLATE_CODES;
+			/* No break. */
+		case INFLATE_CODES:
+			for (;;) {
+				DECODE(&inflate->lencode);
+				if (symbol < 256) {
+					if (symbol < 0) {
+						result = -EBADMSG;
+						goto suspend;
+					}
+					_http_inflate_put(inflate, symbol);
+					continue;
+				}
+				break;
+			}
+			if (symbol == 256) {
+				/* End of block. */
+				inflate->state = INFLATE_BLOCK;
+				break;
+			}
+			symbol -= 257;
+			if (symbol >= 29) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			inflate->symbol = symbol;
+			inflate->state = INFLATE_LENGTH_EXTRA;
+			/* No break. */
+		case INFLATE_LENGTH_EXTRA:
+			NEED_BITS(length_extra[inflate->symbol]);
+			inflate->length = length_base[inflate->symbol] + BITS(length_extra[inflate->symbol]);
+			DROP_BITS(length_extra[inflate->symbol]);
+			inflate->state = INFLATE_DISTANCE;
+			/* No break. */
+		case INFLATE_DISTANCE:
+			DECODE(&inflate->distcode);
+			if (symbol < 0 || symbol >= 30) {
+				result = -EBADMSG;
+				goto suspend;
+			}
+			inflate->symbol = symbol;
+			inflate->state = INFLATE_DISTANCE_EXTRA;
+			/* No break. */
+		case INFLATE_DISTANCE_EXTRA:
+			NEED_BITS(distance_extra[inflate->symbol]);
+			inflate->distance = distance_base[inflate->symbol] + BITS(distance_extra[inflate->symbol]);
+			DROP_BITS(distance_extra[inflate->symbol]);
+			if (inflate->distance > inflate->window_fill) {
+				/* Refers the data before the start of the stream or out of the window. */
+				result = (inflate->window_fill == inflate->window_size) ? -EOVERFLOW : -EBADMSG;
+				goto suspend;
+			}
+			inflate->state = INFLATE_COPY;
+			/* No break. */
+		case INFLATE_COPY:
+			while (inflate->length > 0) {
+				index = (inflate->window_pos >= inflate->distance) ? inflate->window_pos - inflate->distance
+					: inflate->window_pos + inflate->window_size - inflate->distance;
+				_http_inflate_put(inflate, inflate->window[index]);
+				inflate->length--;
+			}
+			inflate->state = INFLATE_CODES;
+			break;
+
+		case INFLATE_TRAILER:
+			if (inflate->format == HTTP_INFLATE_RAW) {
+				inflate->state = INFLATE_DONE;
+				break;
+			}
+			/* Trailer is started at the byte boundary. */
+			DROP_BITS(inflate->bit_count & 7);
+			_http_inflate_flush(inflate);
+			/* gzip: CRC32 ISIZE in the little endian, zlib: ADLER32 in the big endian. */
+			while (inflate->index < ((inflate->format == HTTP_INFLATE_GZIP) ? 8 : 4)) {
+				NEED_BITS(8);
+				if (inflate->format == HTTP_INFLATE_GZIP) {
+					inflate->trailer |= BITS(8) << ((inflate->index & 3) * 8);
+				} else {
+					inflate->trailer = (inflate->trailer << 8) | BITS(8);
+				}
+				DROP_BITS(8);
+				inflate->index++;
+				if (inflate->index == 4) {
+					if (inflate->trailer != inflate->check) {
+						result = -EBADMSG;
+						goto suspend;
+					}
+					inflate->trailer = 0;
+				}
+			}
+			if (inflate->format == HTTP_INFLATE_GZIP && inflate->trailer != inflate->total) {
+				/* Size is mismatched. */
+				result = -EBADMSG;
+				goto suspend;
+			}
+			inflate->state = INFLATE_DONE;
+			/* No break. */
+		case INFLATE_DONE:
+			result = 1;
+			goto suspend;
+		}
+	}
+
+suspend:
+	if (result >= 0) {
+		_http_inflate_flush(inflate);
+	}
+	return result;
+}
+
+int http_inflate_is_done(struct http_inflate *const inflate)
+{
+	return inflate->state == INFLATE_DONE;
+}
@@ -0,0 +1,201 @@
+/**
+ * \file
+ *
+ * \brief Streaming decoder of the deflate content encoding.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_INFLATE_H_INCLUDED
+#define HTTP_INFLATE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Minimum size of the history window. */
+#define HTTP_INFLATE_MIN_WINDOW_SIZE   1024
+/** Maximum size of the history window. It is the biggest distance that deflate can refer. */
+#define HTTP_INFLATE_MAX_WINDOW_SIZE   32768
+
+/**
+ * \brief Container format of the compressed stream.
+ */
+enum http_inflate_format {
+	/** Raw deflate stream without any container. (RFC 1951) */
+	HTTP_INFLATE_RAW = 0,
+	/**
+	 * zlib stream. (RFC 1950)
+	 * Some servers send the raw deflate stream for the deflate encoding.
+	 * So, If the stream does not start with the zlib header, It is decoded as the raw stream.
+	 */
+	HTTP_INFLATE_ZLIB,
+	/** gzip stream. (RFC 1952) */
+	HTTP_INFLATE_GZIP,
+};
+
+/**
+ * \brief Callback type of the decompressed data.
+ *
+ * \param[in]  priv_data       Private data which was registered in the \ref http_inflate_init.
+ * \param[in]  data            Decompressed data. It is valid only in the callback.
+ * \param[in]  length          Size of the data.
+ */
+typedef void (*http_inflate_output_t)(void *priv_data, const char *data, size_t length);
+
+/**
+ * \brief Canonical huffman code.
+ */
+struct http_inflate_huffman {
+	/** Number of the codes for each length. */
+	uint16_t count[16];
+	/** Symbols ordered by the code. */
+	uint16_t symbol[288];
+};
+
+/**
+ * \brief Instance of the decoder.
+ *
+ * All of the members are internal. The decoder keeps its position in here,
+ * so the compressed stream can be divided at any byte.
+ */
+struct http_inflate {
+	/** Format of the stream. */
+	uint8_t format;
+	/** Current state of the decoder. */
+	uint8_t state;
+	/** A flag for the last block. */
+	uint8_t last;
+	/** Flags in the gzip header. */
+	uint8_t flags;
+	/** Bits which were read from the input but not consumed yet. */
+	uint32_t bit_buffer;
+	/** Number of the bits in the bit_buffer. */
+	uint8_t bit_count;
+	/** Symbol which was decoded before reading its extra bits. */
+	uint16_t symbol;
+	/** Remain length of the current copy or the stored block. */
+	uint16_t length;
+	/** Distance of the current copy. */
+	uint16_t distance;
+	/** Generic counter which is used in the header and the code length tables. */
+	uint16_t index;
+	/** Number of the literal/length codes. */
+	uint16_t nlen;
+	/** Number of the distance codes. */
+	uint16_t ndist;
+	/** Number of the code length codes. */
+	uint16_t ncode;
+	/** CRC-32 or Adler-32 of the decompressed data. */
+	uint32_t check;
+	/** Value which is read from the trailer. */
+	uint32_t trailer;
+	/** Total size of the decompressed data. */
+	uint32_t total;
+	/** Literal/length code. It is also used for the code length code. */
+	struct http_inflate_huffman lencode;
+	/** Distance code. */
+	struct http_inflate_huffman distcode;
+	/** Code lengths of the dynamic block. */
+	uint8_t lengths[288 + 32];
+	/** History window. */
+	uint8_t *window;
+	/** Size of the history window. */
+	uint32_t window_size;
+	/** Write position in the window. */
+	uint32_t window_pos;
+	/** Size of the valid history. */
+	uint32_t window_fill;
+	/** Start of the data which was not passed to the output callback yet. */
+	uint32_t output_pos;
+	/** Output callback. */
+	http_inflate_output_t output;
+	/** Private data of the output callback. */
+	void *priv_data;
+};
+
+/**
+ * \brief Initialize the decoder for a new stream.
+ *
+ * \param[in]  inflate         Instance of the decoder.
+ * \param[in]  format          Format of the stream.
+ * \param[in]  window          History window. The memory is used until the stream is finished.
+ * \param[in]  window_size     Size of the window. Stream which refers the farther data than this value is rejected.
+ * \param[in]  output          Callback which receives the decompressed data.
+ * \param[in]  priv_data       Private data which is passed to the callback.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_inflate_init(struct http_inflate *const inflate, enum http_inflate_format format,
+	uint8_t *window, uint32_t window_size, http_inflate_output_t output, void *priv_data);
+
+/**
+ * \brief Decompress the part of the stream.
+ *
+ * The input can be divided at any position.
+ * The decompressed data is passed to the output callback whenever the window is full and before this function returns.
+ *
+ * \param[in]  inflate         Instance of the decoder.
+ * \param[in]  data            Compressed data.
+ * \param[in]  length          Size of the data.
+ *
+ * \return     1               End of the stream was reached. Remain input is ignored.
+ * \return     0               More input is needed.
+ * \return     -EBADMSG        Stream is corrupted or the check value is mismatched.
+ * \return     -ENOTSUP        Stream uses the unsupported feature.
+ * \return     -EOVERFLOW      Stream refers the data which is farther than the window size.
+ */
+int http_inflate_feed(struct http_inflate *const inflate, const char *data, size_t length);
+
+/**
+ * \brief Check whether the end of the stream was reached.
+ *
+ * \param[in]  inflate         Instance of the decoder.
+ *
+ * \return     1 if the stream was finished and verified, 0 otherwise.
+ */
+int http_inflate_is_done(struct http_inflate *const inflate);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_INFLATE_H_INCLUDED */
@@ -0,0 +1,402 @@
+/**
+ * \file
+ *
+ * \brief Streaming encoder of the multipart/form-data entity.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/http/http_multipart.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+/** Prefix of the boundary. */
+#define HTTP_MULTIPART_BOUNDARY_PREFIX "----WINC1500"
+
+/**
+ * \brief Pieces of the encoded part.
+ *
+ * --{boundary}\r\n
+ * Content-Disposition: form-data; name="{name}"; filename="{filename}"\r\n
+ * Content-Type: {content_type}\r\n
+ * \r\n
+ * {value or file}\r\n
+ *
+ * The closing boundary is encoded as the part after the last one.
+ */
+enum http_multipart_piece {
+	PIECE_DASH = 0,
+	PIECE_BOUNDARY,
+	PIECE_DISPOSITION,
+	PIECE_NAME,
+	PIECE_FILENAME_START,
+	PIECE_FILENAME,
+	PIECE_TYPE_START,
+	PIECE_TYPE,
+	PIECE_HEADER_END,
+	PIECE_BODY,
+	PIECE_BODY_END,
+	PIECE_MAX,
+};
+
+/**
+ * \brief Get the piece of the encoded part.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ * \param[in]  index           Index of the part. part_count means the closing boundary.
+ * \param[in]  piece           Piece of the part. See \ref http_multipart_piece.
+ * \param[out] data            Data of the piece. NULL if it is the data of the file.
+ *
+ * \return     Length of the piece. Zero if the part does not have the piece.
+ */
+static uint32_t _http_multipart_piece(struct http_multipart *const multipart, uint8_t index, uint8_t piece,
+	const char **data)
+{
+	struct http_multipart_part *part = &multipart->parts[index];
+	int is_file = (index < multipart->part_count && part->path != NULL);
+
+	*data = "";
+	switch (piece) {
+	case PIECE_DASH:
+		*data = "--";
+		break;
+	case PIECE_BOUNDARY:
+		*data = multipart->boundary;
+		break;
+	case PIECE_DISPOSITION:
+		*data = (index < multipart->part_count) ? "\r\nContent-Disposition: form-data; name=\"" : "--\r\n";
+		break;
+	}
+
+	if (index < multipart->part_count) {
+		switch (piece) {
+		case PIECE_NAME:
+			*data = part->name;
+			break;
+		case PIECE_FILENAME_START:
+			*data = is_file ? "\"; filename=\"" : "";
+			break;
+		case PIECE_FILENAME:
+			*data = is_file ? part->filename : "";
+			break;
+		case PIECE_TYPE_START:
+			*data = is_file ? "\"\r\nContent-Type: " : "\"";
+			break;
+		case PIECE_TYPE:
+			*data = is_file ? part->content_type : "";
+			break;
+		case PIECE_HEADER_END:
+			*data = "\r\n\r\n";
+			break;
+		case PIECE_BODY:
+			*data = is_file ? NULL : part->value;
+			return part->length;
+		case PIECE_BODY_END:
+			*data = "\r\n";
+			break;
+		}
+	}
+	return strlen(*data);
+}
+
+/**
+ * \brief Add the part after checking the space.
+ *
+ * \return     Added part. NULL if the entity is full.
+ */
+static struct http_multipart_part *_http_multipart_add_part(struct http_multipart *const multipart)
+{
+	struct http_multipart_part *part;
+
+	if (multipart->part_count >= HTTP_MULTIPART_MAX_PARTS) {
+		return NULL;
+	}
+	part = &multipart->parts[multipart->part_count++];
+	memset(part, 0, sizeof(struct http_multipart_part));
+	return part;
+}
+
+/**
+ * \brief Restart the encoding from the first part.
+ */
+static void _http_multipart_rewind(struct http_multipart *const multipart)
+{
+	if (multipart->file_opened) {
+		f_close(&multipart->file);
+		multipart->file_opened = 0;
+	}
+	multipart->part = 0;
+	multipart->piece = PIECE_DASH;
+	multipart->offset = 0;
+	multipart->position = 0;
+}
+
+int http_multipart_init(struct http_multipart *const multipart)
+{
+	static const char hex[] = "0123456789abcdef";
+	int i;
+
+	if (multipart == NULL) {
+		return -EINVAL;
+	}
+
+	memset(multipart, 0, sizeof(struct http_multipart));
+
+	strcpy(multipart->boundary, HTTP_MULTIPART_BOUNDARY_PREFIX);
+	for (i = sizeof(HTTP_MULTIPART_BOUNDARY_PREFIX) - 1; i < HTTP_MULTIPART_BOUNDARY_LENGTH; i++) {
+		/* Lower bits of some rand() implementations are not random. */
+		multipart->boundary[i] = hex[(rand() >> 4) & 0xF];
+	}
+	multipart->boundary[HTTP_MULTIPART_BOUNDARY_LENGTH] = '\0';
+
+	strcpy(multipart->content_type, "multipart/form-data; boundary=");
+	strcat(multipart->content_type, multipart->boundary);
+
+	return 0;
+}
+
+int http_multipart_add_field(struct http_multipart *const multipart, const char *name, const char *value)
+{
+	struct http_multipart_part *part;
+
+	if (multipart == NULL || name == NULL || value == NULL) {
+		return -EINVAL;
+	}
+
+	part = _http_multipart_add_part(multipart);
+	if (part == NULL) {
+		return -ENOSPC;
+	}
+	part->name = name;
+	part->value = value;
+	part->length = strlen(value);
+	return 0;
+}
+
+int http_multipart_add_file(struct http_multipart *const multipart, const char *name, const char *path,
+	const char *filename, const char *content_type)
+{
+	struct http_multipart_part *part;
+	FILINFO info;
+	const char *ptr;
+
+	if (multipart == NULL || name == NULL || path == NULL) {
+		return -EINVAL;
+	}
+
+	if (multipart->part_count >= HTTP_MULTIPART_MAX_PARTS) {
+		return -ENOSPC;
+	}
+
+	/* Long file name is not needed. */
+	memset(&info, 0, sizeof(FILINFO));
+	if (f_stat(path, &info) != FR_OK) {
+		return -ENOENT;
+	}
+
+	if (filename == NULL) {
+		/* Drive number and directories are not sent. */
+		filename = path;
+		for (ptr = path; *ptr != '\0'; ptr++) {
+			if (*ptr == '/' || *ptr == '\\' || *ptr == ':') {
+				filename = ptr + 1;
+			}
+		}
+	}
+
+	part = _http_multipart_add_part(multipart);
+	part->name = name;
+	part->path = path;
+	part->filename = filename;
+	part->content_type = (content_type != NULL) ? content_type : "application/octet-stream";
+	part->length = info.fsize;
+	return 0;
+}
+
+uint32_t http_multipart_get_length(struct http_multipart *const multipart)
+{
+	const char *data;
+	uint32_t length = 0;
+	uint8_t index, piece;
+
+	for (index = 0; index <= multipart->part_count; index++) {
+		for (piece = 0; piece < PIECE_MAX; piece++) {
+			length += _http_multipart_piece(multipart, index, piece, &data);
+		}
+	}
+	return length;
+}
+
+/**
+ * \brief Get content mime type of the entity. See \ref http_entity.
+ */
+static const char *_http_multipart_get_contents_type(void *priv_data)
+{
+	struct http_multipart *const multipart = (struct http_multipart *)priv_data;
+
+	return multipart->content_type;
+}
+
+/**
+ * \brief Get content length of the entity. See \ref http_entity.
+ */
+static int _http_multipart_get_contents_length(void *priv_data)
+{
+	return (int)http_multipart_get_length((struct http_multipart *)priv_data);
+}
+
+/**
+ * \brief Read the file data of the current part.
+ *
+ * The read is ended at the sector boundary unless it reaches the end of the file.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ * \param[in]  buffer          Buffer to store the data.
+ * \param[in]  size            Size of the buffer.
+ * \param[in]  filled          Size of the data which was stored in the buffer already.
+ *
+ * \return     Size of the read data. Zero if the buffer should be sent first, Negative value if the file can not be read.
+ */
+static int _http_multipart_read_file(struct http_multipart *const multipart, char *buffer, uint32_t size, uint32_t filled)
+{
+	struct http_multipart_part *part = &multipart->parts[multipart->part];
+	uint32_t length = part->length - multipart->offset;
+	uint32_t end;
+	UINT read_size;
+
+	if (length > size) {
+		length = size;
+		end = multipart->offset + length;
+		if (end % HTTP_MULTIPART_SECTOR_SIZE < length) {
+			length -= end % HTTP_MULTIPART_SECTOR_SIZE;
+		} else if (filled > 0) {
+			/* Sector does not fit in the rest of the buffer. */
+			return 0;
+		}
+	}
+
+	if (!multipart->file_opened) {
+		if (f_open(&multipart->file, part->path, FA_OPEN_EXISTING | FA_READ) != FR_OK) {
+			return -1;
+		}
+		multipart->file_opened = 1;
+		if (multipart->offset > 0 && f_lseek(&multipart->file, multipart->offset) != FR_OK) {
+			return -1;
+		}
+	}
+
+	if (f_read(&multipart->file, buffer, length, &read_size) != FR_OK || read_size != length) {
+		/* File was changed after it was added. */
+		return -1;
+	}
+
+	if (multipart->offset + length >= part->length) {
+		f_close(&multipart->file);
+		multipart->file_opened = 0;
+	}
+	return (int)length;
+}
+
+/**
+ * \brief Read the encoded entity. See \ref http_entity.
+ */
+static int _http_multipart_read(void *priv_data, char *buffer, uint32_t size, uint32_t written)
+{
+	struct http_multipart *const multipart = (struct http_multipart *)priv_data;
+	const char *data;
+	uint32_t filled = 0, length;
+	int result;
+
+	if (written == 0 && multipart->position != 0) {
+		/* Request is sent again. */
+		_http_multipart_rewind(multipart);
+	}
+
+	while (filled < size && multipart->part <= multipart->part_count) {
+		length = _http_multipart_piece(multipart, multipart->part, multipart->piece, &data);
+		if (multipart->offset >= length) {
+			/* Move to the next piece. */
+			multipart->offset = 0;
+			if (++multipart->piece >= PIECE_MAX) {
+				multipart->piece = PIECE_DASH;
+				multipart->part++;
+			}
+			continue;
+		}
+
+		if (data == NULL) {
+			result = _http_multipart_read_file(multipart, buffer + filled, size - filled, filled);
+			if (result < 0) {
+				_http_multipart_rewind(multipart);
+				return -1;
+			}
+			if (result == 0) {
+				break;
+			}
+			length = result;
+		} else {
+			length -= multipart->offset;
+			if (length > size - filled) {
+				length = size - filled;
+			}
+			memcpy(buffer + filled, data + multipart->offset, length);
+		}
+		filled += length;
+		multipart->offset += length;
+		multipart->position += length;
+	}
+
+	return (int)filled;
+}
+
+/**
+ * \brief Close the file which is being sent. See \ref http_entity.
+ */
+static void _http_multipart_close(void *priv_data)
+{
+	struct http_multipart *const multipart = (struct http_multipart *)priv_data;
+
+	if (multipart->file_opened) {
+		f_close(&multipart->file);
+		multipart->file_opened = 0;
+	}
+}
+
+void http_multipart_get_entity(struct http_multipart *const multipart, struct http_entity *entity)
+{
+	memset(entity, 0, sizeof(struct http_entity));
+	entity->is_chunked = 0;
+	entity->get_contents_type = _http_multipart_get_contents_type;
+	entity->get_contents_length = _http_multipart_get_contents_length;
+	entity->read = _http_multipart_read;
+	entity->close = _http_multipart_close;
+	entity->priv_data = multipart;
+
+	_http_multipart_rewind(multipart);
+}
@@ -0,0 +1,181 @@
+/**
+ * \file
+ *
+ * \brief Streaming encoder of the multipart/form-data entity.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_MULTIPART_H_INCLUDED
+#define HTTP_MULTIPART_H_INCLUDED
+
+#include "iot/http/http_client.h"
+#include "ff.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of the parts in an entity. */
+#define HTTP_MULTIPART_MAX_PARTS       8
+/** Length of the boundary. It is a fixed prefix followed by the random hexadecimal digits. */
+#define HTTP_MULTIPART_BOUNDARY_LENGTH 32
+/**
+ * Unit of the file reads. The file data is read up to the sector boundary,
+ * so FatFs transfers the whole sectors into the send buffer directly.
+ */
+#define HTTP_MULTIPART_SECTOR_SIZE     _MAX_SS
+
+/**
+ * \brief Part of the multipart/form-data entity.
+ *
+ * The strings are not copied. They MUST be kept until the request is sent.
+ */
+struct http_multipart_part {
+	/** Name of the form field. */
+	const char *name;
+	/** Value of the text field. NULL if the part is a file. */
+	const char *value;
+	/** Path of the file on the FatFs volume. NULL if the part is a text field. */
+	const char *path;
+	/** File name which is reported to the server. */
+	const char *filename;
+	/** Content type of the file. */
+	const char *content_type;
+	/** Size of the value or the file. */
+	uint32_t length;
+};
+
+/**
+ * \brief Instance of the multipart/form-data entity.
+ *
+ * All of the memory is in this instance. Nothing is allocated in the heap.
+ */
+struct http_multipart {
+	/** Parts of the entity. */
+	struct http_multipart_part parts[HTTP_MULTIPART_MAX_PARTS];
+	/** Number of the parts. */
+	uint8_t part_count;
+	/** Boundary between the parts. */
+	char boundary[HTTP_MULTIPART_BOUNDARY_LENGTH + 1];
+	/** Value of the Content-Type header. It includes the boundary. */
+	char content_type[sizeof("multipart/form-data; boundary=") + HTTP_MULTIPART_BOUNDARY_LENGTH];
+	/** Part which is currently encoded. part_count means the closing boundary. */
+	uint8_t part;
+	/** Piece of the part which is currently encoded. */
+	uint8_t piece;
+	/** Offset in the current piece. */
+	uint32_t offset;
+	/** Total size of the encoded data. */
+	uint32_t position;
+	/** File of the current part. */
+	FIL file;
+	/** A flag that whether the file is opened or not. */
+	uint8_t file_opened;
+};
+
+/**
+ * \brief Initialize the empty entity with a new random boundary.
+ *
+ * The boundary is made with rand(). Seed it with srand() once in the application
+ * so that the boundary is different in each boot.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_multipart_init(struct http_multipart *const multipart);
+
+/**
+ * \brief Add the text field.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ * \param[in]  name            Name of the field.
+ * \param[in]  value           Value of the field.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENOSPC         HTTP_MULTIPART_MAX_PARTS parts were added already.
+ */
+int http_multipart_add_field(struct http_multipart *const multipart, const char *name, const char *value);
+
+/**
+ * \brief Add the file on the FatFs volume.
+ *
+ * The size of the file is read here. The file MUST NOT be changed until the request is sent.
+ * The file is opened only while its data is sent.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ * \param[in]  name            Name of the field.
+ * \param[in]  path            Path of the file.
+ * \param[in]  filename        File name which is reported to the server. NULL uses the path without the directories.
+ * \param[in]  content_type    Content type of the file. NULL is application/octet-stream.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENOSPC         HTTP_MULTIPART_MAX_PARTS parts were added already.
+ * \return     -ENOENT         File is not found.
+ */
+int http_multipart_add_file(struct http_multipart *const multipart, const char *name, const char *path,
+	const char *filename, const char *content_type);
+
+/**
+ * \brief Get the size of the whole encoded entity.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ *
+ * \return     Size of the entity.
+ */
+uint32_t http_multipart_get_length(struct http_multipart *const multipart);
+
+/**
+ * \brief Fill the entity interface which is passed to \ref http_client_send_request.
+ *
+ * The entity is sent with the exact Content-Length. The encoding is restarted if the entity is sent again.
+ *
+ * \param[in]  multipart       Instance of the entity.
+ * \param[out] entity          Entity interface.
+ */
+void http_multipart_get_entity(struct http_multipart *const multipart, struct http_entity *entity);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_MULTIPART_H_INCLUDED */
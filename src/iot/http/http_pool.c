@@ -0,0 +1,141 @@
+/**
+ * \file
+ *
+ * \brief Fixed-block memory pool of the HTTP client service.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/http/http_pool.h"
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+int http_pool_init(struct http_pool *const pool, void *memory, uint32_t block_size, uint16_t block_count)
+{
+	uint16_t i;
+	void **block;
+
+	if (pool == NULL || memory == NULL || block_size == 0 || block_count == 0) {
+		return -EINVAL;
+	}
+	if (((uintptr_t)memory % sizeof(void *)) != 0) {
+		/* Free list is stored in the first word of each block. */
+		return -EINVAL;
+	}
+
+	memset(pool, 0, sizeof(struct http_pool));
+	pool->memory = (uint8_t *)memory;
+	pool->block_size = HTTP_POOL_BLOCK_SIZE(block_size);
+	pool->block_count = block_count;
+
+	/* Link the blocks in the address order. */
+	for (i = 0; i < block_count; i++) {
+		block = (void **)(pool->memory + (uint32_t)i * pool->block_size);
+		*block = (i + 1 < block_count) ? pool->memory + (uint32_t)(i + 1) * pool->block_size : NULL;
+	}
+	pool->free_list = pool->memory;
+
+	return 0;
+}
+
+void *http_pool_alloc(struct http_pool *const pool, size_t size)
+{
+	void *block;
+
+	if (pool == NULL) {
+		return NULL;
+	}
+
+	if (size > pool->block_size || pool->free_list == NULL) {
+		pool->failures++;
+		return NULL;
+	}
+
+	block = pool->free_list;
+	pool->free_list = *(void **)block;
+	pool->allocs++;
+	if (++pool->used > pool->peak) {
+		pool->peak = pool->used;
+	}
+
+	return block;
+}
+
+void http_pool_free(struct http_pool *const pool, void *block)
+{
+	void *free_block;
+
+	if (pool == NULL || block == NULL) {
+		return;
+	}
+	if ((uint8_t *)block < pool->memory || (uint8_t *)block >= pool->memory + (uint32_t)pool->block_count * pool->block_size
+		|| ((uint8_t *)block - pool->memory) % pool->block_size != 0) {
+		/* Block of the other pool. Linking it would corrupt both pools. */
+		return;
+	}
+	if (pool->used == 0) {
+		/* Every block is already free. */
+		return;
+	}
+	for (free_block = pool->free_list; free_block != NULL; free_block = *(void **)free_block) {
+		if (free_block == block) {
+			/* Block was released twice. Linking it again would make a loop in the free list. */
+			return;
+		}
+	}
+
+	*(void **)block = pool->free_list;
+	pool->free_list = block;
+	pool->used--;
+}
+
+char *http_pool_strdup(struct http_pool *const pool, const char *str)
+{
+	size_t length;
+	char *copy;
+
+	length = strlen(str) + 1;
+	copy = (char *)http_pool_alloc(pool, length);
+	if (copy != NULL) {
+		memcpy(copy, str, length);
+	}
+
+	return copy;
+}
+
+void http_pool_print_stats(struct http_pool *const pool, const char *name)
+{
+	if (pool == NULL) {
+		return;
+	}
+
+	printf("%s: %u of %u blocks (%lu bytes) in use, peak %u, %lu allocations, %lu failures\r\n", name,
+		(unsigned int)pool->used, (unsigned int)pool->block_count, (unsigned long)pool->block_size,
+		(unsigned int)pool->peak, (unsigned long)pool->allocs, (unsigned long)pool->failures);
+}
@@ -0,0 +1,138 @@
+/**
+ * \file
+ *
+ * \brief Fixed-block memory pool of the HTTP client service.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_POOL_H_INCLUDED
+#define HTTP_POOL_H_INCLUDED
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Block size which is actually used. Blocks are aligned to the word. */
+#define HTTP_POOL_BLOCK_SIZE(size)     (((size) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+/** Number of the words which are needed for the memory of the pool. Use it to declare the static storage. */
+#define HTTP_POOL_MEMORY_WORDS(size, count) (HTTP_POOL_BLOCK_SIZE(size) * (count) / sizeof(void *))
+
+/**
+ * \brief Pool of the memory blocks which have the same size.
+ *
+ * The free blocks are linked through their first word, so allocating takes a constant time
+ * and the memory is never fragmented. Releasing walks the free list to ignore a block which is released twice.
+ * Pool is not protected against the interrupts. Use it in the main context only.
+ */
+struct http_pool {
+	/** Memory of the blocks. */
+	uint8_t *memory;
+	/** Head of the free list. */
+	void *free_list;
+	/** Size of a block. */
+	uint32_t block_size;
+	/** Number of the blocks. */
+	uint16_t block_count;
+	/** Number of the blocks in use. */
+	uint16_t used;
+	/** Maximum number of the blocks which were used at the same time. (High-water mark) */
+	uint16_t peak;
+	/** Number of the allocations which were succeeded. */
+	uint32_t allocs;
+	/** Number of the allocations which were failed because the pool was empty or the size was too big. */
+	uint32_t failures;
+};
+
+/**
+ * \brief Initialize the pool on the memory.
+ *
+ * \param[in]  pool            Instance of the pool.
+ * \param[in]  memory          Memory of the blocks. It must be aligned to the word. See \ref HTTP_POOL_MEMORY_WORDS.
+ * \param[in]  block_size      Size of a block. It is rounded up to the word.
+ * \param[in]  block_count     Number of the blocks.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_pool_init(struct http_pool *const pool, void *memory, uint32_t block_size, uint16_t block_count);
+
+/**
+ * \brief Take a block from the pool.
+ *
+ * \param[in]  pool            Instance of the pool.
+ * \param[in]  size            Required size. It must not be bigger than the block size.
+ *
+ * \return     Pointer of the block. NULL if the pool is empty or the size is too big.
+ */
+void *http_pool_alloc(struct http_pool *const pool, size_t size);
+
+/**
+ * \brief Return the block to the pool.
+ *
+ * \param[in]  pool            Instance of the pool.
+ * \param[in]  block           Block which was taken from this pool. NULL, a foreign pointer and a block
+ *                             which is already free are ignored.
+ */
+void http_pool_free(struct http_pool *const pool, void *block);
+
+/**
+ * \brief Copy the string into a block.
+ *
+ * \param[in]  pool            Instance of the pool.
+ * \param[in]  str             String to copy.
+ *
+ * \return     Copy of the string. NULL if the pool is empty or the string is longer than the block.
+ */
+char *http_pool_strdup(struct http_pool *const pool, const char *str);
+
+/**
+ * \brief Print the usage of the pool to the console.
+ *
+ * \param[in]  pool            Instance of the pool.
+ * \param[in]  name            Name of the pool in the output.
+ */
+void http_pool_print_stats(struct http_pool *const pool, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_POOL_H_INCLUDED */
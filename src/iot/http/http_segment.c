@@ -0,0 +1,442 @@
+/**
+ * \file
+ *
+ * \brief Segmented download over the multiple HTTP connections.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/http/http_segment.h"
+#include <string.h>
+#include <errno.h>
+
+/** Segment end which is used until the length of the chunked response is known. */
+#define HTTP_SEGMENT_UNKNOWN_END       0xFFFFFFFF
+
+static void _http_segment_client_callback(struct http_client_module *client, int type, union http_client_data *data);
+
+void http_segment_get_config_defaults(struct http_segment_config *const config)
+{
+	http_client_get_config_defaults(&config->client);
+	config->connection_count = 3;
+	config->segment_size = 65536;
+	config->max_retry = 3;
+}
+
+int http_segment_init(struct http_segment_module *const module, struct http_segment_config *config)
+{
+	int i, result;
+
+	/* Checks the parameters. */
+	if (module == NULL || config == NULL) {
+		return -EINVAL;
+	}
+
+	if (config->connection_count == 0 || config->connection_count > HTTP_SEGMENT_MAX_CONNECTIONS) {
+		return -EINVAL;
+	}
+
+	if (config->segment_size == 0) {
+		return -EINVAL;
+	}
+
+	/* Buffers can not be shared by the connections. */
+	if (config->client.recv_buffer != NULL || config->client.send_buffer != NULL
+		|| config->client.response_cache_buffer != NULL) {
+		return -EINVAL;
+	}
+
+	/* Range of the encoded entity does not match with the position in the file. */
+	if (config->client.inflate_window_size != 0) {
+		return -EINVAL;
+	}
+
+	memset(module, 0, sizeof(struct http_segment_module));
+	memcpy(&module->config, config, sizeof(struct http_segment_config));
+
+	for (i = 0; i < config->connection_count; i++) {
+		result = http_client_init(&module->connection[i].client, &module->config.client);
+		if (result < 0) {
+			while (--i >= 0) {
+				http_client_deinit(&module->connection[i].client);
+			}
+			return result;
+		}
+		module->connection[i].owner = module;
+		http_client_register_callback(&module->connection[i].client, _http_segment_client_callback);
+	}
+
+	return 0;
+}
+
+int http_segment_deinit(struct http_segment_module *const module)
+{
+	int i;
+
+	/* Checks the parameters. */
+	if (module == NULL) {
+		return -EINVAL;
+	}
+
+	http_segment_stop(module);
+	for (i = 0; i < module->config.connection_count; i++) {
+		http_client_deinit(&module->connection[i].client);
+	}
+	memset(module, 0, sizeof(struct http_segment_module));
+
+	return 0;
+}
+
+int http_segment_register_callback(struct http_segment_module *const module, http_segment_callback_t callback)
+{
+	if (module == NULL) {
+		return -EINVAL;
+	}
+
+	module->cb = callback;
+
+	return 0;
+}
+
+/**
+ * \brief Send the request of the current segment of the connection.
+ *
+ * \param[in]  module          Instance of the segmented download.
+ * \param[in]  conn            Connection which requests the segment.
+ *
+ * \return     0 if success, Negative value otherwise. See \ref http_client_send_request.
+ */
+static int _http_segment_request(struct http_segment_module *const module, struct http_segment_connection *conn)
+{
+	struct http_client_range range;
+	int result;
+
+	range.start = conn->offset;
+	range.length = conn->end - conn->offset;
+	range.validator = (module->validator[0] != '\0') ? module->validator : NULL;
+	result = http_client_send_request_range(&conn->client, module->url, HTTP_METHOD_GET, NULL, NULL, &range);
+	if (result == 0) {
+		conn->state = HTTP_SEGMENT_CONNECTION_BUSY;
+	}
+	return result;
+}
+
+int http_segment_start(struct http_segment_module *const module, const char *url, FIL *file)
+{
+	struct http_segment_connection *conn;
+	int result;
+
+	/* Checks the parameters. */
+	if (module == NULL || url == NULL || file == NULL) {
+		return -EINVAL;
+	}
+
+	if (module->state != HTTP_SEGMENT_STATE_IDLE) {
+		return -EBUSY;
+	}
+
+	module->url = url;
+	module->file = file;
+	module->total_length = 0;
+	module->received_length = 0;
+	module->validator[0] = '\0';
+	module->error = 0;
+
+	/* The first segment reports the size of the resource. */
+	conn = &module->connection[0];
+	conn->offset = 0;
+	conn->end = module->config.segment_size;
+	conn->retry = 0;
+	module->next_offset = conn->end;
+
+	result = _http_segment_request(module, conn);
+	if (result < 0) {
+		return result;
+	}
+	module->state = HTTP_SEGMENT_STATE_PROBE;
+
+	return 0;
+}
+
+void http_segment_stop(struct http_segment_module *const module)
+{
+	int i;
+
+	if (module == NULL) {
+		return;
+	}
+
+	/* Disconnection events of the closed connections are ignored in this state. */
+	module->state = HTTP_SEGMENT_STATE_IDLE;
+	for (i = 0; i < module->config.connection_count; i++) {
+		http_client_close(&module->connection[i].client);
+		module->connection[i].state = HTTP_SEGMENT_CONNECTION_IDLE;
+	}
+}
+
+/**
+ * \brief Finish the download and notify the result.
+ *
+ * \param[in]  module          Instance of the segmented download.
+ * \param[in]  result          Result of the download.
+ */
+static void _http_segment_finish(struct http_segment_module *const module, int result)
+{
+	http_segment_stop(module);
+
+	if (result == 0 && f_sync(module->file) != FR_OK) {
+		result = -EIO;
+	}
+
+	if (module->cb) {
+		module->cb(module, result);
+	}
+}
+
+void http_segment_task(struct http_segment_module *const module)
+{
+	struct http_segment_connection *conn;
+	int i, pending = 0;
+	int result;
+
+	if (module == NULL || module->state == HTTP_SEGMENT_STATE_IDLE) {
+		return;
+	}
+
+	if (module->error < 0) {
+		_http_segment_finish(module, module->error);
+		return;
+	}
+
+	if (module->state == HTTP_SEGMENT_STATE_PROBE) {
+		/* Size of the resource is not known yet. */
+		if (module->connection[0].state == HTTP_SEGMENT_CONNECTION_BUSY) {
+			return;
+		}
+		/* First request was failed before the response. Try it again. */
+		result = _http_segment_request(module, &module->connection[0]);
+		if (result < 0 && result != -EAGAIN) {
+			_http_segment_finish(module, result);
+		}
+		return;
+	}
+
+	for (i = 0; i < module->config.connection_count; i++) {
+		conn = &module->connection[i];
+		if (conn->state == HTTP_SEGMENT_CONNECTION_BUSY) {
+			pending++;
+			continue;
+		}
+		if (conn->offset >= conn->end) {
+			if (module->next_offset >= module->total_length) {
+				/* Nothing left to be assigned. */
+				continue;
+			}
+			/* Assign the next segment. */
+			conn->offset = module->next_offset;
+			conn->end = conn->offset + module->config.segment_size;
+			if (conn->end > module->total_length || conn->end < conn->offset) {
+				conn->end = module->total_length;
+			}
+			conn->retry = 0;
+			module->next_offset = conn->end;
+		}
+		/* New segment or the rest of the segment which was interrupted. */
+		pending++;
+		result = _http_segment_request(module, conn);
+		if (result < 0 && result != -EAGAIN) {
+			_http_segment_finish(module, result);
+			return;
+		}
+	}
+
+	if (pending == 0) {
+		_http_segment_finish(module, 0);
+	}
+}
+
+/**
+ * \brief Handle the status of the response of the segment.
+ *
+ * \param[in]  module          Instance of the segmented download.
+ * \param[in]  conn            Connection which received the response.
+ * \param[in]  resp            Response data from the HTTP client.
+ *
+ * \return     0 if the entity is stored, Negative value otherwise.
+ */
+static int _http_segment_handle_response(struct http_segment_module *const module,
+	struct http_segment_connection *conn, struct http_client_data_recv_response *resp)
+{
+	if (resp->response_code == 206) {
+		if (resp->range_start != conn->offset) {
+			module->error = -EBADMSG;
+			return -1;
+		}
+		if (module->state == HTTP_SEGMENT_STATE_PROBE) {
+			if (resp->total_length == 0) {
+				/* Size of the resource is unknown. It can not be divided. */
+				module->error = -ENOTSUP;
+				return -1;
+			}
+			module->total_length = resp->total_length;
+			if (conn->end > module->total_length) {
+				conn->end = module->total_length;
+			}
+			module->next_offset = conn->end;
+			if (resp->validator != NULL) {
+				strcpy(module->validator, resp->validator);
+			}
+			/* Allocate the clusters of the whole file at once. Segments are written in the random order. */
+			if (f_lseek(module->file, module->total_length) != FR_OK || module->file->fsize < module->total_length) {
+				module->error = -ENOSPC;
+				return -1;
+			}
+			module->state = HTTP_SEGMENT_STATE_RUNNING;
+		}
+		return 0;
+	}
+
+	if (resp->response_code == 200 && module->state == HTTP_SEGMENT_STATE_PROBE) {
+		/* Server does not support the range. The whole resource is received over this connection. */
+		conn->end = resp->is_chunked ? HTTP_SEGMENT_UNKNOWN_END : resp->content_length;
+		module->total_length = conn->end;
+		module->next_offset = conn->end;
+		module->state = HTTP_SEGMENT_STATE_RUNNING;
+		return 0;
+	}
+
+	/* 200 OK for the later segment means that If-Range was not matched. */
+	module->error = (resp->response_code == 200) ? -EBADMSG : -EIO;
+	return -1;
+}
+
+/**
+ * \brief Write the received data at its position in the file.
+ *
+ * \param[in]  module          Instance of the segmented download.
+ * \param[in]  conn            Connection which received the data.
+ * \param[in]  data            Received data.
+ * \param[in]  length          Size of the data.
+ *
+ * \return     0 if success, Negative value otherwise.
+ */
+static int _http_segment_write(struct http_segment_module *const module,
+	struct http_segment_connection *conn, const char *data, uint32_t length)
+{
+	UINT written;
+
+	if (length > conn->end - conn->offset) {
+		/* Ignore the data beyond the segment. */
+		length = conn->end - conn->offset;
+	}
+	if (length == 0) {
+		return 0;
+	}
+
+	if (module->file->fptr != conn->offset && f_lseek(module->file, conn->offset) != FR_OK) {
+		module->error = -EIO;
+		return -1;
+	}
+	if (f_write(module->file, data, length, &written) != FR_OK || written != length) {
+		module->error = -EIO;
+		return -1;
+	}
+
+	conn->offset += length;
+	conn->retry = 0;
+	module->received_length += length;
+	return 0;
+}
+
+/**
+ * \brief Finish the segment of the connection.
+ *
+ * \param[in]  module          Instance of the segmented download.
+ * \param[in]  conn            Connection which received the whole response.
+ */
+static void _http_segment_complete(struct http_segment_module *const module, struct http_segment_connection *conn)
+{
+	if (conn->end == HTTP_SEGMENT_UNKNOWN_END) {
+		/* End of the chunked response. Now the size is known. */
+		conn->end = conn->offset;
+		module->total_length = conn->offset;
+		module->next_offset = conn->offset;
+	}
+	/* If the response was shorter than the segment, The rest of it is requested again. */
+	conn->state = HTTP_SEGMENT_CONNECTION_IDLE;
+}
+
+static void _http_segment_client_callback(struct http_client_module *client, int type, union http_client_data *data)
+{
+	/* Client is the first member of the connection. */
+	struct http_segment_connection *const conn = (struct http_segment_connection *)client;
+	struct http_segment_module *const module = conn->owner;
+
+	if (module->state == HTTP_SEGMENT_STATE_IDLE || module->error < 0
+		|| conn->state != HTTP_SEGMENT_CONNECTION_BUSY) {
+		return;
+	}
+
+	switch (type) {
+	case HTTP_CLIENT_CALLBACK_RECV_RESPONSE:
+		if (_http_segment_handle_response(module, conn, &data->recv_response) < 0) {
+			return;
+		}
+		if (data->recv_response.content != NULL) {
+			/* Whole entity was received at once. */
+			if (_http_segment_write(module, conn, data->recv_response.content, data->recv_response.content_length) < 0) {
+				return;
+			}
+			_http_segment_complete(module, conn);
+		}
+		break;
+
+	case HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA:
+		if (_http_segment_write(module, conn, data->recv_chunked_data.data, data->recv_chunked_data.length) < 0) {
+			return;
+		}
+		if (data->recv_chunked_data.is_complete) {
+			_http_segment_complete(module, conn);
+		}
+		break;
+
+	case HTTP_CLIENT_CALLBACK_DISCONNECTED:
+		/* Connection was lost before the segment was finished. */
+		if (conn->retry++ >= module->config.max_retry) {
+			module->error = (data->disconnected.reason < 0) ? data->disconnected.reason : -ECONNRESET;
+			return;
+		}
+		if (conn->end == HTTP_SEGMENT_UNKNOWN_END) {
+			/* Position of the chunked response can not be resumed. */
+			module->error = -ECONNRESET;
+			return;
+		}
+		conn->state = HTTP_SEGMENT_CONNECTION_IDLE;
+		break;
+	}
+}
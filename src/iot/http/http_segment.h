@@ -0,0 +1,258 @@
+/**
+ * \file
+ *
+ * \brief Segmented download over the multiple HTTP connections.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/**
+ * \addtogroup sam0_httpc_group
+ * @{
+ */
+
+#ifndef HTTP_SEGMENT_H_INCLUDED
+#define HTTP_SEGMENT_H_INCLUDED
+
+#include "iot/http/http_client.h"
+#include "ff.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of the connections which are used by one download. */
+#define HTTP_SEGMENT_MAX_CONNECTIONS   TCP_SOCK_MAX
+
+/**
+ * \brief State of the segmented download.
+ */
+enum http_segment_state {
+	/** Download is not started. */
+	HTTP_SEGMENT_STATE_IDLE = 0,
+	/** Size of the resource is queried by the first segment. */
+	HTTP_SEGMENT_STATE_PROBE,
+	/** Segments are downloaded over the all connections. */
+	HTTP_SEGMENT_STATE_RUNNING,
+};
+
+/**
+ * \brief State of the one connection.
+ */
+enum http_segment_connection_state {
+	/** Connection is waiting for the next segment. */
+	HTTP_SEGMENT_CONNECTION_IDLE = 0,
+	/** Request was sent and the response is being received. */
+	HTTP_SEGMENT_CONNECTION_BUSY,
+};
+
+/* Before declaring for the callback type. */
+struct http_segment_module;
+
+/**
+ * \brief Callback which is called when the download is finished.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ * \param[in]  result          0 if the whole resource was stored. Negative error code otherwise.
+ *                             -EBADMSG means the resource was changed during the download.
+ *                             -EIO means the server responded the error or the file write was failed.
+ */
+typedef void (*http_segment_callback_t)(struct http_segment_module *module_inst, int result);
+
+/**
+ * \brief Segmented download configuration structure
+ *
+ * Configuration struct for a segmented download instance. This structure should be
+ * initialized by the \ref http_segment_get_config_defaults function before being
+ * modified by the user application.
+ */
+struct http_segment_config {
+	/**
+	 * Configuration of the HTTP client connections. It is applied to the all connections.
+	 * Each connection owns its receive and send buffer and its response cache, so their buffers MUST be NULL
+	 * to be allocated in the buffer pool or the heap.
+	 * Each connection uses one timer. CONF_SW_TIMER_COUNT must be large enough.
+	 */
+	struct http_client_config client;
+	/**
+	 * Number of the connections. It must be 1 to \ref HTTP_SEGMENT_MAX_CONNECTIONS.
+	 * Default value is 3.
+	 */
+	uint8_t connection_count;
+	/**
+	 * Size of the segment which is requested at once.
+	 * Idle connection requests the next segment, so the fast connection downloads more segments than the slow one.
+	 * Default value is 65536.
+	 */
+	uint32_t segment_size;
+	/**
+	 * Number of the retries when the connection was lost.
+	 * The rest of the segment is requested again from the lost position.
+	 * Default value is 3.
+	 */
+	uint8_t max_retry;
+};
+
+/**
+ * \brief One connection of the segmented download.
+ */
+struct http_segment_connection {
+	/** HTTP client of this connection. It MUST be the first member to find the connection from the client callback. */
+	struct http_client_module client;
+	/** Download which owns this connection. */
+	struct http_segment_module *owner;
+	/** Position of the next byte to be written in the file. */
+	uint32_t offset;
+	/** End of the assigned segment. It is not included in the segment. */
+	uint32_t end;
+	/** State of the connection. See \ref http_segment_connection_state. */
+	uint8_t state;
+	/** Number of the retries of the current segment. */
+	uint8_t retry;
+};
+
+/**
+ * \brief Instance of the segmented download.
+ */
+struct http_segment_module {
+	/** Connections of the download. */
+	struct http_segment_connection connection[HTTP_SEGMENT_MAX_CONNECTIONS];
+	/** Configuration of the download. */
+	struct http_segment_config config;
+	/** Callback of the download. */
+	http_segment_callback_t cb;
+	/** URL of the resource. It is not copied, so it must be valid until the download is finished. */
+	const char *url;
+	/** Destination file. */
+	FIL *file;
+	/** Size of the resource. Zero if it is not known yet. */
+	uint32_t total_length;
+	/** Start of the segment which is not assigned to any connection yet. */
+	uint32_t next_offset;
+	/** Total size of the data which was written in the file. */
+	uint32_t received_length;
+	/** Strong validator of the resource. It is sent in the If-Range header to detect the change of the resource. */
+	char validator[HTTP_MAX_HEADER_VALUE_LENGTH];
+	/**
+	 * Error which was occurred in the callback of the HTTP client.
+	 * The connections can not be closed in there, so the download is finished in \ref http_segment_task.
+	 */
+	int error;
+	/** State of the download. See \ref http_segment_state. */
+	uint8_t state;
+};
+
+/**
+ * \brief Get default configuration of the segmented download.
+ *
+ * \param[in]  config          Pointer of configuration structure which will be used in the module.
+ */
+void http_segment_get_config_defaults(struct http_segment_config *const config);
+
+/**
+ * \brief Initialize the segmented download and its connections.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ * \param[in]  config          Configuration of the download.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENOMEM         Out of memory.
+ * \return     -ENOSPC         No timer is left.
+ */
+int http_segment_init(struct http_segment_module *const module, struct http_segment_config *config);
+
+/**
+ * \brief Close the connections and release the resources.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_segment_deinit(struct http_segment_module *const module);
+
+/**
+ * \brief Register the callback which is called when the download is finished.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ * \param[in]  callback        Callback function.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int http_segment_register_callback(struct http_segment_module *const module, http_segment_callback_t callback);
+
+/**
+ * \brief Start to download the resource in the file.
+ *
+ * The first segment is requested to get the size of the resource.
+ * After that, The rest of the resource is divided into the segments and they are requested over the all connections.
+ * Each segment is written at its position of the file. If the server does not support the range request,
+ * The whole resource is downloaded over the first connection.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ * \param[in]  url             URL of the resource.
+ * \param[in]  file            File which was opened with the FA_WRITE flag.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -EBUSY          Download is running already.
+ * \return     Others          Same as \ref http_client_send_request.
+ */
+int http_segment_start(struct http_segment_module *const module, const char *url, FIL *file);
+
+/**
+ * \brief Stop the download and close the connections.
+ *
+ * The callback is not called.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ */
+void http_segment_stop(struct http_segment_module *const module);
+
+/**
+ * \brief Request the next segments on the idle connections and check the end of the download.
+ *
+ * The request can not be sent in the callback of the HTTP client, so this function
+ * must be called periodically in the main loop like \ref sw_timer_task.
+ *
+ * \param[in]  module_inst     Instance of the segmented download.
+ */
+void http_segment_task(struct http_segment_module *const module);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* HTTP_SEGMENT_H_INCLUDED */
@@ -0,0 +1,161 @@
+/**
+ * \file
+ *
+ * \brief Event reactor for the IoT(Internet of things) service.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "iot/reactor.h"
+#include <errno.h>
+#include "conf_winc.h"
+#include "driver/include/m2m_wifi.h"
+
+void reactor_get_config_defaults(struct reactor_config *const config)
+{
+	Assert(config);
+
+	config->timer_inst = NULL;
+	config->sleep = true;
+}
+
+int reactor_init(struct reactor_module *const module, struct reactor_config *const config)
+{
+	if (module == NULL || config == NULL || config->timer_inst == NULL) {
+		return -EINVAL;
+	}
+
+	memset(module, 0, sizeof(struct reactor_module));
+	module->timer_inst = config->timer_inst;
+	module->sleep = config->sleep;
+
+	return 0;
+}
+
+int reactor_post(struct reactor_module *const module, reactor_handler_t handler, void *context)
+{
+	struct reactor_event *event;
+	irqflags_t flags;
+	int ret = 0;
+
+	if (module == NULL || handler == NULL) {
+		return -EINVAL;
+	}
+
+	flags = cpu_irq_save();
+	if (module->count < CONF_REACTOR_QUEUE_SIZE) {
+		event = &module->queue[(module->head + module->count) % CONF_REACTOR_QUEUE_SIZE];
+		event->handler = handler;
+		event->context = context;
+		module->count++;
+	} else {
+		module->dropped++;
+		ret = -ENOSPC;
+	}
+	cpu_irq_restore(flags);
+
+	return ret;
+}
+
+/**
+ * \brief Take the oldest event from the queue.
+ *
+ * \param[in]  module          Instance of the reactor.
+ * \param[out] event           Event which was taken.
+ */
+static void _reactor_pop(struct reactor_module *const module, struct reactor_event *event)
+{
+	irqflags_t flags;
+
+	flags = cpu_irq_save();
+	*event = module->queue[module->head];
+	module->head = (module->head + 1) % CONF_REACTOR_QUEUE_SIZE;
+	module->count--;
+	cpu_irq_restore(flags);
+}
+
+int reactor_run_once(struct reactor_module *const module)
+{
+	struct reactor_event event;
+	uint8_t pending;
+
+	Assert(module);
+
+	if (module->dispatching) {
+		/* Nested dispatch would make the stack depth unbounded. */
+		return -EBUSY;
+	}
+	module->dispatching = 1;
+
+	/* Handle pending events from network controller. */
+	m2m_wifi_handle_events(NULL);
+	/* Checks the timer timeout. */
+	sw_timer_task(module->timer_inst);
+	/* Events which are posted by the handlers are left for the next iteration. */
+	for (pending = module->count; pending > 0; pending--) {
+		_reactor_pop(module, &event);
+		event.handler(module, event.context);
+	}
+
+	module->dispatching = 0;
+
+	if (module->sleep) {
+		/*
+		 * Sleep until the WINC or the timer interrupts.
+		 * WINC keeps the interrupt line low until the event is handled, so no event is lost.
+		 * The queue is checked with the interrupts disabled for the events which are posted by the ISR.
+		 */
+		cpu_irq_disable();
+		if (module->count == 0 && !module->stopped && port_pin_get_input_level(CONF_WINC_SPI_INT_PIN)) {
+			sw_timer_sleep(module->timer_inst);
+		}
+		cpu_irq_enable();
+	}
+
+	return 0;
+}
+
+void reactor_run(struct reactor_module *const module)
+{
+	Assert(module);
+
+	while (!module->stopped) {
+		if (reactor_run_once(module) < 0) {
+			return;
+		}
+	}
+	/* Request of the stop is consumed. */
+	module->stopped = 0;
+}
+
+void reactor_stop(struct reactor_module *const module)
+{
+	Assert(module);
+
+	module->stopped = 1;
+}
@@ -0,0 +1,186 @@
+/**
+ * \file
+ *
+ * \brief Event reactor for the IoT(Internet of things) service.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#ifndef IOT_REACTOR_H_INCLUDED
+#define IOT_REACTOR_H_INCLUDED
+
+#include <asf.h>
+#include <stdint.h>
+#include "iot/sw_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONF_REACTOR_QUEUE_SIZE
+/** Maximum number of the posted events which are not handled yet. */
+#  define CONF_REACTOR_QUEUE_SIZE          8
+#endif
+
+#if CONF_REACTOR_QUEUE_SIZE > 255
+#  error "CONF_REACTOR_QUEUE_SIZE must be less than 256."
+#endif
+
+struct reactor_module;
+
+/**
+ * Callback Function type of the posted event.
+ *
+ * \param[in]  module          Instance of the reactor.
+ * \param[in]  context         Private data which was passed to \ref reactor_post.
+ */
+typedef void (*reactor_handler_t)(struct reactor_module *const module, void *context);
+
+/**
+ * \brief Reactor configuration structure
+ *
+ * Configuration struct for a reactor instance. This structure should be
+ * initialized by the \ref reactor_get_config_defaults function before being
+ * modified by the user application.
+ */
+struct reactor_config {
+	/** Timer which is checked in every iteration and which wakes up the CPU. */
+	struct sw_timer_module *timer_inst;
+	/** A flag that the CPU sleeps when there is nothing to do. */
+	bool sleep;
+};
+
+/**
+ * \brief Posted event.
+ */
+struct reactor_event {
+	/** Callback of the event. */
+	reactor_handler_t handler;
+	/** Private data of the event. */
+	void *context;
+};
+
+/**
+ * \brief Reactor module structure
+ *
+ * All of the events are dispatched from \ref reactor_run_once.
+ * The WINC events, The expired timers and the posted events are handled in this order.
+ * So each callback runs on the stack of the reactor and never inside another callback.
+ */
+struct reactor_module {
+	/** Posted events. (ring buffer) */
+	struct reactor_event queue[CONF_REACTOR_QUEUE_SIZE];
+	/** Position of the oldest event. */
+	volatile uint8_t head;
+	/** Number of the events in the queue. */
+	volatile uint8_t count;
+	/** A flag that the events are being dispatched. */
+	uint8_t dispatching;
+	/** A flag that \ref reactor_run should return. */
+	volatile uint8_t stopped;
+	/** A flag that the CPU sleeps when there is nothing to do. */
+	uint8_t sleep;
+	/** Number of the events which were rejected because the queue was full. */
+	uint32_t dropped;
+	/** Timer instance. */
+	struct sw_timer_module *timer_inst;
+};
+
+/**
+ * \brief Get default configuration of the reactor.
+ *
+ * \param[in]  config          Pointer of configuration structure which will be used in the reactor.
+ */
+void reactor_get_config_defaults(struct reactor_config *const config);
+
+/**
+ * \brief Initialize the reactor.
+ *
+ * \param[in]  module          Instance of the reactor.
+ * \param[in]  config          Pointer of configuration structure.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ */
+int reactor_init(struct reactor_module *const module, struct reactor_config *const config);
+
+/**
+ * \brief Post the event which is handled in the next iteration of the reactor.
+ *
+ * Use it to defer the work which should not be done inside a callback. (e.g. Sending a new request
+ * from the callback of the previous one.)
+ * It can be called in the interrupt context.
+ *
+ * \param[in]  module          Instance of the reactor.
+ * \param[in]  handler         Callback of the event.
+ * \param[in]  context         Private data which is passed to the callback.
+ *
+ * \return     0               Function succeeded
+ * \return     -EINVAL         Invalid argument.
+ * \return     -ENOSPC         Queue is full. The event is counted in the dropped.
+ */
+int reactor_post(struct reactor_module *const module, reactor_handler_t handler, void *context);
+
+/**
+ * \brief Run one iteration of the reactor.
+ *
+ * Handles the WINC events, The expired timers and the events which were posted before the iteration.
+ * Events which are posted during the iteration are handled in the next one,
+ * so the time of an iteration is bounded.
+ * If nothing is pending at the end, The CPU sleeps until the next interrupt or the timer deadline.
+ *
+ * \param[in]  module          Instance of the reactor.
+ *
+ * \return     0               Function succeeded
+ * \return     -EBUSY          Called inside a callback of the reactor. Nothing was done.
+ */
+int reactor_run_once(struct reactor_module *const module);
+
+/**
+ * \brief Run the reactor until \ref reactor_stop is called.
+ *
+ * \param[in]  module          Instance of the reactor.
+ */
+void reactor_run(struct reactor_module *const module);
+
+/**
+ * \brief Make \ref reactor_run return after the current iteration.
+ *
+ * If \ref reactor_run is not running, The next call returns immediately.
+ *
+ * It can be called in the callbacks and the interrupt context.
+ *
+ * \param[in]  module          Instance of the reactor.
+ */
+void reactor_stop(struct reactor_module *const module);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOT_REACTOR_H_INCLUDED */
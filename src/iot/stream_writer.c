@@ -85,9 +85,55 @@ void stream_writer_send_32LE(struct stream_writer * writer, int32_t value)
 
 void stream_writer_send_buffer(struct stream_writer * writer, const char *buffer, size_t length)
 {
-	for (; length > 0; length--, buffer++) {
-		stream_writer_send_8(writer, *buffer);
+	size_t remain;
+
+	while (length > 0) {
+		if (writer->written == 0 && length >= writer->max_size) {
+			/* Buffer is empty. Pass the full size data to the write function without staging. */
+			writer->write_func(writer->priv_data, (char *)buffer, writer->max_size);
+			buffer += writer->max_size;
+			length -= writer->max_size;
+			continue;
+		}
+
+		remain = writer->max_size - writer->written;
+		if (remain > length) {
+			remain = length;
+		}
+		memcpy(writer->buffer + writer->written, buffer, remain);
+		writer->written += remain;
+		buffer += remain;
+		length -= remain;
+
+		if (writer->written >= writer->max_size) {
+			stream_writer_send_remain(writer);
+		}
+	}
+}
+
+void stream_writer_send_iov(struct stream_writer * writer, const struct stream_writer_iov *iov, int count)
+{
+	for (; count > 0; count--, iov++) {
+		stream_writer_send_buffer(writer, iov->buffer, iov->length);
+	}
+}
+
+char *stream_writer_reserve(struct stream_writer * writer, size_t length)
+{
+	if (length > writer->max_size) {
+		return NULL;
+	}
+
+	if (writer->max_size - writer->written < length) {
+		stream_writer_send_remain(writer);
 	}
+
+	return writer->buffer + writer->written;
+}
+
+void stream_writer_commit(struct stream_writer * writer, size_t length)
+{
+	writer->written += length;
 }
 
 void stream_writer_send_remain(struct stream_writer * writer)
@@ -51,6 +51,16 @@ struct stream_writer {
 	char *buffer;
 };
 
+/**
+ * \brief A segment of the data which will be written by \ref stream_writer_send_iov.
+ */
+struct stream_writer_iov {
+	/** Start of the segment. */
+	const char *buffer;
+	/** Size of the segment. */
+	size_t length;
+};
+
 /**
  * \brief Initialize the Stream writer module.
  *
@@ -111,6 +121,39 @@ void stream_writer_send_32LE(struct stream_writer * writer, int32_t value);
  */
 void stream_writer_send_buffer(struct stream_writer * writer, const char *buffer, size_t length);
 
+/**
+ * \brief Write multiple buffers to the writer.
+ *
+ * Segments are copied in blocks. If the writer buffer is filled, it is flushed immediately
+ * and the data which is bigger than the writer buffer is passed to the write function without staging.
+ *
+ * \param[in]  writer          Pointer of stream writer.
+ * \param[in]  iov             Array of the segments.
+ * \param[in]  count           Number of the segments.
+ */
+void stream_writer_send_iov(struct stream_writer * writer, const struct stream_writer_iov *iov, int count);
+
+/**
+ * \brief Reserve space in the writer buffer.
+ *
+ * The caller can format the data directly into the returned space,
+ * and MUST call \ref stream_writer_commit with the size that was actually written.
+ *
+ * \param[in]  writer          Pointer of stream writer.
+ * \param[in]  length          Size of the space to be reserved.
+ *
+ * \return     Pointer of the reserved space. NULL if length is bigger than the writer buffer.
+ */
+char *stream_writer_reserve(struct stream_writer * writer, size_t length);
+
+/**
+ * \brief Commit the data which was written in the reserved space.
+ *
+ * \param[in]  writer          Pointer of stream writer.
+ * \param[in]  length          Size of the written data. It MUST not be bigger than the reserved size.
+ */
+void stream_writer_commit(struct stream_writer * writer, size_t length);
+
 /**
  * \brief Process remain data in the writer.
  *
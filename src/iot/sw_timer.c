@@ -32,9 +32,17 @@
  */
 
 #include "sw_timer.h"
+#if defined(__linux__)
+#  include <time.h>
+#endif
 
 /** Tick count of timer. */
-static uint32_t sw_timer_tick = 0;
+static volatile uint32_t sw_timer_tick = 0;
+
+#if (SAMD21)
+/** Number of the overflows of the free-running counter in the tickless mode. */
+static volatile uint32_t sw_timer_overflow = 0;
+#endif
 
 /**
  * \brief TCC callback of SW timer.
@@ -49,6 +57,58 @@ static void sw_timer_tcc_callback(struct tcc_module *const module)
 	sw_timer_tick++;
 }
 
+/**
+ * \brief TCC overflow callback of SW timer in the tickless mode.
+ *
+ * \param[in] module Instance of the TCC.
+ */
+static void sw_timer_tcc_overflow_callback(struct tcc_module *const module)
+{
+	sw_timer_overflow++;
+}
+
+/**
+ * \brief TCC compare callback of SW timer in the tickless mode.
+ *
+ * It only wakes up the CPU. The expiration is checked in \ref sw_timer_task.
+ *
+ * \param[in] module Instance of the TCC.
+ */
+static void sw_timer_tcc_wakeup_callback(struct tcc_module *const module)
+{
+}
+
+/**
+ * \brief Get the number of the TCC counts since the timer was enabled.
+ *
+ * The counter wraps once per tick in the tick mode and once per overflow in the tickless mode.
+ * It can be called in the interrupt context.
+ *
+ * \param[in] module_inst Instance of the SW timer.
+ */
+static uint64_t _sw_timer_get_counts(struct sw_timer_module *const module_inst)
+{
+	irqflags_t flags;
+	uint32_t wraps, count, pending;
+
+	flags = cpu_irq_save();
+	count = tcc_get_count_value(&module_inst->tcc_inst);
+	if (module_inst->tickless) {
+		wraps = sw_timer_overflow;
+		pending = TCC_INTFLAG_OVF;
+	} else {
+		wraps = sw_timer_tick;
+		pending = TCC_INTFLAG_MC(1 << module_inst->channel);
+	}
+	if ((module_inst->tcc_inst.hw->INTFLAG.reg & pending) && count < module_inst->counter_top / 2) {
+		/* Counter was wrapped before it was read, but the interrupt was not handled yet. */
+		wraps++;
+	}
+	cpu_irq_restore(flags);
+
+	return (uint64_t)wraps * (module_inst->counter_top + 1) + count;
+}
+
 #elif (SAM4S) || (SAMG53) || (SAMG55)
 void RTT_Handler(void)
 {
@@ -65,11 +125,115 @@ void RTT_Handler(void)
 
 #endif
 
+/**
+ * \brief Checks the timer a expires before the timer b.
+ *
+ * The tick count can be wrapped around. So the expired times are compared by the difference.
+ */
+static inline int _sw_timer_before(struct sw_timer_module *const module_inst, uint8_t a, uint8_t b)
+{
+	return (int32_t)(module_inst->handler[a].expire_time - module_inst->handler[b].expire_time) < 0;
+}
+
+/**
+ * \brief Place the timer at the position of the heap.
+ */
+static inline void _sw_timer_heap_set(struct sw_timer_module *const module_inst, uint8_t pos, uint8_t timer_id)
+{
+	module_inst->heap[pos] = timer_id;
+	module_inst->handler[timer_id].heap_index = pos;
+}
+
+/**
+ * \brief Move the timer at the position toward the root until its parent expires earlier.
+ */
+static void _sw_timer_heap_up(struct sw_timer_module *const module_inst, uint8_t pos)
+{
+	uint8_t timer_id = module_inst->heap[pos];
+	uint8_t parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (!_sw_timer_before(module_inst, timer_id, module_inst->heap[parent])) {
+			break;
+		}
+		_sw_timer_heap_set(module_inst, pos, module_inst->heap[parent]);
+		pos = parent;
+	}
+	_sw_timer_heap_set(module_inst, pos, timer_id);
+}
+
+/**
+ * \brief Move the timer at the position toward the leaves until its children expire later.
+ */
+static void _sw_timer_heap_down(struct sw_timer_module *const module_inst, uint8_t pos)
+{
+	uint8_t timer_id = module_inst->heap[pos];
+	int child;
+
+	while ((child = pos * 2 + 1) < module_inst->heap_count) {
+		if (child + 1 < module_inst->heap_count
+			&& _sw_timer_before(module_inst, module_inst->heap[child + 1], module_inst->heap[child])) {
+			child++;
+		}
+		if (!_sw_timer_before(module_inst, module_inst->heap[child], timer_id)) {
+			break;
+		}
+		_sw_timer_heap_set(module_inst, pos, module_inst->heap[child]);
+		pos = child;
+	}
+	_sw_timer_heap_set(module_inst, pos, timer_id);
+}
+
+/**
+ * \brief Add the timer to the deadline heap.
+ */
+static void _sw_timer_heap_insert(struct sw_timer_module *const module_inst, uint8_t timer_id)
+{
+	module_inst->heap[module_inst->heap_count] = timer_id;
+	_sw_timer_heap_up(module_inst, module_inst->heap_count++);
+}
+
+/**
+ * \brief Remove the timer from the deadline heap.
+ */
+static void _sw_timer_heap_remove(struct sw_timer_module *const module_inst, uint8_t timer_id)
+{
+	uint8_t pos = module_inst->handler[timer_id].heap_index;
+	uint8_t last = module_inst->heap[--module_inst->heap_count];
+
+	if (last == timer_id) {
+		return;
+	}
+	/* Last timer fills the hole. It can go either way. */
+	_sw_timer_heap_set(module_inst, pos, last);
+	_sw_timer_heap_up(module_inst, pos);
+	_sw_timer_heap_down(module_inst, module_inst->handler[last].heap_index);
+}
+
+/**
+ * \brief Get the current tick count.
+ *
+ * In the tickless mode, The tick count is calculated from the free-running counter.
+ *
+ * \param[in] module_inst Instance of the SW timer.
+ */
+static uint32_t _sw_timer_get_tick(struct sw_timer_module *const module_inst)
+{
+#if (SAMD21)
+	if (module_inst->tickless) {
+		sw_timer_tick = (uint32_t)(_sw_timer_get_counts(module_inst) * 1000 / module_inst->counter_hz);
+	}
+#endif
+	return sw_timer_tick;
+}
+
 void sw_timer_get_config_defaults(struct sw_timer_config *const config)
 {
 	Assert(config);
 
 	config->accuracy = 100;
+	config->tickless = false;
 	config->tcc_dev = 0;
 	config->tcc_callback_channel = 0;
 }
@@ -88,14 +252,31 @@ void sw_timer_init(struct sw_timer_module *const module_inst, struct sw_timer_co
 	Assert(config->tcc_callback_channel < TCC_NUM_CHANNELS);
 
 	module_inst->accuracy = config->accuracy;
+	module_inst->heap_count = 0;
 #if (SAMD21)
 	/* Start the TCC module. */
 	tcc_module = &module_inst->tcc_inst;
 	tcc_get_config_defaults(&tcc_conf, hw[config->tcc_dev]);
-	tcc_conf.counter.period = system_cpu_clock_get_hz() / (64 * 1000 / config->accuracy);
+	module_inst->counter_hz = system_cpu_clock_get_hz() / 64;
+	module_inst->tickless = config->tickless;
+	module_inst->channel = config->tcc_callback_channel;
+	if (config->tickless) {
+		/* Counter runs over its whole range. Only the overflow and the deadline wake up the CPU. */
+		module_inst->accuracy = 1;
+		tcc_conf.double_buffering_enabled = false;
+	} else {
+		tcc_conf.counter.period = module_inst->counter_hz / (1000 / config->accuracy);
+	}
+	module_inst->counter_top = tcc_conf.counter.period;
 	tcc_conf.counter.clock_prescaler = TCC_CLOCK_PRESCALER_DIV64;
 	tcc_init(tcc_module, hw[config->tcc_dev], &tcc_conf);
-	tcc_register_callback(tcc_module, sw_timer_tcc_callback, config->tcc_callback_channel + TCC_CALLBACK_CHANNEL_0);
+	if (config->tickless) {
+		tcc_register_callback(tcc_module, sw_timer_tcc_overflow_callback, TCC_CALLBACK_OVERFLOW);
+		tcc_enable_callback(tcc_module, TCC_CALLBACK_OVERFLOW);
+		tcc_register_callback(tcc_module, sw_timer_tcc_wakeup_callback, config->tcc_callback_channel + TCC_CALLBACK_CHANNEL_0);
+	} else {
+		tcc_register_callback(tcc_module, sw_timer_tcc_callback, config->tcc_callback_channel + TCC_CALLBACK_CHANNEL_0);
+	}
 	tcc_enable_callback(tcc_module, config->tcc_callback_channel + TCC_CALLBACK_CHANNEL_0);
 #elif (SAM4S) || (SAMG53) || (SAMG55)
 	uint32_t ul_previous_time;
@@ -166,7 +347,8 @@ int sw_timer_register_callback(struct sw_timer_module *const module_inst,
 			handler->callback = callback;
 			handler->callback_enable = 0;
 			handler->context = context;
-			handler->period = period / module_inst->accuracy;
+			/* Period is rounded up to the tick. */
+			handler->period = (period + module_inst->accuracy - 1) / module_inst->accuracy;
 			handler->used = 1;
 			return index;
 		}
@@ -183,6 +365,10 @@ void sw_timer_unregister_callback(struct sw_timer_module *const module_inst, int
 
 	handler = &module_inst->handler[timer_id];
 
+	if (handler->callback_enable) {
+		_sw_timer_heap_remove(module_inst, timer_id);
+		handler->callback_enable = 0;
+	}
 	handler->used = 0;
 }
 
@@ -195,9 +381,17 @@ void sw_timer_enable_callback(struct sw_timer_module *const module_inst, int tim
 
 	handler = &module_inst->handler[timer_id];
 
+	if (handler->callback_enable) {
+		/* Restart the timer with the new delay. */
+		_sw_timer_heap_remove(module_inst, timer_id);
+	}
 	handler->callback_enable = 1;
-	//handler->expire_time = sw_timer_tick + (delay / module_inst->accuracy);
-	handler->expire_time = 1000000000;
+	/*
+	 * The current tick was already started. The callback is called after the expired tick is passed,
+	 * so the delay which is rounded up to the tick is guaranteed.
+	 */
+	handler->expire_time = _sw_timer_get_tick(module_inst) + (delay + module_inst->accuracy - 1) / module_inst->accuracy;
+	_sw_timer_heap_insert(module_inst, timer_id);
 }
 
 void sw_timer_disable_callback(struct sw_timer_module *const module_inst, int timer_id)
@@ -209,34 +403,132 @@ void sw_timer_disable_callback(struct sw_timer_module *const module_inst, int ti
 
 	handler = &module_inst->handler[timer_id];
 
-	handler->callback_enable = 0;
+	if (handler->callback_enable) {
+		_sw_timer_heap_remove(module_inst, timer_id);
+		handler->callback_enable = 0;
+	}
 }
 
 void sw_timer_task(struct sw_timer_module *const module_inst)
 {
 	int index;
 	struct sw_timer_handle *handler;
+	uint32_t tick;
 
 	Assert(module_inst);
 
-	for (index = 0; index < CONF_SW_TIMER_COUNT; index++) {
-		if (module_inst->handler[index].used && module_inst->handler[index].callback_enable) {
-			handler = &module_inst->handler[index];
-			if ((int)(handler->expire_time - sw_timer_tick) < 0 && handler->busy == 0) {
-				/* Enter critical section. */
-				handler->busy = 1;
-				/* Timer was expired. */
-				if (handler->period > 0) {
-					handler->expire_time = sw_timer_tick + handler->period;
-				} else {
-					/* One shot. */
-					handler->callback_enable = 0;
-				}
-				/* Call callback function. */
-				handler->callback(module_inst, index, handler->context, handler->period);
-				/* Leave critical section. */
-				handler->busy = 0;
+	tick = _sw_timer_get_tick(module_inst);
+	while (module_inst->heap_count > 0) {
+		index = module_inst->heap[0];
+		handler = &module_inst->handler[index];
+		if ((int32_t)(tick - handler->expire_time) <= 0 || handler->busy) {
+			/* Earliest timer was not expired. */
+			break;
+		}
+		/* Timer was expired. */
+		_sw_timer_heap_remove(module_inst, index);
+		if (handler->period > 0) {
+			handler->expire_time += handler->period;
+			if ((int32_t)(tick - handler->expire_time) > 0) {
+				/* Periods which were missed are skipped. */
+				handler->expire_time = tick + handler->period;
+			}
+			_sw_timer_heap_insert(module_inst, index);
+		} else {
+			/* One shot. */
+			handler->callback_enable = 0;
+		}
+		/* Enter critical section. */
+		handler->busy = 1;
+		/* Call callback function. It can enable or disable any timer. */
+		handler->callback(module_inst, index, handler->context, handler->period);
+		/* Leave critical section. */
+		handler->busy = 0;
+	}
+}
+
+uint32_t sw_timer_get_time(struct sw_timer_module *const module_inst)
+{
+	Assert(module_inst);
+
+	return _sw_timer_get_tick(module_inst) * module_inst->accuracy;
+}
+
+uint32_t sw_timer_get_next_deadline(struct sw_timer_module *const module_inst)
+{
+	int32_t remain;
+
+	Assert(module_inst);
+
+	if (module_inst->heap_count == 0) {
+		return SW_TIMER_NO_DEADLINE;
+	}
+
+	/* Callback is called when the tick after the expired time is started. */
+	remain = (int32_t)(module_inst->handler[module_inst->heap[0]].expire_time + 1 - _sw_timer_get_tick(module_inst));
+	if (remain <= 0) {
+		return 0;
+	}
+	return (uint32_t)remain * module_inst->accuracy;
+}
+
+uint64_t sw_timer_get_time_us(struct sw_timer_module *const module_inst)
+{
+#if defined(__linux__)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#elif (SAMD21)
+	uint64_t counts;
+
+	Assert(module_inst);
+
+	/* Divided in two steps to avoid the overflow of the multiplication. */
+	counts = _sw_timer_get_counts(module_inst);
+	return counts / module_inst->counter_hz * 1000000 +
+		(uint32_t)(counts % module_inst->counter_hz) * 1000000ULL / module_inst->counter_hz;
+#else
+	Assert(module_inst);
+
+	return (uint64_t)_sw_timer_get_tick(module_inst) * module_inst->accuracy * 1000;
+#endif
+}
+
+void sw_timer_sleep(struct sw_timer_module *const module_inst)
+{
+#if (SAMD21)
+	uint64_t counts, target;
+	uint32_t remain;
+
+	Assert(module_inst);
+
+	if (module_inst->tickless) {
+		remain = sw_timer_get_next_deadline(module_inst);
+		if (remain == 0) {
+			/* Timer was expired already. */
+			return;
+		}
+		if (remain != SW_TIMER_NO_DEADLINE) {
+			/* Wake up at the start of the millisecond in which the timer expires. */
+			counts = _sw_timer_get_counts(module_inst);
+			target = ((counts * 1000 / module_inst->counter_hz + remain) * module_inst->counter_hz + 999) / 1000;
+			if (target - counts > module_inst->counter_top / 2) {
+				/* Too far to distinguish from the wrapped value. It is programmed again after the wake up. */
+				target = counts + module_inst->counter_top / 2;
+			}
+			tcc_set_compare_value(&module_inst->tcc_inst,
+				(enum tcc_match_capture_channel)(TCC_MATCH_CAPTURE_CHANNEL_0 + module_inst->channel),
+				(uint32_t)(target % (module_inst->counter_top + 1)));
+			if (_sw_timer_get_counts(module_inst) >= target) {
+				/* Deadline was passed while the compare value was written. */
+				return;
 			}
 		}
 	}
+	system_sleep();
+#else
+	__DSB();
+	__WFI();
+#endif
 }
@@ -42,8 +42,15 @@
 extern "C" {
 #endif
 
+#if CONF_SW_TIMER_COUNT > 255
+#  error "CONF_SW_TIMER_COUNT must be less than 256."
+#endif
+
 struct sw_timer_module;
 
+/** Return value of \ref sw_timer_get_next_deadline when no timer is enabled. */
+#define SW_TIMER_NO_DEADLINE               0xFFFFFFFF
+
 /**
  * Callback Function type of time out event in the timer.
  *
@@ -67,6 +74,12 @@ struct sw_timer_config {
 	uint8_t tcc_callback_channel;
 	/** Accuracy of timer. If this value is increased, Timer can checks a long time. Unit is milliseconds*/
 	uint16_t accuracy;
+	/**
+	 * A flag that the timer runs without the periodic tick. (SAMD21 only)
+	 * The TCC runs as a free-running counter and its compare channel is programmed to the earliest deadline
+	 * in \ref sw_timer_sleep. The accuracy is ignored and the timer works in milliseconds.
+	 */
+	bool tickless;
 };
 
 /**
@@ -85,8 +98,10 @@ struct sw_timer_handle {
 	void *context;
 	/** Period of timer. If this value is set to zero, it means this timer operated once. */
 	uint32_t period;
-	/** Expired time of timer. */
+	/** Expired time of timer. The callback is called after the tick count passed this value. */
 	uint32_t expire_time;
+	/** Position of timer in the deadline heap. It is valid only if callback_enable is set. */
+	uint8_t heap_index;
 };
 
 /**
@@ -95,9 +110,24 @@ struct sw_timer_handle {
 struct sw_timer_module {
 	/** Timer handler instances. */
 	struct sw_timer_handle handler[CONF_SW_TIMER_COUNT];
+	/**
+	 * IDs of the enabled timers ordered by the expired time. (binary min-heap)
+	 * The first entry is the timer which expires first.
+	 */
+	uint8_t heap[CONF_SW_TIMER_COUNT];
+	/** Number of the enabled timers. */
+	uint8_t heap_count;
 #if (SAMD21)
 	/** Instance of TCC. */
 	struct tcc_module tcc_inst;
+	/** Top value of the TCC counter. */
+	uint32_t counter_top;
+	/** Frequency of the TCC counter in Hz. */
+	uint32_t counter_hz;
+	/** Channel of TCC which is used for the callback. */
+	uint8_t channel;
+	/** A flag that the timer runs in the tickless mode. */
+	uint8_t tickless;
 #endif
 	/** Accuracy of timer. */
 	uint32_t accuracy;
@@ -158,9 +188,12 @@ void sw_timer_unregister_callback(struct sw_timer_module *const module_inst, int
  *
  * Enables the callback function registered by the \ref sw_timer_register_callback.
  *
+ * The callback is called after at least delay milliseconds.
+ * If the callback is enabled already, It is restarted with the new delay.
+ *
  * \param[in]  module_inst     Pointer to USART software instance struct
  * \param[in]  timer_id        Timer ID .
- * \param[in]  delay           Initialization value of timer.
+ * \param[in]  delay           Time until the first callback. Unit is milliseconds.
  */
 void sw_timer_enable_callback(struct sw_timer_module *const module_inst, int timer_id, uint32_t delay);
 
@@ -178,11 +211,59 @@ void sw_timer_disable_callback(struct sw_timer_module *const module_inst, int ti
  * \brief Checks the time out of each timer handlers.
  *
  * This function must be called continuously for the checking the expiration of the timer handle.
+ * Only the timers which were expired are visited.
  *
  * \param[in]  module_inst     Pointer to USART software instance struct
  */
 void sw_timer_task(struct sw_timer_module *const module_inst);
 
+/**
+ * \brief Get the time since the timer was enabled.
+ *
+ * The resolution is the accuracy of the timer. It wraps around after 2^32 milliseconds.
+ *
+ * \param[in]  module_inst     Instance of the SW timer.
+ *
+ * \return     Elapsed time in milliseconds.
+ */
+uint32_t sw_timer_get_time(struct sw_timer_module *const module_inst);
+
+/**
+ * \brief Get the time until the earliest enabled timer expires.
+ *
+ * \param[in]  module_inst     Instance of the SW timer.
+ *
+ * \return     Remaining time in milliseconds. Zero if a timer was expired already.
+ * \return     SW_TIMER_NO_DEADLINE if no timer is enabled.
+ */
+uint32_t sw_timer_get_next_deadline(struct sw_timer_module *const module_inst);
+
+/**
+ * \brief Get the monotonic timestamp in microseconds for the instrumentation.
+ *
+ * On SAMD21, The tick or overflow count is combined with the current value of the TCC counter.
+ * So the resolution is one TCC count (64 / CPU clock) in both modes. Other devices fall back to the tick count.
+ * The host build reads CLOCK_MONOTONIC by clock_gettime, so the same code can be measured on Linux.
+ * It does not wrap around in practice and it can be called in the interrupt context.
+ *
+ * \param[in]  module_inst     Instance of the SW timer. It is not used in the host build.
+ *
+ * \return     Elapsed time in microseconds.
+ */
+uint64_t sw_timer_get_time_us(struct sw_timer_module *const module_inst);
+
+/**
+ * \brief Sleep until the next interrupt.
+ *
+ * In the tickless mode, The compare channel of the TCC is programmed to wake up the CPU at the earliest deadline.
+ * It returns immediately if a timer was expired already.
+ * Call it with the interrupts disabled after checking that no event is pending.
+ * The pending interrupt wakes up the CPU even if the interrupts are disabled.
+ *
+ * \param[in]  module_inst     Instance of the SW timer.
+ */
+void sw_timer_sleep(struct sw_timer_module *const module_inst);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,12 +49,15 @@ extern "C" {
 /** Content URI for download. */
 #define MAIN_HTTP_FILE_URL                   "https://ww1.microchip.com/downloads/en/DeviceDoc/70005266B.pdf"
 #define MAIN_HTTP_POST_URL                   "http://webhook.site/c6e036aa-d2e0-4b66-8559-5b5652982fa7"
-#define EXAMPLE_HTTP_FORM_DATA_CONTENT_TYPE			 "multipart/form-data; boundary=--------------------------698985598735098622010494"
-#define EXAMPLE_HTTP_FORM_URLENCODED_CONTENT_TYPE		"application/x-www-form-urlencoded"
-#define EXAMPLE_HTTP_CONTENT_BOUNDARY		 "----------------------------698985598735098622010494"
 
 /** Maximum size for packet buffer. */
 #define MAIN_BUFFER_MAX_SIZE                 (1446)
+/** Block size of the HTTP buffer pool. The send buffer (1400 bytes by default) also fits in the block of the receive buffer. */
+#define MAIN_HTTP_BUFFER_BLOCK_SIZE          MAIN_BUFFER_MAX_SIZE
+/** Block size of the HTTP string pool. It is the longest extension header of a request. */
+#define MAIN_HTTP_STRING_BLOCK_SIZE          (128)
+/** Number of the blocks in the HTTP string pool. */
+#define MAIN_HTTP_STRING_COUNT               (2)
 /** Maximum file name length. */
 #define MAIN_MAX_FILE_NAME_LENGTH            (250)
 /** Maximum file extension length. */
@@ -62,10 +65,6 @@ extern "C" {
 /** Output format with '0'. */
 #define MAIN_ZERO_FMT(SZ)                    (SZ == 4) ? "%04d" : (SZ == 3) ? "%03d" : (SZ == 2) ? "%02d" : "%d"
 
-#define VALUE_LEN_MAX 30
-#define KEY_LEN_MAX 30
-#define KEY_NUM_MAX 5
-
 //#define STORE_TO_NVM
 
 //#define TEST_HTTP_GET
@@ -76,6 +75,13 @@ extern "C" {
 #define STORE_TO_NVM
 #endif
 
+/** Number of the blocks in the HTTP buffer pool. The entry of the HTTP cache takes one more block. */
+#ifdef STORE_TO_NVM
+#define MAIN_HTTP_BUFFER_COUNT               (3)
+#else
+#define MAIN_HTTP_BUFFER_COUNT               (2)
+#endif
+
 typedef enum {
 	NOT_READY = 0, /*!< Not ready. */
 	STORAGE_READY = 0x01, /*!< Storage is ready. */
@@ -109,12 +109,18 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
 #include "asf.h"
 #include "main.h"
 #include "stdio_serial.h"
 #include "driver/include/m2m_wifi.h"
 #include "socket/include/socket.h"
 #include "iot/http/http_client.h"
+#include "iot/http/http_cache.h"
+#include "iot/http/http_multipart.h"
+#include "iot/http/http_form.h"
+#include "iot/http/http_pool.h"
+#include "iot/reactor.h"
 
 #define STRING_EOL                      "\r\n"
 #define STRING_HEADER                   "-- WINC1500 HTTP Client example --"STRING_EOL \
@@ -133,6 +139,14 @@ static uint32_t http_file_size = 0;
 static uint32_t received_file_size = 0;
 /** File name to download. */
 static char save_file_name[MAIN_MAX_FILE_NAME_LENGTH + 1] = "0:";
+/** ETag or Last-Modified of the file to download. It is used to resume the interrupted download. */
+static char resume_validator[HTTP_MAX_HEADER_VALUE_LENGTH];
+/** ETag of the file to download. It is stored in the cache index. */
+static char cache_etag[HTTP_MAX_HEADER_VALUE_LENGTH];
+/** Last-Modified of the file to download. It is stored in the cache index. */
+static char cache_last_modified[HTTP_MAX_HEADER_VALUE_LENGTH];
+/** Cache index of the downloaded files. */
+static struct http_cache_module http_cache_inst;
 
 /** UART module for debug. */
 static struct usart_module cdc_uart_module;
@@ -143,6 +157,16 @@ struct sw_timer_module swt_module_inst;
 /** Instance of HTTP client module. */
 struct http_client_module http_client_module_inst;
 
+/** Receive and send buffers of the HTTP client, and the entry of the HTTP cache. */
+static struct http_pool http_buffer_pool;
+static void *http_buffer_memory[HTTP_POOL_MEMORY_WORDS(MAIN_HTTP_BUFFER_BLOCK_SIZE, MAIN_HTTP_BUFFER_COUNT)];
+/** Extension headers of the HTTP requests. */
+static struct http_pool http_string_pool;
+static void *http_string_memory[HTTP_POOL_MEMORY_WORDS(MAIN_HTTP_STRING_BLOCK_SIZE, MAIN_HTTP_STRING_COUNT)];
+
+/** Instance of the reactor which dispatches all of the events. */
+static struct reactor_module reactor_inst;
+
 char http_url[100];
 /**
  * \brief Initialize download state to not ready.
@@ -168,6 +192,9 @@ static void clear_state(download_state mask)
 static void add_state(download_state mask)
 {
 	down_state |= mask;
+	if (mask & (COMPLETED | CANCELED)) {
+		reactor_stop(&reactor_inst);
+	}
 }
 
 /**
@@ -298,124 +325,59 @@ static void start_download(void)
 		return;
 	}
 
+	received_file_size = 0;
+	if (save_file_name[2] != '\0' && resume_validator[0] != '\0'
+			&& f_open(&file_object, (char const *)save_file_name, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+		/* Part of the file is on the SD card already. */
+		received_file_size = file_object.fsize;
+		f_close(&file_object);
+	}
+
+	if (received_file_size > 0) {
+		/* Request the rest of the file. If the file was changed on the server, The whole file is sent again. */
+		struct http_client_range range;
+		range.start = received_file_size;
+		range.length = 0;
+		range.validator = resume_validator;
+		printf("start_download: resuming from %lu bytes...\r\n", (unsigned long)received_file_size);
+		http_client_send_request_range(&http_client_module_inst, MAIN_HTTP_FILE_URL, HTTP_METHOD_GET, NULL, NULL, &range);
+		return;
+	}
+
 	/* Send the HTTP request. */
 	printf("start_download: sending HTTP request...\r\n");
 	http_client_send_request(&http_client_module_inst, MAIN_HTTP_FILE_URL, HTTP_METHOD_GET, NULL, NULL);
 }
 
-struct http_entity g_http_entity = {0,};
-struct http_entity *_example_http_set_default_entity(void);
-const char*			_example_http_get_contents_type(void *priv_data);
-int					_example_http_get_contents_length(void *priv_data);
-int					_example_http_read(void *priv_data, char *buffer, uint32_t size, uint32_t written);
-int					_example_http_read_file(void *priv_data, FIL* file, char *buffer, uint32_t size, uint32_t written);
-void				_example_http_close(void *priv_data);
-
-struct http_entity * _example_http_set_default_entity()
-{
-	memset(&g_http_entity, 0x00, sizeof(struct http_entity));
-	g_http_entity.close = _example_http_close;
-	g_http_entity.file_format = HTTP_FILE_FORMAT_NONE;
-	g_http_entity.is_chunked = 0;
-	g_http_entity.priv_data = NULL;
-	g_http_entity.read = _example_http_read;
-	g_http_entity.read_file = _example_http_read_file;
-	g_http_entity.get_contents_length = _example_http_get_contents_length;
-	g_http_entity.get_contents_type = _example_http_get_contents_type;
-	
-	return &g_http_entity;
-}
-
-const char* _example_http_get_contents_type(void *priv_data)
+/**
+ * \brief Reactor event which starts the file download.
+ * \param[in] module Instance of the reactor.
+ * \param[in] context Not used.
+ */
+static void start_download_event(struct reactor_module *const module, void *context)
 {
-	if (strstr(priv_data, EXAMPLE_HTTP_CONTENT_BOUNDARY) != NULL)
-		return (const char*)EXAMPLE_HTTP_FORM_DATA_CONTENT_TYPE;
-	else
-		return (const char*)EXAMPLE_HTTP_FORM_URLENCODED_CONTENT_TYPE;
+	start_download();
 }
 
-int _example_http_get_contents_length(void *priv_data)
-{
-	return strlen( (char*)priv_data);
-}
+/** Entity of the file upload. */
+static struct http_multipart upload_multipart;
 
-int _example_http_read(void *priv_data, char *buffer, uint32_t size, uint32_t written)
-{
-	int32_t length = 0;
-	
-	if(priv_data)
-	{
-		length = strlen( (char*)priv_data);
-		memcpy(buffer,(char*)priv_data, length);
-	}
-	
-	return length;
-}
+/** A flag that whether the random boundary generator was seeded or not. */
+static uint8_t upload_boundary_seeded;
 
-int _example_http_read_file(void *priv_data, FIL* file, char *buffer, uint32_t size, uint32_t written)
-{
-	int32_t length = 0;
-	unsigned byte_read = 0;
-	FRESULT res;
-	static read_length = 0;
-
-	memset(buffer, 0, size);
-	
-	if (file->fsize == read_length)
-	{
-		sprintf(buffer,"%s%s%s", "\r\n", EXAMPLE_HTTP_CONTENT_BOUNDARY, "--\r\n");
-		return strlen(buffer);
-	}
-	// send private data before the file data
-	if (read_length == 0)
-	{
-		length = strlen( (char*)priv_data);
-		memcpy(buffer,(char*)priv_data, length);
-		buffer += length;
-		size -= length;
-	}
-	
-	if ((file->fsize - read_length) == 0)
-		return 0;
-	
-	
-	
-	if ((file->fsize - read_length) >= size)
-		res = f_read(file, buffer, size, &byte_read);
-	else
-		res = f_read(file, buffer, file->fsize - read_length, &byte_read);
-		
-	if (res != FR_OK) {
-		printf("-E- f_read pb: 0x%X\n\r", res);
-		return 0;
-	}
-	
-	read_length += byte_read;
-	
-	if (length > 0)
-		byte_read += length;
-	
-	
-		
-	printf("file.fsize=%d\r\n", file->fsize);
-	printf("read_length=%d\r\n", read_length);
-	printf("byte_read=%d\r\n", byte_read);
-
-	return byte_read;
-}
-
-void _example_http_close(void *priv_data)
-{
-}
 /**
- * \brief Start file download via HTTP connection.
+ * \brief Start file upload via HTTP connection.
+ *
+ * \param[in] file_name     Path of the file to upload.
+ * \param[in] content_type  Content type of the file.
+ * \param[in] key           Name of the text field which is sent with the file.
+ * \param[in] value         Value of the text field.
  */
-char send_buf[400];
-static void start_upload_file(TCHAR* file_name, fileFormat file_format, char* key, char* value)
+static void start_upload_file(const char *file_name, const char *content_type, const char *key, const char *value)
 {
-	//TCHAR file_name[30] = "2014_09_15_01_33_29.fit";
-	FRESULT res;
-		
+	struct http_entity entity;
+	int ret;
+
 	if (!is_state_set(STORAGE_READY)) {
 		printf("start_upload_file: MMC storage not ready.\r\n");
 		return;
@@ -436,62 +398,62 @@ static void start_upload_file(TCHAR* file_name, fileFormat file_format, char* ke
 		return;
 	}
 
-	/* Send the HTTP request. */
-	printf("start_upload_file: sending HTTP request...\r\n");
-	
-	
-	
-	//sprintf(send_buf,"%s%s%s%s%s%s", EXAMPLE_HTTP_CONTENT_BOUNDARY,"\r\nContent-Disposition: form-data; name=\"memberid\"\r\n\r\n", "RXtYOSoAZk36u9kOxIN+sQ==\r\n", EXAMPLE_HTTP_CONTENT_BOUNDARY, "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"test.txt\"\r\n", "Content-Type: application/octet-stream\r\n\r\n");
-	
-	if (file_format == HTTP_FILE_FORMAT_NONE)
-		sprintf(send_buf,"%s%s%s%s%s%s%s", EXAMPLE_HTTP_CONTENT_BOUNDARY, "\r\nContent-Disposition: form-data; name=\"", key, "\"\r\n\r\n", value, "\r\n", EXAMPLE_HTTP_CONTENT_BOUNDARY);
-	else if (file_format == HTTP_FILE_FORMAT_FIT)
-		sprintf(send_buf,"%s%s%s%s%s%s%s", EXAMPLE_HTTP_CONTENT_BOUNDARY, "\r\nContent-Disposition: form-data; name=\"", key, "\"; filename=\"", file_name, "\"\r\n", "Content-Type: application/octet-stream\r\n\r\n");
-	else
-		sprintf(send_buf,"%s%s%s%s%s%s%s", EXAMPLE_HTTP_CONTENT_BOUNDARY, "\r\nContent-Disposition: form-data; name=\"", key, "\"; filename=\"", file_name, "\"\r\n", "Content-Type: text/plain\r\n\r\n");
-	
-	struct http_entity * entity = _example_http_set_default_entity();	
-	entity->file_format = file_format;
-	entity->priv_data = (void*)send_buf;
-	//printf("send_buf=%s, len=%d\r\n", entity->priv_data, strlen(entity->priv_data));
-	
-	if (file_format != HTTP_FILE_FORMAT_NONE)
-	{
-		res = f_open(&entity->file_object, (char const *)file_name,
-		FA_OPEN_EXISTING | FA_READ);
-		if (res != FR_OK) {
-			printf("-E- f_open read pb: 0x%X\n\r", res);
-			return 0;
-		}
+	if (!upload_boundary_seeded) {
+		/* Time to the first upload depends on the Wi-Fi connection, so the boundary differs in each boot. */
+		srand((unsigned int)sw_timer_get_time_us(&swt_module_inst));
+		upload_boundary_seeded = 1;
 	}
-	
-	http_client_send_request(&http_client_module_inst, MAIN_HTTP_POST_URL, HTTP_METHOD_POST, entity, NULL);
+	http_multipart_init(&upload_multipart);
+	http_multipart_add_field(&upload_multipart, key, value);
+	ret = http_multipart_add_file(&upload_multipart, "file", file_name, NULL, content_type);
+	if (ret < 0) {
+		printf("start_upload_file: file is not found! (res %d)\r\n", ret);
+		return;
+	}
+	http_multipart_get_entity(&upload_multipart, &entity);
+
+	/* Send the HTTP request. */
+	printf("start_upload_file: sending HTTP request... (%lu bytes)\r\n", (unsigned long)http_multipart_get_length(&upload_multipart));
+	http_client_send_request(&http_client_module_inst, MAIN_HTTP_POST_URL, HTTP_METHOD_POST, &entity, NULL);
 }
 
 
-static void prepare_url_parameter(char para_name[KEY_NUM_MAX][VALUE_LEN_MAX], char para_val[KEY_NUM_MAX][VALUE_LEN_MAX], int para_num)
-{
-	char para_str[60];
-	memset(para_str, 0 , sizeof(para_str));
-	int i= 0;
+/** Entity of the posted form. */
+static struct http_form post_form;
 
-	for (i=0; i< para_num; i++)
-	{
-		if (i>0)
-			sprintf(para_str,"%s&",para_str);
-		sprintf(para_str,"%s%s=%s", para_str, &para_name[i], &para_val[i]);
+/**
+ * \brief Make the URL which has the fields as the query string.
+ *
+ * \param[in] fields        Fields of the query.
+ * \param[in] field_count   Number of the fields.
+ */
+static void prepare_url_parameter(const struct http_form_field *fields, uint16_t field_count)
+{
+	struct http_form query;
+	int length;
+
+	strcpy(http_url, MAIN_HTTP_POST_URL);
+	length = strlen(http_url);
+	http_form_init(&query, fields, field_count);
+	if (field_count > 0) {
+		http_url[length++] = '?';
+		if (http_form_write(&query, http_url + length, sizeof(http_url) - length) < 0) {
+			/* Query does not fit in the URL. */
+			http_url[length - 1] = '\0';
+		}
 	}
-	sprintf(http_url,"%s?%s", MAIN_HTTP_POST_URL, para_str);
 	printf("http_url = %s\r\n", http_url);
 }
 
-char body_str[KEY_NUM_MAX* (KEY_LEN_MAX + VALUE_LEN_MAX)];
-
-static void start_post_data(char key[KEY_NUM_MAX][KEY_LEN_MAX], char value[KEY_NUM_MAX][VALUE_LEN_MAX], int key_num)
+/**
+ * \brief Post the form via HTTP connection.
+ *
+ * \param[in] fields        Fields of the form. The array is used until the request is sent.
+ * \param[in] field_count   Number of the fields.
+ */
+static void start_post_data(const struct http_form_field *fields, uint16_t field_count)
 {
-	FRESULT res;
-	int i = 0;
-	
+	struct http_entity entity;
 
 	if (!is_state_set(WIFI_CONNECTED)) {
 		printf("start_post_data: Wi-Fi is not connected.\r\n");
@@ -507,46 +469,32 @@ static void start_post_data(char key[KEY_NUM_MAX][KEY_LEN_MAX], char value[KEY_N
 		printf("start_post_data: running download already.\r\n");
 		return;
 	}
-	
+
 	/* Send the HTTP request. */
 	printf("start_post_data: sending HTTP request...\r\n");
-	
-	if (key_num > 0)
-	{
-		for (i=0; i< key_num; i++)
-		{
-			if (i>0)
-			sprintf(body_str,"%s&",body_str);
-			sprintf(body_str,"%s%s=%s", body_str, &key[i], &value[i]);
-		}
 
-		struct http_entity * entity = _example_http_set_default_entity();
-		entity->priv_data = (void*)body_str;
-		//printf("send_buf=%s, len=%d\r\n", entity->priv_data, strlen(entity->priv_data));
-		
-		http_client_send_request(&http_client_module_inst, http_url, HTTP_METHOD_POST, entity, NULL);
-	}
-	else
-	{
+	if (field_count > 0) {
+		http_form_init(&post_form, fields, field_count);
+		http_form_get_entity(&post_form, &entity);
+		http_client_send_request(&http_client_module_inst, http_url, HTTP_METHOD_POST, &entity, NULL);
+	} else {
 		http_client_send_request(&http_client_module_inst, http_url, HTTP_METHOD_POST, NULL, NULL);
 	}
-	
 }
 
 /**
- * \brief Store received packet to file.
- * \param[in] data Packet data.
- * \param[in] length Packet data length.
+ * \brief Open the file to store the download.
+ *
+ * If received_file_size is zero, The file is created or truncated.
+ * Otherwise, The received data is appended to the partially downloaded file.
+ *
+ * \return true if the file was opened, false otherwise.
  */
-static void store_file_packet(char *data, uint32_t length)
+static bool open_download_file(void)
 {
 	FRESULT ret;
-	if ((data == NULL) || (length < 1)) {
-		printf("store_file_packet: empty data.\r\n");
-		return;
-	}
 
-	if (!is_state_set(DOWNLOADING)) {
+	if (save_file_name[2] == '\0') {
 		char *cp = NULL;
 		save_file_name[0] = LUN_ID_SD_MMC_0_MEM + '0';
 		save_file_name[1] = ':';
@@ -560,18 +508,74 @@ static void store_file_packet(char *data, uint32_t length)
 		} else {
 			printf("store_file_packet: file name is invalid. Download canceled.\r\n");
 			add_state(CANCELED);
-			return;
+			return false;
 		}
 
 		rename_to_unique(&file_object, save_file_name, MAIN_MAX_FILE_NAME_LENGTH);
+	}
+
+	if (received_file_size == 0) {
 		printf("store_file_packet: creating file [%s]\r\n", save_file_name);
 		ret = f_open(&file_object, (char const *)save_file_name, FA_CREATE_ALWAYS | FA_WRITE);
-		if (ret != FR_OK) {
-			printf("store_file_packet: file creation error! ret:%d\r\n", ret);
-			return;
+	} else {
+		printf("store_file_packet: appending to file [%s] from %lu\r\n", save_file_name, (unsigned long)received_file_size);
+		ret = f_open(&file_object, (char const *)save_file_name, FA_OPEN_EXISTING | FA_WRITE);
+		if (ret == FR_OK) {
+			ret = f_lseek(&file_object, received_file_size);
+			if (ret != FR_OK) {
+				f_close(&file_object);
+			}
 		}
+	}
+	if (ret != FR_OK) {
+		printf("store_file_packet: file creation error! ret:%d\r\n", ret);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Record the downloaded file in the cache index.
+ *
+ * The next download of the same URL sends the conditional request,
+ * And the file is not downloaded again if it was not modified on the server.
+ */
+static void update_download_cache(void)
+{
+	int ret;
+
+	if (cache_etag[0] == '\0' && cache_last_modified[0] == '\0') {
+		/* File can not be validated. Previous entry is dropped. */
+		http_cache_remove(&http_cache_inst, MAIN_HTTP_FILE_URL);
+		return;
+	}
+
+	ret = http_cache_store(&http_cache_inst, MAIN_HTTP_FILE_URL,
+			(cache_etag[0] != '\0') ? cache_etag : NULL,
+			(cache_last_modified[0] != '\0') ? cache_last_modified : NULL,
+			save_file_name, received_file_size);
+	if (ret < 0) {
+		printf("update_download_cache: file is not cached! (res %d)\r\n", ret);
+	}
+}
+
+/**
+ * \brief Store received packet to file.
+ * \param[in] data Packet data.
+ * \param[in] length Packet data length.
+ */
+static void store_file_packet(char *data, uint32_t length)
+{
+	FRESULT ret;
+	if ((data == NULL) || (length < 1)) {
+		printf("store_file_packet: empty data.\r\n");
+		return;
+	}
 
-		received_file_size = 0;
+	if (!is_state_set(DOWNLOADING)) {
+		if (!open_download_file()) {
+			return;
+		}
 		add_state(DOWNLOADING);
 	}
 
@@ -590,6 +594,7 @@ static void store_file_packet(char *data, uint32_t length)
 		if (received_file_size >= http_file_size) {
 			f_close(&file_object);
 			printf("store_file_packet: file downloaded successfully.\r\n");
+			update_download_cache();
 			port_pin_set_output_level(LED_0_PIN, false);
 			add_state(COMPLETED);
 			return;
@@ -621,13 +626,48 @@ static void http_client_callback(struct http_client_module *module_inst, int typ
 				(unsigned int)data->recv_response.response_code,
 				(unsigned int)data->recv_response.content_length);
 		if ((unsigned int)data->recv_response.response_code == 200) {
+			/* Whole file is sent. The partially downloaded file is overwritten. */
 			http_file_size = data->recv_response.content_length;
 			received_file_size = 0;
-		} 
-		else {
+		} else if ((unsigned int)data->recv_response.response_code == 206
+				&& received_file_size > 0 && data->recv_response.range_start == received_file_size) {
+			/* Rest of the file is sent. */
+			if (data->recv_response.total_length > 0) {
+				http_file_size = data->recv_response.total_length;
+			} else {
+				http_file_size = received_file_size + data->recv_response.content_length;
+			}
+		} else if ((unsigned int)data->recv_response.response_code == 416
+				&& received_file_size > 0 && data->recv_response.total_length == received_file_size) {
+			/* Connection was lost after the whole file was stored. */
+			printf("http_client_callback: file downloaded successfully.\r\n");
+			add_state(COMPLETED);
+			return;
+		} else if ((unsigned int)data->recv_response.response_code == 304
+				&& data->recv_response.cache_path != NULL) {
+			/* File was not modified since the last download. */
+			strcpy(save_file_name, data->recv_response.cache_path);
+			printf("http_client_callback: file is not modified. [%s] is used.\r\n", save_file_name);
+			add_state(COMPLETED);
+			return;
+		} else {
 			add_state(CANCELED);
 			return;
 		}
+		if (data->recv_response.validator != NULL) {
+			strcpy(resume_validator, data->recv_response.validator);
+		} else {
+			/* Resuming is not safe without the validator. */
+			resume_validator[0] = '\0';
+		}
+		cache_etag[0] = '\0';
+		if (data->recv_response.etag != NULL) {
+			strcpy(cache_etag, data->recv_response.etag);
+		}
+		cache_last_modified[0] = '\0';
+		if (data->recv_response.last_modified != NULL) {
+			strcpy(cache_last_modified, data->recv_response.last_modified);
+		}
 /*		
 		if (data->recv_response.content_length > 0)
 		{
@@ -663,8 +703,11 @@ static void http_client_callback(struct http_client_module *module_inst, int typ
 		 * It means the server has closed the connection (timeout).
 		 * This is normal operation.
 		 */
-		if (data->disconnected.reason == -EAGAIN) {
-			/* Server has not responded. Retry immediately. */
+		if (data->disconnected.reason == -EAGAIN
+				|| (is_state_set(DOWNLOADING) && !is_state_set(COMPLETED) && !is_state_set(CANCELED))) {
+			/* Server has not responded or the connection was lost during the download.
+			 * Retry immediately. The part of the file which was stored already is not requested again.
+			 */
 			if (is_state_set(DOWNLOADING)) {
 				f_close(&file_object);
 				clear_state(DOWNLOADING);
@@ -674,7 +717,8 @@ static void http_client_callback(struct http_client_module *module_inst, int typ
 				clear_state(GET_REQUESTED);
 			}
 
-			start_download();
+			/* Module is still closing the connection. Request again after this callback. */
+			reactor_post(&reactor_inst, start_download_event, NULL);
 		}
 
 		break;
@@ -719,6 +763,32 @@ static void resolve_cb(uint8_t *pu8DomainName, uint32_t u32ServerIP)
 	http_client_socket_resolve_handler(pu8DomainName, u32ServerIP);
 }
 
+/**
+ * \brief Reactor event which sends the request of the selected test.
+ * \param[in] module Instance of the reactor.
+ * \param[in] context Not used.
+ */
+static void start_test_event(struct reactor_module *const module, void *context)
+{
+#if defined(TEST_HTTP_GET)
+	start_download();
+#elif defined(TEST_HTTP_POST_FILE)
+
+	//start_upload_file("test.fit", NULL, "key1", "value1");
+	start_upload_file("test.txt", "text/plain", "key1", "value1");
+	
+#else		// TEST_HTTP_POST_VALUE
+	
+	static const struct http_form_field fields[] = {
+		{"key1", "value1"},
+		{"key2", "value2"},
+	};
+
+	prepare_url_parameter(fields, sizeof(fields) / sizeof(fields[0]));
+	start_post_data(fields, sizeof(fields) / sizeof(fields[0]));
+#endif
+}
+
 /**
  * \brief Callback to get the Wi-Fi status update.
  *
@@ -778,29 +848,8 @@ static void wifi_cb(uint8_t u8MsgType, void *pvMsg)
 		printf("wifi_cb: IP address is %u.%u.%u.%u\r\n",
 				pu8IPAddress[0], pu8IPAddress[1], pu8IPAddress[2], pu8IPAddress[3]);
 		add_state(WIFI_CONNECTED);
-		
-#if defined(TEST_HTTP_GET)
-		start_download();
-#elif defined(TEST_HTTP_POST_FILE)
-
-		//start_upload_file(NULL, HTTP_FILE_FORMAT_NONE, "key1", "value1");
-		//start_upload_file("test.fit", HTTP_FILE_FORMAT_FIT, "key1", "value1");
-		start_upload_file("test.txt", HTTP_FILE_FORMAT_TXT, "key1", "value1");
-		
-#else		// TEST_HTTP_POST_VALUE
-		
-		char name[2][VALUE_LEN_MAX];
-		char value[2][VALUE_LEN_MAX];
-		
-		strcpy(&name[0], "key1");
-		strcpy(&value[0], "value1");
-		strcpy(&name[1], "key2");
-		strcpy(&value[1], "value2");
-		
-		prepare_url_parameter(&name, &value, 2);
-		start_post_data(&name, &value, 2);
-#endif
-
+		/* Request is sent after the WINC event is handled. */
+		reactor_post(&reactor_inst, start_test_event, NULL);
 		break;
 	}
 
@@ -814,8 +863,10 @@ static void wifi_cb(uint8_t u8MsgType, void *pvMsg)
  */
 static void init_storage(void)
 {
+	struct http_cache_config cache_conf;
 	FRESULT res;
 	Ctrl_status status;
+	int ret;
 
 	/* Initialize SD/MMC stack. */
 	sd_mmc_init();
@@ -843,6 +894,13 @@ static void init_storage(void)
 
 		printf("init_storage: SD card mount OK.\r\n");
 		add_state(STORAGE_READY);
+
+		/* Open the cache index. Files which were downloaded before are validated with it. */
+		http_cache_get_config_defaults(&cache_conf);
+		ret = http_cache_init(&http_cache_inst, &cache_conf);
+		if (ret < 0) {
+			printf("init_storage: cache index is not available. (res %d)\r\n", ret);
+		}
 		return;
 	}
 }
@@ -873,11 +931,26 @@ static void configure_timer(void)
 {
 	struct sw_timer_config swt_conf;
 	sw_timer_get_config_defaults(&swt_conf);
+	/* Wake up only for the deadlines. Timeouts are also measured in milliseconds. */
+	swt_conf.tickless = true;
 
 	sw_timer_init(&swt_module_inst, &swt_conf);
 	sw_timer_enable(&swt_module_inst);
 }
 
+/**
+ * \brief Configure the reactor.
+ */
+static void configure_reactor(void)
+{
+	struct reactor_config reactor_conf;
+
+	reactor_get_config_defaults(&reactor_conf);
+	reactor_conf.timer_inst = &swt_module_inst;
+
+	reactor_init(&reactor_inst, &reactor_conf);
+}
+
 /**
  * \brief Configure HTTP client module.
  */
@@ -888,8 +961,18 @@ static void configure_http_client(void)
 
 	http_client_get_config_defaults(&httpc_conf);
 
+	/* Buffers and the strings of each request are not allocated in the heap. */
+	http_pool_init(&http_buffer_pool, http_buffer_memory, MAIN_HTTP_BUFFER_BLOCK_SIZE, MAIN_HTTP_BUFFER_COUNT);
+	http_pool_init(&http_string_pool, http_string_memory, MAIN_HTTP_STRING_BLOCK_SIZE, MAIN_HTTP_STRING_COUNT);
+	httpc_conf.buffer_pool = &http_buffer_pool;
+	httpc_conf.string_pool = &http_string_pool;
+
 	httpc_conf.recv_buffer_size = MAIN_BUFFER_MAX_SIZE;
 	httpc_conf.timer_inst = &swt_module_inst;
+#ifdef STORE_TO_NVM
+	/* Index is opened after the SD card is mounted. Until then, No request is conditional. */
+	httpc_conf.cache = &http_cache_inst;
+#endif
 
 	ret = http_client_init(&http_client_module_inst, &httpc_conf);
 	if (ret < 0) {
@@ -925,6 +1008,9 @@ int main(void)
 	/* Initialize the Timer. */
 	configure_timer();
 
+	/* Initialize the reactor. */
+	configure_reactor();
+
 	/* Initialize the HTTP client service. */
 	configure_http_client();
 
@@ -956,12 +1042,13 @@ int main(void)
 	printf("main: connecting to WiFi AP %s...\r\n", (char *)MAIN_WLAN_SSID);
 	m2m_wifi_connect((char *)MAIN_WLAN_SSID, sizeof(MAIN_WLAN_SSID), MAIN_WLAN_AUTH, (char *)MAIN_WLAN_PSK, M2M_WIFI_CH_ALL);
 
-	while (!(is_state_set(COMPLETED) || is_state_set(CANCELED))) {
-		/* Handle pending events from network controller. */
-		m2m_wifi_handle_events(NULL);
-		/* Checks the timer timeout. */
-		sw_timer_task(&swt_module_inst);
-	}
+	/* Dispatch the WINC, timer and posted events until the test is completed or canceled. */
+	reactor_run(&reactor_inst);
+	/* Latency of the requests which were sent. */
+	http_client_print_timing(&http_client_module_inst);
+	/* High-water marks of the pools. */
+	http_pool_print_stats(&http_buffer_pool, "http_buffer_pool");
+	http_pool_print_stats(&http_string_pool, "http_string_pool");
 #ifdef STORE_TO_NVM
 	printf("main: please unplug the SD/MMC card.\r\n");
 #endif
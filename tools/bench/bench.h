@@ -0,0 +1,150 @@
+/**
+ * \file
+ *
+ * \brief Common part of the host benchmarks.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "socket/include/socket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Counters of the fake WINC socket.
+ */
+struct fake_winc_stats {
+	/** Number of the connect calls. */
+	uint32_t connects;
+	/** Number of the send calls which were accepted. */
+	uint32_t sends;
+	/** Number of the bytes which were accepted by send. */
+	uint64_t sent_bytes;
+	/** Number of the send calls which were rejected with SOCK_ERR_BUFFER_FULL. */
+	uint32_t buffer_full;
+};
+
+/** Counters of the fake socket. They are cleared by \ref fake_winc_reset. */
+extern struct fake_winc_stats fake_winc_stats;
+
+/**
+ * Number of the packets which can be sent before the completions are delivered.
+ * The send beyond it returns SOCK_ERR_BUFFER_FULL like the WINC.
+ */
+extern int fake_winc_send_capacity;
+
+/**
+ * Buffer which receives the sent data, or NULL to discard it.
+ * The data is written from the start after \ref fake_winc_reset.
+ */
+extern char *fake_winc_capture;
+/** Size of \ref fake_winc_capture. */
+extern size_t fake_winc_capture_size;
+/** Number of the bytes in \ref fake_winc_capture. */
+extern size_t fake_winc_captured;
+
+/** Server which receives the data of each send with its socket, or NULL. */
+extern void (*fake_winc_server)(SOCKET sock, const char *data, size_t length);
+
+/**
+ * \brief Clear the counters, the captured data and the pending completions.
+ *
+ * Sockets are kept open, because the connection pool of the HTTP client can still hold them.
+ */
+void fake_winc_reset(void);
+
+/**
+ * \brief Complete the pending connects.
+ */
+void fake_winc_complete_connects(void);
+
+/**
+ * \brief Deliver the completions of the packets which were sent before this call.
+ *
+ * Packets which are sent from the completion callbacks are completed in the next call,
+ * so a call is one round trip of the link. It is same as \ref m2m_wifi_handle_events.
+ *
+ * \return    Number of the completions which were delivered.
+ */
+int fake_winc_complete_sends(void);
+
+/**
+ * \brief Deliver the data from the server.
+ *
+ * The data is divided by the fragment size and the size of the buffer which was passed to recv.
+ *
+ * \return    Number of the bytes which were delivered. It is short if the client stopped receiving.
+ */
+size_t fake_winc_feed(SOCKET sock, const char *data, size_t length, size_t fragment);
+
+/**
+ * \brief Close the connection from the server. The pending recv fails with SOCK_ERR_CONN_ABORTED.
+ */
+void fake_winc_disconnect(SOCKET sock);
+
+/**
+ * \brief Close all of the open connections from the server.
+ */
+void fake_winc_disconnect_all(void);
+
+/**
+ * \brief Monotonic time in nanoseconds.
+ */
+static inline uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief CPU cycle counter, or 0 on the host which does not have it.
+ */
+static inline uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return 0;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H_INCLUDED */
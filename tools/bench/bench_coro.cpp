@@ -0,0 +1,264 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the coroutine wrapper of the HTTP client.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Same keep-alive GET requests are handled by the callback of the HTTP client and by the coroutine.
+ * Both are driven by the same reactor iterations, so the difference is the cost of the coroutine.
+ * The resume through the reactor is also compared with the direct resume and the plain function call.
+ */
+#include "iot/http/http_client_coro.hpp"
+#include "bench.h"
+#include <cstdio>
+#include <cstring>
+
+/** Number of the requests for each case. */
+#define BENCH_REQUESTS           200000
+/** Number of the resumes for each case. */
+#define BENCH_RESUMES            10000000
+/** Size of the receive buffer of the client. */
+#define BENCH_RECV_BUFFER_SIZE   1460
+
+static struct http_client_module http_client_module_inst;
+static struct sw_timer_module swt_module_inst;
+static struct reactor_module reactor_inst;
+static char entity_buffer[BENCH_RECV_BUFFER_SIZE];
+static char response[512];
+static size_t response_length;
+static uint32_t body_length;
+static uint32_t responses;
+static uint32_t body_bytes;
+
+static const char url[] = "http://127.0.0.1/api/v1/status";
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+	if (type == HTTP_CLIENT_CALLBACK_RECV_RESPONSE && data->recv_response.response_code == 200) {
+		responses++;
+		body_bytes += data->recv_response.content_length;
+	}
+}
+
+static iot::task requests(uint32_t count)
+{
+	iot::http_client client(&http_client_module_inst, &reactor_inst, entity_buffer, sizeof(entity_buffer));
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (co_await client.send_request(url) < 0) {
+			co_return;
+		}
+		auto resp = co_await client.response();
+		if (resp.result < 0 || resp.response_code != 200) {
+			co_return;
+		}
+		responses++;
+		for (;;) {
+			auto chunk = co_await client.read_body_chunk();
+			if (chunk.result < 0) {
+				co_return;
+			}
+			body_bytes += chunk.length;
+			if (chunk.last) {
+				break;
+			}
+		}
+	}
+}
+
+static int init_client(void)
+{
+	struct http_client_config httpc_conf;
+	struct reactor_config reactor_conf;
+
+	reactor_get_config_defaults(&reactor_conf);
+	reactor_conf.timer_inst = &swt_module_inst;
+	reactor_conf.sleep = false;
+	if (reactor_init(&reactor_inst, &reactor_conf) < 0) {
+		return -1;
+	}
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.recv_buffer_size = BENCH_RECV_BUFFER_SIZE;
+	httpc_conf.timer_inst = &swt_module_inst;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		return -1;
+	}
+	fake_winc_reset();
+	responses = 0;
+	body_bytes = 0;
+	return 0;
+}
+
+/* One request: connect or reuse, send, receive the response. The coroutine sends the next request by itself. */
+static void run_request(bool callback)
+{
+	if (callback) {
+		http_client_send_request(&http_client_module_inst, url, HTTP_METHOD_GET, NULL, NULL);
+	}
+	fake_winc_complete_connects();
+	/* Completes the send and delivers REQUESTED. */
+	reactor_run_once(&reactor_inst);
+	fake_winc_feed(http_client_module_inst.sock, response, response_length, BENCH_RECV_BUFFER_SIZE);
+	/* Posted resumes of the response. */
+	reactor_run_once(&reactor_inst);
+}
+
+static int run_requests(bool callback)
+{
+	uint64_t ns;
+	uint32_t i;
+
+	if (init_client() < 0) {
+		std::printf("init failed\n");
+		return 1;
+	}
+	ns = bench_now_ns();
+	if (callback) {
+		http_client_register_callback(&http_client_module_inst, http_client_callback);
+	} else if (!requests(BENCH_REQUESTS)) {
+		std::printf("coroutine    frame of %u bytes does not fit CONF_HTTP_CORO_FRAME_SIZE (%u)\n",
+			iot::frame_pool::stats().largest, (unsigned)CONF_HTTP_CORO_FRAME_SIZE);
+		http_client_deinit(&http_client_module_inst);
+		return 1;
+	}
+	for (i = 0; i < BENCH_REQUESTS; i++) {
+		run_request(callback);
+	}
+	ns = bench_now_ns() - ns;
+	http_client_deinit(&http_client_module_inst);
+
+	if (responses != BENCH_REQUESTS || body_bytes != BENCH_REQUESTS * body_length || fake_winc_stats.connects > 1
+		|| iot::frame_pool::stats().used != 0) {
+		std::printf("%-12s FAILED (%lu of %lu responses, %lu connects)\n", callback ? "callback" : "coroutine",
+			(unsigned long)responses, (unsigned long)BENCH_REQUESTS, (unsigned long)fake_winc_stats.connects);
+		return 1;
+	}
+	std::printf("%-12s %9.0f ns/request\n", callback ? "callback" : "coroutine", (double)ns / BENCH_REQUESTS);
+	return 0;
+}
+
+static std::coroutine_handle<> suspended;
+static uint32_t counter;
+
+struct suspend_here {
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+	void await_suspend(std::coroutine_handle<> handle) noexcept
+	{
+		suspended = handle;
+	}
+	void await_resume() const noexcept
+	{
+	}
+};
+
+static iot::task resumes(uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		co_await suspend_here{};
+		counter++;
+	}
+}
+
+static void __attribute__((noinline)) count_event(struct reactor_module *const, void *context)
+{
+	(*static_cast<uint32_t *>(context))++;
+}
+
+static int run_resumes(void)
+{
+	static const char *const names[] = {"function", "resume", "reactor post", "reactor call"};
+	void (*volatile handler)(struct reactor_module *const, void *) = count_event;
+	uint64_t ns;
+	uint32_t i;
+	int fails = 0;
+
+	for (int mode = 0; mode < 4; mode++) {
+		counter = 0;
+		if (mode == 1 || mode == 2) {
+			if (!resumes(BENCH_RESUMES)) {
+				return 1;
+			}
+		}
+		ns = bench_now_ns();
+		for (i = 0; i < BENCH_RESUMES; i++) {
+			switch (mode) {
+			case 0:
+				handler(&reactor_inst, &counter);
+				break;
+			case 1:
+				suspended.resume();
+				break;
+			case 2:
+				iot::resume_later(&reactor_inst, suspended);
+				reactor_run_once(&reactor_inst);
+				break;
+			default:
+				reactor_post(&reactor_inst, handler, &counter);
+				reactor_run_once(&reactor_inst);
+				break;
+			}
+		}
+		ns = bench_now_ns() - ns;
+		if (counter != BENCH_RESUMES || iot::frame_pool::stats().used != 0) {
+			std::printf("%-12s FAILED\n", names[mode]);
+			fails++;
+			continue;
+		}
+		std::printf("%-12s %9.1f ns\n", names[mode], (double)ns / BENCH_RESUMES);
+	}
+	return fails;
+}
+
+int main(void)
+{
+	static const char body[] = "{\"status\":\"ok\",\"uptime\":123456,\"free\":8192,\"rssi\":-61,\"ver\":1}";
+	int fails = 0;
+
+	body_length = sizeof(body) - 1;
+	response_length = std::sprintf(response,
+		"HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\nConnection: keep-alive\r\n\r\n%s",
+		(unsigned)body_length, body);
+
+	fails += run_requests(true);
+	fails += run_requests(false);
+	fails += run_resumes();
+
+	const iot::frame_pool_stats &stats = iot::frame_pool::stats();
+	std::printf("frame %u bytes (CONF_HTTP_CORO_FRAME_SIZE %u), peak %u of %u frames, %lu failed\n",
+		stats.largest, (unsigned)CONF_HTTP_CORO_FRAME_SIZE, stats.peak, (unsigned)CONF_HTTP_CORO_FRAME_COUNT,
+		(unsigned long)stats.failed);
+	std::printf("iot::http_client %lu bytes, iot::timer %lu bytes\n",
+		(unsigned long)sizeof(iot::http_client), (unsigned long)sizeof(iot::timer));
+	return fails;
+}
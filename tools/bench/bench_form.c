@@ -0,0 +1,154 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the form encoder.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Forms of 10 to 1000 fields are encoded through the entity interface in the packet size
+ * of the HTTP client and in small reads, and into one buffer with http_form_write.
+ * Plain values and values which need percent-encoding are measured separately.
+ */
+#include "iot/http/http_form.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Encoded bytes for each case. */
+#define BENCH_BYTES_PER_CASE     (32 * 1024 * 1024)
+/** Largest number of the fields. */
+#define BENCH_MAX_FIELDS         1000
+
+static struct http_form_field fields[BENCH_MAX_FIELDS];
+static char names[BENCH_MAX_FIELDS][16];
+static char values[BENCH_MAX_FIELDS][48];
+static char expected[BENCH_MAX_FIELDS * 200];
+static char buffer[BENCH_MAX_FIELDS * 200];
+
+static void make_fields(int count, int escaped)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		sprintf(names[i], "sensor%d", i);
+		if (escaped) {
+			sprintf(values[i], "t=%d.%d C; rh=%d%% & \"ok\"/%d", 20 + i % 10, i % 10, 40 + i % 50, i);
+		} else {
+			sprintf(values[i], "%d.%d", 20 + i % 10, i % 10);
+		}
+		fields[i].name = names[i];
+		fields[i].value = values[i];
+	}
+}
+
+/* Read the whole entity in reads of the size. Returns the encoded size, or -1 if the data is wrong. */
+static int read_entity(struct http_entity *entity, uint32_t size, int length)
+{
+	int written = 0, ret;
+
+	while (written < length) {
+		ret = entity->read(entity->priv_data, buffer + written, size, written);
+		if (ret <= 0) {
+			return -1;
+		}
+		written += ret;
+	}
+	if (memcmp(buffer, expected, length) != 0) {
+		return -1;
+	}
+	return written;
+}
+
+static int run(int count, int escaped)
+{
+	static const uint32_t read_sizes[] = {1460, 64};
+	struct http_form form;
+	struct http_entity entity;
+	uint32_t iterations, i, j;
+	uint64_t ns;
+	double mbps[3], length_ns;
+	int length;
+
+	make_fields(count, escaped);
+	http_form_init(&form, fields, count);
+	length = http_form_write(&form, expected, sizeof(expected));
+	if (length < 0 || (uint32_t)length != http_form_get_length(&form)) {
+		printf("%6d %-7s FAILED\n", count, escaped ? "escaped" : "plain");
+		return 1;
+	}
+	iterations = BENCH_BYTES_PER_CASE / length + 1;
+
+	ns = bench_now_ns();
+	for (i = 0; i < iterations; i++) {
+		if (http_form_get_length(&form) != (uint32_t)length) {
+			return 1;
+		}
+	}
+	length_ns = (double)(bench_now_ns() - ns) / iterations;
+
+	for (j = 0; j < sizeof(read_sizes) / sizeof(read_sizes[0]); j++) {
+		http_form_get_entity(&form, &entity);
+		ns = bench_now_ns();
+		for (i = 0; i < iterations; i++) {
+			if (read_entity(&entity, read_sizes[j], length) != length) {
+				printf("%6d %-7s read %lu FAILED\n", count, escaped ? "escaped" : "plain", (unsigned long)read_sizes[j]);
+				return 1;
+			}
+		}
+		mbps[j] = (double)length * iterations / (bench_now_ns() - ns) * 1000.0;
+	}
+
+	ns = bench_now_ns();
+	for (i = 0; i < iterations; i++) {
+		http_form_write(&form, buffer, sizeof(buffer));
+	}
+	mbps[2] = (double)length * iterations / (bench_now_ns() - ns) * 1000.0;
+
+	printf("%6d %-7s %8d %10.0f %10.1f %10.1f %10.1f\n", count, escaped ? "escaped" : "plain", length,
+		length_ns, mbps[0], mbps[1], mbps[2]);
+	return 0;
+}
+
+int main(void)
+{
+	static const int counts[] = {10, 100, 1000};
+	int fails = 0, escaped;
+	size_t i;
+
+	printf("struct http_form: %lu bytes\n", (unsigned long)sizeof(struct http_form));
+	printf("fields value     size  length ns read 1460   read 64      write   (MB/s)\n");
+	for (escaped = 0; escaped < 2; escaped++) {
+		for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+			fails += run(counts[i], escaped);
+		}
+	}
+	return fails;
+}
@@ -0,0 +1,235 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the streaming gzip decoder.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Payloads are compressed on the host with zlib for each window size, then decoded
+ * by http_inflate in 1460 byte packets. zlib inflate of the same stream is shown for reference.
+ * Payloads are a generated JSON document, the benchmark executable as a firmware image,
+ * and the files which are given in the arguments.
+ */
+#include "iot/http/http_inflate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+/** Size of the packet which is passed to the decoder. */
+#define BENCH_PACKET_SIZE        1460
+/** Decompressed bytes which are decoded for each case. */
+#define BENCH_BYTES_PER_CASE     (16 * 1024 * 1024)
+
+static uint64_t output_bytes;
+
+/* bench.h is not included, since close() of the socket API conflicts with unistd.h of zlib. */
+static uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void inflate_output(void *priv_data, const char *data, size_t length)
+{
+	output_bytes += length;
+}
+
+static unsigned char *load_file(const char *path, size_t *length)
+{
+	unsigned char *data;
+	FILE *file;
+	long size;
+
+	file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	data = malloc(size > 0 ? size : 1);
+	if (data != NULL && fread(data, 1, size, file) != (size_t)size) {
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	*length = (size_t)size;
+	return data;
+}
+
+static unsigned char *make_json(size_t *length)
+{
+	size_t size = 256 * 1024, pos = 0;
+	unsigned char *data = malloc(size);
+	int i = 0;
+
+	pos += sprintf((char *)data, "{\"readings\":[");
+	while (pos < size - 256) {
+		pos += sprintf((char *)data + pos, "%s{\"id\":%d,\"device\":\"samd21-%04d\",\"temperature\":%d.%d,"
+			"\"humidity\":%d,\"status\":\"%s\",\"timestamp\":\"2018-03-%02dT%02d:%02d:%02dZ\"}",
+			i ? "," : "", i, i % 37, 15 + i % 13, i % 10, 30 + i % 41, (i % 5) ? "ok" : "warning",
+			1 + i % 28, i % 24, i % 60, (i * 7) % 60);
+		i++;
+	}
+	pos += sprintf((char *)data + pos, "]}");
+	*length = pos;
+	return data;
+}
+
+static unsigned char *compress_gzip(const unsigned char *data, size_t length, int window_bits, size_t *compressed_length)
+{
+	z_stream stream;
+	size_t size = length + length / 10 + 1024;
+	unsigned char *out = malloc(size);
+
+	memset(&stream, 0, sizeof(stream));
+	/* +16 makes the gzip container. */
+	if (deflateInit2(&stream, 6, Z_DEFLATED, window_bits + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		free(out);
+		return NULL;
+	}
+	stream.next_in = (unsigned char *)data;
+	stream.avail_in = length;
+	stream.next_out = out;
+	stream.avail_out = size;
+	deflate(&stream, Z_FINISH);
+	*compressed_length = stream.total_out;
+	deflateEnd(&stream);
+	return out;
+}
+
+static double zlib_speed(const unsigned char *compressed, size_t compressed_length, size_t length, int window_bits)
+{
+	static unsigned char out[BENCH_PACKET_SIZE * 4];
+	uint32_t iterations = BENCH_BYTES_PER_CASE / length + 1, i;
+	z_stream stream;
+	uint64_t ns, total = 0;
+	size_t pos, size;
+
+	ns = bench_now_ns();
+	for (i = 0; i < iterations; i++) {
+		memset(&stream, 0, sizeof(stream));
+		inflateInit2(&stream, window_bits + 16);
+		for (pos = 0; pos < compressed_length; pos += size) {
+			size = compressed_length - pos < BENCH_PACKET_SIZE ? compressed_length - pos : BENCH_PACKET_SIZE;
+			stream.next_in = (unsigned char *)compressed + pos;
+			stream.avail_in = size;
+			do {
+				stream.next_out = out;
+				stream.avail_out = sizeof(out);
+				inflate(&stream, Z_NO_FLUSH);
+				total += sizeof(out) - stream.avail_out;
+			} while (stream.avail_out == 0);
+		}
+		inflateEnd(&stream);
+	}
+	ns = bench_now_ns() - ns;
+	return (double)total / ns * 1000.0;
+}
+
+static int run(const char *name, const unsigned char *data, size_t length)
+{
+	static const int window_bits[] = {10, 12, 13, 15};
+	static uint8_t window[HTTP_INFLATE_MAX_WINDOW_SIZE];
+	struct http_inflate inflate;
+	unsigned char *compressed;
+	size_t compressed_length, pos, size, i;
+	uint32_t iterations = BENCH_BYTES_PER_CASE / length + 1, j;
+	uint32_t window_size;
+	uint64_t ns;
+	int fails = 0, ret = 0;
+
+	for (i = 0; i < sizeof(window_bits) / sizeof(window_bits[0]); i++) {
+		window_size = 1UL << window_bits[i];
+		compressed = compress_gzip(data, length, window_bits[i], &compressed_length);
+		if (compressed == NULL) {
+			return 1;
+		}
+		output_bytes = 0;
+		ns = bench_now_ns();
+		for (j = 0; j < iterations; j++) {
+			http_inflate_init(&inflate, HTTP_INFLATE_GZIP, window, window_size, inflate_output, NULL);
+			for (pos = 0; pos < compressed_length; pos += size) {
+				size = compressed_length - pos < BENCH_PACKET_SIZE ? compressed_length - pos : BENCH_PACKET_SIZE;
+				ret = http_inflate_feed(&inflate, (const char *)compressed + pos, size);
+				if (ret < 0) {
+					break;
+				}
+			}
+			if (ret != 1 || !http_inflate_is_done(&inflate)) {
+				break;
+			}
+		}
+		ns = bench_now_ns() - ns;
+		if (j != iterations || output_bytes != (uint64_t)length * iterations) {
+			printf("%-10s %8lu %6lu  FAILED (%d)\n", name, (unsigned long)length, (unsigned long)window_size, ret);
+			fails++;
+		} else {
+			printf("%-10s %8lu %6lu %6.1f%% %8.1f %8.1f %8.1f %8lu\n", name, (unsigned long)length, (unsigned long)window_size,
+				100.0 * compressed_length / length, (double)compressed_length * iterations / ns * 1000.0,
+				(double)output_bytes / ns * 1000.0, zlib_speed(compressed, compressed_length, length, window_bits[i]),
+				(unsigned long)(sizeof(struct http_inflate) + window_size));
+		}
+		free(compressed);
+	}
+	return fails;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char *data;
+	size_t length;
+	int fails = 0, i;
+
+	printf("payload        size window  ratio   in MB/s out MB/s zlib MB/s  RAM\n");
+	data = make_json(&length);
+	fails += run("json", data, length);
+	free(data);
+	data = load_file("/proc/self/exe", &length);
+	if (data != NULL) {
+		fails += run("firmware", data, length);
+		free(data);
+	}
+	for (i = 1; i < argc; i++) {
+		data = load_file(argv[i], &length);
+		if (data == NULL || length == 0) {
+			printf("%s: cannot read\n", argv[i]);
+			fails++;
+			continue;
+		}
+		fails += run(argv[i], data, length);
+		free(data);
+	}
+	return fails;
+}
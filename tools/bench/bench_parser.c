@@ -0,0 +1,267 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the HTTP response header parser.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Canned responses are fed to the client in the fragments from 1 to 1460 bytes.
+ * Time of the receive path is divided by the size of the header.
+ * The entity cases count the bytes which were copied inside of the receive buffer for each received byte.
+ * Two requests are pipelined and their responses are fed back to back, so the second one starts in the middle
+ * of the buffer. Bodies which are bigger than the receive buffer are streamed. The small body is passed to
+ * the callback in one piece, so it is made contiguous if it wraps around the end of the buffer.
+ */
+#include "bench.h"
+#include "iot/http/http_client.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Size of the receive buffer of the client. */
+#define BENCH_RECV_BUFFER_SIZE   1460
+/** Total header bytes which are parsed for each case. */
+#define BENCH_BYTES_PER_CASE     (4 * 1024 * 1024)
+/** Size of the streamed entity. */
+#define BENCH_ENTITY_SIZE        (16 * 1024)
+/** Size of the entity which fits the receive buffer. */
+#define BENCH_SMALL_ENTITY_SIZE  1000
+/** Size of the chunks of the chunked entity. */
+#define BENCH_CHUNK_SIZE         1000
+/** Number of the responses of each entity case. They are sent in pairs. */
+#define BENCH_ENTITY_RESPONSES   16
+
+static struct http_client_module http_client_module_inst;
+static struct sw_timer_module swt_module_inst;
+static uint32_t responses;
+static uint32_t entities;
+static uint32_t disconnects;
+
+static char typical_response[1024];
+static char big_response[8192];
+static char many_response[4096];
+static char length_response[2 * (BENCH_ENTITY_SIZE + 256)];
+static char chunked_response[2 * (BENCH_ENTITY_SIZE + 256)];
+static char small_response[2 * (BENCH_SMALL_ENTITY_SIZE + 256)];
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+	if (type == HTTP_CLIENT_CALLBACK_RECV_RESPONSE && data->recv_response.response_code == 200) {
+		responses++;
+		if (data->recv_response.content != NULL) {
+			entities++;
+		}
+	} else if (type == HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA && data->recv_chunked_data.is_complete) {
+		entities++;
+	} else if (type == HTTP_CLIENT_CALLBACK_DISCONNECTED) {
+		disconnects++;
+	}
+}
+
+/* Append a copy of the response to itself. */
+static void repeat(char *response)
+{
+	size_t length = strlen(response);
+
+	memcpy(response + length, response, length + 1);
+}
+
+static void make_responses(void)
+{
+	static const char typical[] =
+		"HTTP/1.1 200 OK\r\n"
+		"Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+		"Server: nginx/1.18.0 (Ubuntu)\r\n"
+		"Content-Type: application/json; charset=utf-8\r\n"
+		"Content-Length: 0\r\n"
+		"Connection: keep-alive\r\n"
+		"Keep-Alive: timeout=60\r\n"
+		"Cache-Control: no-cache, no-store, must-revalidate\r\n"
+		"ETag: \"5d8c72a5edda8d6a\"\r\n"
+		"Vary: Accept-Encoding\r\n"
+		"X-Request-Id: 2c6f0b54-7a5e-4f0c-9d2a-3f5b8c1e9a77\r\n";
+	char *ptr;
+	int i, chunk;
+
+	sprintf(typical_response, "%s\r\n", typical);
+
+	/* Headers which are much longer than the receive buffer and not used by the client. */
+	ptr = big_response + sprintf(big_response, "%sSet-Cookie: session=", typical);
+	memset(ptr, 'c', 4000);
+	ptr += 4000;
+	ptr += sprintf(ptr, "; Path=/; HttpOnly\r\nContent-Security-Policy: default-src 'self'");
+	for (i = 0; i < 60; i++) {
+		ptr += sprintf(ptr, " https://cdn%02d.example.com", i);
+	}
+	strcpy(ptr, "\r\n\r\n");
+
+	ptr = many_response + sprintf(many_response, "%s", typical);
+	for (i = 0; i < 60; i++) {
+		ptr += sprintf(ptr, "X-Custom-Header-%02d: value-%d\r\n", i, i * 7919);
+	}
+	strcpy(ptr, "\r\n");
+
+	ptr = length_response + sprintf(length_response,
+		"HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %u\r\n\r\n", BENCH_ENTITY_SIZE);
+	memset(ptr, 'e', BENCH_ENTITY_SIZE);
+	ptr[BENCH_ENTITY_SIZE] = '\0';
+
+	ptr = chunked_response + sprintf(chunked_response,
+		"HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nTransfer-Encoding: chunked\r\n\r\n");
+	for (i = 0; i < BENCH_ENTITY_SIZE; i += chunk) {
+		chunk = (BENCH_ENTITY_SIZE - i < BENCH_CHUNK_SIZE) ? BENCH_ENTITY_SIZE - i : BENCH_CHUNK_SIZE;
+		ptr += sprintf(ptr, "%x\r\n", chunk);
+		memset(ptr, 'e', chunk);
+		ptr += chunk;
+		ptr += sprintf(ptr, "\r\n");
+	}
+	strcpy(ptr, "0\r\n\r\n");
+
+	ptr = small_response + sprintf(small_response,
+		"HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n", BENCH_SMALL_ENTITY_SIZE);
+	memset(ptr, 'e', BENCH_SMALL_ENTITY_SIZE);
+	ptr[BENCH_SMALL_ENTITY_SIZE] = '\0';
+
+	/* Responses of the pipelined pair. */
+	repeat(length_response);
+	repeat(chunked_response);
+	repeat(small_response);
+}
+
+static int run(const char *name, const char *response, size_t fragment)
+{
+	struct http_client_config httpc_conf;
+	size_t length = strlen(response);
+	uint32_t iterations = BENCH_BYTES_PER_CASE / length;
+	uint64_t ns = 0, cycles = 0, start_ns, start_cycles;
+	uint32_t i;
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.recv_buffer_size = BENCH_RECV_BUFFER_SIZE;
+	httpc_conf.timer_inst = &swt_module_inst;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		printf("%s: init failed\n", name);
+		return 1;
+	}
+	http_client_register_callback(&http_client_module_inst, http_client_callback);
+	fake_winc_reset();
+	responses = 0;
+	disconnects = 0;
+
+	for (i = 0; i < iterations; i++) {
+		if (http_client_send_request(&http_client_module_inst, "http://127.0.0.1/status", HTTP_METHOD_GET, NULL, NULL) < 0) {
+			break;
+		}
+		fake_winc_complete_connects();
+		fake_winc_complete_sends();
+		start_ns = bench_now_ns();
+		start_cycles = bench_cycles();
+		fake_winc_feed(http_client_module_inst.sock, response, length, fragment);
+		cycles += bench_cycles() - start_cycles;
+		ns += bench_now_ns() - start_ns;
+	}
+	http_client_deinit(&http_client_module_inst);
+	/* Each case starts with a new connection. The idle one is closed in the pool. */
+	fake_winc_disconnect_all();
+
+	if (responses != iterations || disconnects != 0) {
+		printf("%-8s %6lu %6lu  FAILED (%lu of %lu responses, %lu disconnects)\n", name, (unsigned long)length,
+			(unsigned long)fragment, (unsigned long)responses, (unsigned long)iterations, (unsigned long)disconnects);
+		return 1;
+	}
+	printf("%-8s %6lu %6lu %9.2f %9.2f\n", name, (unsigned long)length, (unsigned long)fragment,
+		(double)ns / ((double)length * iterations), (double)cycles / ((double)length * iterations));
+	return 0;
+}
+
+static int run_entity(const char *name, const char *response, size_t fragment)
+{
+	struct http_client_config httpc_conf;
+	size_t length = strlen(response);
+	uint32_t received, copied, i;
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.recv_buffer_size = BENCH_RECV_BUFFER_SIZE;
+	httpc_conf.timer_inst = &swt_module_inst;
+	httpc_conf.pipeline_depth = 2;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		printf("%s: init failed\n", name);
+		return 1;
+	}
+	http_client_register_callback(&http_client_module_inst, http_client_callback);
+	fake_winc_reset();
+	entities = 0;
+	disconnects = 0;
+
+	for (i = 0; i < BENCH_ENTITY_RESPONSES; i += 2) {
+		if (http_client_send_request(&http_client_module_inst, "http://127.0.0.1/log", HTTP_METHOD_GET, NULL, NULL) < 0
+			|| http_client_send_request(&http_client_module_inst, "http://127.0.0.1/log", HTTP_METHOD_GET, NULL, NULL) < 0) {
+			break;
+		}
+		fake_winc_complete_connects();
+		while (fake_winc_complete_sends() > 0) {
+		}
+		fake_winc_feed(http_client_module_inst.sock, response, length, fragment);
+	}
+	received = http_client_module_inst.recv_total;
+	copied = http_client_module_inst.recv_copied;
+	http_client_deinit(&http_client_module_inst);
+	fake_winc_disconnect_all();
+
+	if (entities != BENCH_ENTITY_RESPONSES || disconnects != 0) {
+		printf("%-8s %6lu %6lu  FAILED (%lu of %u entities, %lu disconnects)\n", name, (unsigned long)length,
+			(unsigned long)fragment, (unsigned long)entities, BENCH_ENTITY_RESPONSES, (unsigned long)disconnects);
+		return 1;
+	}
+	printf("%-8s %6lu %6lu %9lu %9lu %9.3f\n", name, (unsigned long)length, (unsigned long)fragment,
+		(unsigned long)received, (unsigned long)copied, (double)copied / received);
+	return 0;
+}
+
+int main(void)
+{
+	static const size_t fragments[] = {1, 2, 16, 64, 536, 1460};
+	int fails = 0;
+	size_t i;
+
+	make_responses();
+	printf("response  bytes   frag   ns/byte  cyc/byte\n");
+	for (i = 0; i < sizeof(fragments) / sizeof(fragments[0]); i++) {
+		fails += run("typical", typical_response, fragments[i]);
+		fails += run("big", big_response, fragments[i]);
+		fails += run("many", many_response, fragments[i]);
+	}
+	printf("\nentity    bytes   frag  received    copied  copies/byte\n");
+	for (i = 0; i < sizeof(fragments) / sizeof(fragments[0]); i++) {
+		fails += run_entity("length", length_response, fragments[i]);
+		fails += run_entity("chunked", chunked_response, fragments[i]);
+		fails += run_entity("small", small_response, fragments[i]);
+	}
+	return fails;
+}
@@ -0,0 +1,240 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the request pipelining.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * A burst of small GET requests is sent to one host with and without the pipelining.
+ * The server of the fake socket answers the requests which arrived in the previous round,
+ * so a round is one round trip of the network. The connect is one more round.
+ * The first burst opens the connection, and the next ones reuse it.
+ * The chained cases send each request from the callback of the previous response.
+ * The last case closes the first connection after some responses, so the unanswered requests are sent again.
+ */
+#include "bench.h"
+#include "iot/http/http_client.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Number of the requests in the burst. */
+#define BENCH_BURST              10
+/** Number of the bursts which are timed. */
+#define BENCH_BURSTS             2000
+/** Round trip time of the modeled network. Unit is milliseconds. */
+#define BENCH_RTT_MS             50
+/** Size of the receive buffer of the client. */
+#define BENCH_RECV_BUFFER_SIZE   1460
+
+static struct http_client_module http_client_module_inst;
+static struct sw_timer_module swt_module_inst;
+static char capture[64 * 1024];
+static char response[256];
+static size_t response_length;
+static uint32_t issued;
+static uint32_t responses;
+static uint32_t disconnects;
+static int chained;
+
+static const char *const paths[BENCH_BURST] = {
+	"config", "schedule", "time", "firmware", "alarms", "zones", "limits", "users", "devices", "status",
+};
+/* Each case uses another host, so the connection which is kept in the pool by the previous case is not reused. */
+static char urls[BENCH_BURST][64];
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+	if (type == HTTP_CLIENT_CALLBACK_RECV_RESPONSE && data->recv_response.response_code == 200) {
+		responses++;
+		if (chained && issued < BENCH_BURST
+			&& http_client_send_request(module_inst, urls[issued], HTTP_METHOD_GET, NULL, NULL) >= 0) {
+			issued++;
+		}
+	} else if (type == HTTP_CLIENT_CALLBACK_DISCONNECTED) {
+		disconnects++;
+	}
+}
+
+/* Find the end of the next request header. GET requests do not have the entity. */
+static char *find_request_end(char *data, size_t length)
+{
+	size_t i;
+
+	for (i = 3; i < length; i++) {
+		if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+			return data + i + 1;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Application sends the requests of the burst until the client is busy.
+ * Without the pipelining, The next request is sent after the response, because the request
+ * which is sent while connecting replaces the previous one.
+ * The chained cases send only the first request here.
+ */
+static void issue(void)
+{
+	while (issued < BENCH_BURST
+		&& (chained ? issued == 0 : (http_client_module_inst.config.pipeline_depth > 0 || issued == responses))
+		&& http_client_send_request(&http_client_module_inst, urls[issued], HTTP_METHOD_GET, NULL, NULL) >= 0) {
+		issued++;
+	}
+}
+
+/*
+ * Run one burst. Returns the number of the rounds, or -1 if the burst did not finish.
+ * The server closes the connection after close_after responses if it is not zero.
+ */
+static int run_burst(uint32_t close_after)
+{
+	char answer[BENCH_BURST * sizeof(response)];
+	size_t parsed = 0, answer_length;
+	uint32_t connects, answered = 0;
+	char *end;
+	int rounds = 0, loops = 0;
+
+	fake_winc_reset();
+	issued = 0;
+	responses = 0;
+	while (responses < BENCH_BURST) {
+		/* Client which does not make progress. */
+		if (rounds > 10 * BENCH_BURST || ++loops > 100 * BENCH_BURST) {
+			return -1;
+		}
+		connects = fake_winc_stats.connects;
+		issue();
+		fake_winc_complete_connects();
+		/* Sending is local. It is repeated until the client stops writing. */
+		while (fake_winc_complete_sends() > 0) {
+			issue();
+		}
+		rounds += fake_winc_stats.connects - connects;
+
+		/* Server answers every request which arrived. */
+		answer_length = 0;
+		while ((end = find_request_end(capture + parsed, fake_winc_captured - parsed)) != NULL) {
+			parsed = end - capture;
+			memcpy(answer + answer_length, response, response_length);
+			answer_length += response_length;
+			if (close_after > 0 && ++answered == close_after) {
+				break;
+			}
+		}
+		if (answer_length > 0) {
+			rounds++;
+			fake_winc_feed(http_client_module_inst.sock, answer, answer_length, BENCH_RECV_BUFFER_SIZE);
+			if (issued > responses && !http_client_module_inst.waiting_response) {
+				/* Request which was not answered yet is lost by the client. */
+				return -1;
+			}
+		}
+		if (close_after > 0 && answered == close_after) {
+			/* Requests which were not answered are lost with the connection. */
+			close_after = 0;
+			parsed = fake_winc_captured;
+			fake_winc_disconnect(http_client_module_inst.sock);
+		}
+	}
+	return rounds;
+}
+
+static int run(const char *name, uint8_t depth, int chain, uint32_t close_after)
+{
+	static int host;
+	struct http_client_config httpc_conf;
+	uint32_t connects, packets, i;
+	int cold, warm = 0;
+	uint64_t ns;
+
+	host++;
+	for (i = 0; i < BENCH_BURST; i++) {
+		sprintf(urls[i], "http://10.0.0.%d/api/%s", host, paths[i]);
+	}
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.recv_buffer_size = BENCH_RECV_BUFFER_SIZE;
+	httpc_conf.timer_inst = &swt_module_inst;
+	httpc_conf.pipeline_depth = depth;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		printf("%s: init failed\n", name);
+		return 1;
+	}
+	http_client_register_callback(&http_client_module_inst, http_client_callback);
+	fake_winc_capture = capture;
+	fake_winc_capture_size = sizeof(capture);
+	disconnects = 0;
+	chained = chain;
+
+	cold = run_burst(close_after);
+	connects = fake_winc_stats.connects;
+	packets = fake_winc_stats.sends;
+	ns = bench_now_ns();
+	for (i = 0; i < BENCH_BURSTS && cold >= 0; i++) {
+		warm = run_burst(0);
+		if (warm < 0) {
+			break;
+		}
+	}
+	ns = bench_now_ns() - ns;
+	http_client_deinit(&http_client_module_inst);
+	fake_winc_capture = NULL;
+
+	if (cold < 0 || warm < 0) {
+		printf("%-14s %5u  FAILED (%lu of %u responses)\n", name, depth, (unsigned long)responses, BENCH_BURST);
+		return 1;
+	}
+	printf("%-14s %5u %6d %6d %8lu %8lu %6lu %7d %7d %8.1f\n", name, depth, cold, warm,
+		(unsigned long)connects, (unsigned long)packets, (unsigned long)disconnects,
+		cold * BENCH_RTT_MS, warm * BENCH_RTT_MS, (double)ns / BENCH_BURSTS / 1000.0);
+	return 0;
+}
+
+int main(void)
+{
+	int fails = 0;
+
+	response_length = sprintf(response,
+		"HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 16\r\nConnection: keep-alive\r\n\r\n"
+		"{\"value\":123456}");
+
+	printf("%u requests, %u ms round trip\n", BENCH_BURST, BENCH_RTT_MS);
+	printf("Rounds of the first burst which connects (cold) and of the next bursts (warm)\n");
+	printf("case           depth   cold   warm connects  packets  disc. cold ms warm ms   cpu us\n");
+	fails += run("serial", 0, 0, 0);
+	fails += run("pipeline", 2, 0, 0);
+	fails += run("pipeline", 4, 0, 0);
+	fails += run("pipeline", 8, 0, 0);
+	fails += run("chained", 0, 1, 0);
+	fails += run("chained", 4, 1, 0);
+	fails += run("closed after 3", 8, 0, 3);
+	return fails;
+}
@@ -0,0 +1,195 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the keep-alive connection pool.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Requests are sent in the patterns which reconnect without the connection pool:
+ * one module which alternates two hosts, two modules which alternate one host,
+ * and a module which is created for each request.
+ * Each pattern is run with the keep-alive responses and with "Connection: close",
+ * which is the cost of making a new connection for every request.
+ * The time is modeled from the number of the round trips and the handshakes.
+ */
+#include "bench.h"
+#include "iot/http/http_client.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Number of the requests for each case. */
+#define BENCH_REQUESTS           100
+/** Round trip time of the modeled network. Unit is milliseconds. */
+#define BENCH_RTT_MS             50
+/** Time of the TLS handshake of the WINC in addition to the TCP handshake. Unit is milliseconds. */
+#define BENCH_TLS_MS             400
+/** Size of the receive buffer of the client. */
+#define BENCH_RECV_BUFFER_SIZE   1460
+
+enum pattern {
+	/** One module sends all of the requests to one host. */
+	PATTERN_ONE_HOST,
+	/** One module alternates two hosts. */
+	PATTERN_TWO_HOSTS,
+	/** Two modules alternate one host. */
+	PATTERN_TWO_MODULES,
+	/** New module is initialized for each request and deinitialized after the response. */
+	PATTERN_MODULE_PER_REQUEST,
+};
+
+static const char *const pattern_names[] = {
+	"one host", "two hosts", "two modules", "module/request",
+};
+
+static struct http_client_module http_client_module_inst[2];
+static struct sw_timer_module swt_module_inst;
+static char keep_alive_response[256];
+static char close_response[256];
+static uint32_t responses;
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+	if (type == HTTP_CLIENT_CALLBACK_RECV_RESPONSE && data->recv_response.response_code == 200) {
+		responses++;
+	}
+}
+
+static int init_module(struct http_client_module *module)
+{
+	struct http_client_config httpc_conf;
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.recv_buffer_size = BENCH_RECV_BUFFER_SIZE;
+	httpc_conf.timer_inst = &swt_module_inst;
+	if (http_client_init(module, &httpc_conf) < 0) {
+		return -1;
+	}
+	http_client_register_callback(module, http_client_callback);
+	return 0;
+}
+
+/* Send the request and deliver the response. Returns the number of the round trips. */
+static int request(struct http_client_module *module, const char *url, const char *response)
+{
+	uint32_t connects = fake_winc_stats.connects;
+
+	if (http_client_send_request(module, url, HTTP_METHOD_GET, NULL, NULL) < 0) {
+		return -1;
+	}
+	fake_winc_complete_connects();
+	while (fake_winc_complete_sends() > 0) {
+	}
+	fake_winc_feed(module->sock, response, strlen(response), BENCH_RECV_BUFFER_SIZE);
+	return 1 + (int)(fake_winc_stats.connects - connects);
+}
+
+static int run(enum pattern pattern, int keep_alive)
+{
+	static int host;
+	const char *response = keep_alive ? keep_alive_response : close_response;
+	struct http_client_module *module;
+	char urls[2][64];
+	uint32_t i;
+	int rounds = 0, ret = 0;
+	uint64_t ns;
+	double tcp_ms, tls_ms;
+
+	/* Each case uses other hosts and starts with the empty pool. */
+	fake_winc_disconnect_all();
+	fake_winc_reset();
+	responses = 0;
+	for (i = 0; i < 2; i++) {
+		sprintf(urls[i], "http://10.0.%d.%d/api/value", ++host, i);
+	}
+	if (pattern != PATTERN_MODULE_PER_REQUEST
+		&& (init_module(&http_client_module_inst[0]) < 0 || init_module(&http_client_module_inst[1]) < 0)) {
+		printf("init failed\n");
+		return 1;
+	}
+
+	ns = bench_now_ns();
+	for (i = 0; i < BENCH_REQUESTS && ret >= 0; i++) {
+		module = &http_client_module_inst[0];
+		switch (pattern) {
+		case PATTERN_ONE_HOST:
+			ret = request(module, urls[0], response);
+			break;
+		case PATTERN_TWO_HOSTS:
+			ret = request(module, urls[i % 2], response);
+			break;
+		case PATTERN_TWO_MODULES:
+			ret = request(&http_client_module_inst[i % 2], urls[0], response);
+			break;
+		default:
+			if (init_module(module) < 0) {
+				ret = -1;
+				break;
+			}
+			ret = request(module, urls[0], response);
+			http_client_deinit(module);
+			break;
+		}
+		rounds += ret;
+	}
+	ns = bench_now_ns() - ns;
+	if (pattern != PATTERN_MODULE_PER_REQUEST) {
+		http_client_deinit(&http_client_module_inst[0]);
+		http_client_deinit(&http_client_module_inst[1]);
+	}
+
+	if (ret < 0 || responses != BENCH_REQUESTS) {
+		printf("%-15s %-10s FAILED (%lu of %u responses)\n", pattern_names[pattern], keep_alive ? "keep-alive" : "close",
+			(unsigned long)responses, BENCH_REQUESTS);
+		return 1;
+	}
+	tcp_ms = (double)rounds * BENCH_RTT_MS;
+	tls_ms = tcp_ms + (double)fake_winc_stats.connects * BENCH_TLS_MS;
+	printf("%-15s %-10s %8lu %7d %8.0f %8.0f %8.1f %8.1f %8.1f\n", pattern_names[pattern], keep_alive ? "keep-alive" : "close",
+		(unsigned long)fake_winc_stats.connects, rounds, tcp_ms, tls_ms,
+		BENCH_REQUESTS * 1000.0 / tcp_ms, BENCH_REQUESTS * 1000.0 / tls_ms, (double)ns / BENCH_REQUESTS / 1000.0);
+	return 0;
+}
+
+int main(void)
+{
+	static const char headers[] = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 16\r\n";
+	int fails = 0, pattern;
+
+	sprintf(keep_alive_response, "%sConnection: keep-alive\r\nKeep-Alive: timeout=60\r\n\r\n{\"value\":123456}", headers);
+	sprintf(close_response, "%sConnection: close\r\n\r\n{\"value\":123456}", headers);
+
+	printf("%u requests, %u ms round trip, %u ms TLS handshake\n", BENCH_REQUESTS, BENCH_RTT_MS, BENCH_TLS_MS);
+	printf("pattern         connection connects  rounds   tcp ms   tls ms  tcp r/s  tls r/s   cpu us\n");
+	for (pattern = PATTERN_ONE_HOST; pattern <= PATTERN_MODULE_PER_REQUEST; pattern++) {
+		fails += run((enum pattern)pattern, 1);
+		fails += run((enum pattern)pattern, 0);
+	}
+	return fails;
+}
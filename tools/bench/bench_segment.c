@@ -0,0 +1,306 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the segmented download.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * A resource is downloaded with the segmented download over 1 to 6 connections.
+ * The server of the fake socket answers the Range requests. The response of a request is sent
+ * from the next round, and each round is one round trip of the network. In a round, Each connection
+ * receives up to one TCP window, and all of the connections share the capacity of the link.
+ * The file is written to the memory and compared with the resource.
+ */
+#include "bench.h"
+#include "iot/http/http_segment.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Size of the resource. */
+#define BENCH_RESOURCE_SIZE      (1024 * 1024)
+/** Round trip time of the modeled network. Unit is milliseconds. */
+#define BENCH_RTT_MS             20
+/** Data which one connection receives in a round trip. */
+#define BENCH_STREAM_WINDOW      (4 * 1024)
+/** Data which all of the connections receive in a round trip. */
+#define BENCH_LINK_WINDOW        (24 * 1024)
+/** Size of the packet from the server. */
+#define BENCH_PACKET_SIZE        1460
+
+/** Response which is prepared by the server for a socket. */
+static struct {
+	/** Received part of the request. */
+	char request[1024];
+	size_t request_length;
+	/** Response header and the part of the resource. */
+	char *response;
+	size_t response_length;
+	size_t response_sent;
+	/** Round from which the response is sent. */
+	uint32_t ready_round;
+} servers[TCP_SOCK_MAX];
+
+static struct sw_timer_module swt_module_inst;
+static struct http_segment_module segment_module_inst;
+static char *resource;
+static char *disk;
+static uint32_t round_count;
+static uint32_t requests;
+static int finished;
+static int finish_result;
+
+FRESULT f_lseek(FIL *fp, DWORD ofs)
+{
+	if (ofs > BENCH_RESOURCE_SIZE) {
+		return FR_DISK_ERR;
+	}
+	fp->fptr = ofs;
+	if (fp->fsize < ofs) {
+		fp->fsize = ofs;
+	}
+	return FR_OK;
+}
+
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+	if (fp->fptr + btw > BENCH_RESOURCE_SIZE) {
+		return FR_DISK_ERR;
+	}
+	memcpy(disk + fp->fptr, buff, btw);
+	fp->fptr += btw;
+	if (fp->fsize < fp->fptr) {
+		fp->fsize = fp->fptr;
+	}
+	*bw = btw;
+	return FR_OK;
+}
+
+FRESULT f_sync(FIL *fp)
+{
+	return FR_OK;
+}
+
+/* Prepare the response of the complete request. Only "Range: bytes=first-last" is supported. */
+static void server_respond(SOCKET sock)
+{
+	char *end, *range;
+	unsigned long first = 0, last = BENCH_RESOURCE_SIZE - 1;
+	size_t length;
+	int partial = 0;
+
+	end = strstr(servers[sock].request, "\r\n\r\n");
+	if (end == NULL || servers[sock].response != NULL) {
+		return;
+	}
+	*end = '\0';
+	range = strstr(servers[sock].request, "Range: bytes=");
+	if (range != NULL && sscanf(range + 13, "%lu-%lu", &first, &last) >= 1) {
+		partial = 1;
+		if (last >= BENCH_RESOURCE_SIZE) {
+			last = BENCH_RESOURCE_SIZE - 1;
+		}
+	}
+	length = last - first + 1;
+	servers[sock].response = malloc(length + 256);
+	if (partial) {
+		servers[sock].response_length = sprintf(servers[sock].response,
+			"HTTP/1.1 206 Partial Content\r\nETag: \"v1\"\r\nContent-Range: bytes %lu-%lu/%u\r\n"
+			"Content-Length: %lu\r\nConnection: keep-alive\r\n\r\n",
+			first, last, BENCH_RESOURCE_SIZE, (unsigned long)length);
+	} else {
+		servers[sock].response_length = sprintf(servers[sock].response,
+			"HTTP/1.1 200 OK\r\nETag: \"v1\"\r\nContent-Length: %lu\r\nConnection: keep-alive\r\n\r\n", (unsigned long)length);
+	}
+	memcpy(servers[sock].response + servers[sock].response_length, resource + first, length);
+	servers[sock].response_length += length;
+	servers[sock].response_sent = 0;
+	servers[sock].ready_round = round_count + 1;
+	requests++;
+
+	/* Keep the next request if it was sent together. */
+	end += 4;
+	servers[sock].request_length -= end - servers[sock].request;
+	memmove(servers[sock].request, end, servers[sock].request_length + 1);
+}
+
+static void server_receive(SOCKET sock, const char *data, size_t length)
+{
+	if (servers[sock].request_length + length >= sizeof(servers[sock].request)) {
+		return;
+	}
+	memcpy(servers[sock].request + servers[sock].request_length, data, length);
+	servers[sock].request_length += length;
+	servers[sock].request[servers[sock].request_length] = '\0';
+	server_respond(sock);
+}
+
+/* Send the responses for a round trip. */
+static void server_send_round(void)
+{
+	size_t stream[TCP_SOCK_MAX] = {0};
+	size_t link = 0, size, sent;
+	SOCKET sock;
+	int progress = 1;
+
+	/* Packets of the connections are interleaved. */
+	while (progress && link < BENCH_LINK_WINDOW) {
+		progress = 0;
+		for (sock = 0; sock < TCP_SOCK_MAX && link < BENCH_LINK_WINDOW; sock++) {
+			if (servers[sock].response == NULL || servers[sock].ready_round > round_count
+				|| stream[sock] >= BENCH_STREAM_WINDOW) {
+				continue;
+			}
+			size = servers[sock].response_length - servers[sock].response_sent;
+			if (size > BENCH_PACKET_SIZE) {
+				size = BENCH_PACKET_SIZE;
+			}
+			sent = fake_winc_feed(sock, servers[sock].response + servers[sock].response_sent, size, BENCH_PACKET_SIZE);
+			if (servers[sock].response == NULL) {
+				/* Client closed the connection. */
+				continue;
+			}
+			servers[sock].response_sent += sent;
+			stream[sock] += sent;
+			link += sent;
+			progress |= (sent > 0);
+			if (servers[sock].response_sent == servers[sock].response_length) {
+				free(servers[sock].response);
+				servers[sock].response = NULL;
+				server_respond(sock);
+			}
+		}
+	}
+}
+
+static void server_reset(void)
+{
+	SOCKET sock;
+
+	for (sock = 0; sock < TCP_SOCK_MAX; sock++) {
+		free(servers[sock].response);
+		memset(&servers[sock], 0, sizeof(servers[sock]));
+	}
+}
+
+static void segment_callback(struct http_segment_module *module_inst, int result)
+{
+	finished = 1;
+	finish_result = result;
+}
+
+static int run(uint8_t connection_count, uint32_t segment_size, uint32_t *base_rounds)
+{
+	struct http_segment_config config;
+	FIL file;
+	uint64_t ns;
+	uint32_t loops = 0;
+	int result;
+
+	fake_winc_disconnect_all();
+	fake_winc_reset();
+	server_reset();
+	memset(disk, 0, BENCH_RESOURCE_SIZE);
+	memset(&file, 0, sizeof(file));
+	round_count = 0;
+	requests = 0;
+	finished = 0;
+
+	http_segment_get_config_defaults(&config);
+	config.client.timer_inst = &swt_module_inst;
+	config.connection_count = connection_count;
+	config.segment_size = segment_size;
+	result = http_segment_init(&segment_module_inst, &config);
+	if (result < 0) {
+		printf("%5u %8lu  init failed (%d)\n", connection_count, (unsigned long)segment_size, result);
+		return 1;
+	}
+	http_segment_register_callback(&segment_module_inst, segment_callback);
+
+	ns = bench_now_ns();
+	result = http_segment_start(&segment_module_inst, "http://10.0.0.1/firmware.bin", &file);
+	while (result == 0 && !finished && ++loops < 100000) {
+		/* One round trip. The connects complete, and the data of the previous requests arrives. */
+		fake_winc_complete_connects();
+		while (fake_winc_complete_sends() > 0) {
+		}
+		http_segment_task(&segment_module_inst);
+		server_send_round();
+		round_count++;
+		http_segment_task(&segment_module_inst);
+	}
+	ns = bench_now_ns() - ns;
+	http_segment_deinit(&segment_module_inst);
+
+	if (result < 0 || !finished || finish_result < 0 || file.fsize != BENCH_RESOURCE_SIZE
+		|| memcmp(disk, resource, BENCH_RESOURCE_SIZE) != 0) {
+		printf("%5u %8lu  FAILED (%d, %d)\n", connection_count, (unsigned long)segment_size, result, finish_result);
+		return 1;
+	}
+	if (*base_rounds == 0) {
+		*base_rounds = round_count;
+	}
+	printf("%5u %8lu %7lu %8lu %8lu %8.0f %7.2fx %8.1f\n", connection_count, (unsigned long)segment_size,
+		(unsigned long)round_count, (unsigned long)requests, (unsigned long)fake_winc_stats.connects,
+		BENCH_RESOURCE_SIZE / 1024.0 / (round_count * BENCH_RTT_MS / 1000.0),
+		(double)*base_rounds / round_count, (double)BENCH_RESOURCE_SIZE / ns * 1000.0);
+	return 0;
+}
+
+int main(void)
+{
+	static const uint8_t connection_counts[] = {1, 2, 3, 4, 6};
+	static const uint32_t segment_sizes[] = {65536, 16384};
+	uint32_t base_rounds, i, j;
+	int fails = 0;
+
+	resource = malloc(BENCH_RESOURCE_SIZE);
+	disk = malloc(BENCH_RESOURCE_SIZE);
+	srand(1);
+	for (i = 0; i < BENCH_RESOURCE_SIZE; i++) {
+		resource[i] = (char)rand();
+	}
+	fake_winc_server = server_receive;
+
+	printf("%u KB resource, %u ms round trip, %u KB window per connection, %u KB window of the link\n",
+		BENCH_RESOURCE_SIZE / 1024, BENCH_RTT_MS, BENCH_STREAM_WINDOW / 1024, BENCH_LINK_WINDOW / 1024);
+	printf("conns  segment  rounds requests connects     KB/s speedup  cpu MB/s\n");
+	for (j = 0; j < sizeof(segment_sizes) / sizeof(segment_sizes[0]); j++) {
+		base_rounds = 0;
+		for (i = 0; i < sizeof(connection_counts) / sizeof(connection_counts[0]); i++) {
+			fails += run(connection_counts[i], segment_sizes[j], &base_rounds);
+		}
+	}
+	fake_winc_server = NULL;
+	server_reset();
+	free(resource);
+	free(disk);
+	return fails;
+}
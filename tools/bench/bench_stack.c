@@ -0,0 +1,234 @@
+/**
+ * \file
+ *
+ * \brief Stack high-water mark of the HTTP client request paths.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Each request runs on its own stack which is filled with a pattern, and the untouched part is counted.
+ * The requests are driven by the fake socket events like the main loop does.
+ * The numbers are for the host CPU. They are compared with each other, not with the SAMD21.
+ *
+ * The before column was measured in the same way with http_client.c before the TX buffer moved to the module.
+ * It declared a send_buffer_size VLA in _http_client_request and waited for each packet in _http_client_send_wait,
+ * which ran the socket events from inside the request. Its debug printf calls were compiled out for the measurement.
+ * The file was posted through the read_file callback of the entity, which read 16 KB from the file object.
+ *
+ * The deepest call of both columns is the printf family of the C library, which takes about 1.8 KB on the host.
+ * The POST requests format the Content-Length in both versions. The first GET to a host formats the header template,
+ * which replaced the VLA at the top of the GET path. The C library of the target needs much less for it.
+ */
+#include "bench.h"
+#include "iot/http/http_client.h"
+#include "iot/http/http_multipart.h"
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+
+#define BENCH_STACK_SIZE         (64 * 1024)
+#define BENCH_STACK_PATTERN      0xA5
+/** Size of the file which is posted. */
+#define BENCH_FILE_SIZE          (16 * 1024)
+
+/* Stack bytes of the old request path. See above. */
+#define BENCH_BEFORE_GET         1872
+#define BENCH_BEFORE_POST        3712
+
+static struct http_client_module http_client_module_inst;
+static struct sw_timer_module swt_module_inst;
+static ucontext_t main_context;
+static ucontext_t request_context;
+static unsigned char request_stack[BENCH_STACK_SIZE];
+static int done;
+
+static const char file_path[] = "0:log.bin";
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+	if (type == HTTP_CLIENT_CALLBACK_RECV_RESPONSE && !data->recv_response.is_chunked) {
+		done = 1;
+	} else if (type == HTTP_CLIENT_CALLBACK_RECV_CHUNKED_DATA && data->recv_chunked_data.is_complete) {
+		done = 1;
+	} else if (type == HTTP_CLIENT_CALLBACK_DISCONNECTED) {
+		done = -1;
+	}
+}
+
+static const char value[] = "temperature=21.5&humidity=40&device=samd21+xplained+pro";
+
+static const char *value_type(void *priv_data)
+{
+	return "application/x-www-form-urlencoded";
+}
+
+static int value_length(void *priv_data)
+{
+	return (int)sizeof(value) - 1;
+}
+
+static int value_read(void *priv_data, char *buffer, uint32_t size, uint32_t written)
+{
+	if (size > sizeof(value) - 1 - written) {
+		size = sizeof(value) - 1 - written;
+	}
+	memcpy(buffer, value + written, size);
+	return (int)size;
+}
+
+/* The file system has one file. Its data is generated. */
+FRESULT f_stat(const TCHAR *path, FILINFO *fno)
+{
+	if (strcmp(path, file_path)) {
+		return FR_NO_FILE;
+	}
+	fno->fsize = BENCH_FILE_SIZE;
+	return FR_OK;
+}
+
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode)
+{
+	if (strcmp(path, file_path)) {
+		return FR_NO_FILE;
+	}
+	fp->fptr = 0;
+	fp->fsize = BENCH_FILE_SIZE;
+	return FR_OK;
+}
+
+FRESULT f_lseek(FIL *fp, DWORD ofs)
+{
+	if (ofs > fp->fsize) {
+		return FR_DISK_ERR;
+	}
+	fp->fptr = ofs;
+	return FR_OK;
+}
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+	if (btr > fp->fsize - fp->fptr) {
+		btr = fp->fsize - fp->fptr;
+	}
+	memset(buff, 'x', btr);
+	fp->fptr += btr;
+	*br = btr;
+	return FR_OK;
+}
+
+FRESULT f_close(FIL *fp)
+{
+	return FR_OK;
+}
+
+/**
+ * \brief Send the request and handle the response on the painted stack.
+ */
+static void request(struct http_entity *entity, const char *response)
+{
+	if (http_client_send_request(&http_client_module_inst, "http://127.0.0.1/api/v1/data",
+		entity != NULL ? HTTP_METHOD_POST : HTTP_METHOD_GET, entity, NULL) == 0) {
+		fake_winc_complete_connects();
+		while (fake_winc_complete_sends() > 0) {
+		}
+		fake_winc_feed(http_client_module_inst.sock, response, strlen(response), 536);
+	}
+}
+
+static struct http_entity *request_entity;
+static const char *request_response;
+
+static void request_entry(void)
+{
+	request(request_entity, request_response);
+}
+
+static int run(const char *name, uint32_t before, struct http_entity *entity, const char *response)
+{
+	struct http_client_config httpc_conf;
+	size_t unused;
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.timer_inst = &swt_module_inst;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		return 1;
+	}
+	http_client_register_callback(&http_client_module_inst, http_client_callback);
+	fake_winc_reset();
+	done = 0;
+
+	memset(request_stack, BENCH_STACK_PATTERN, sizeof(request_stack));
+	request_entity = entity;
+	request_response = response;
+	getcontext(&request_context);
+	request_context.uc_stack.ss_sp = request_stack;
+	request_context.uc_stack.ss_size = sizeof(request_stack);
+	request_context.uc_link = &main_context;
+	makecontext(&request_context, request_entry, 0);
+	swapcontext(&main_context, &request_context);
+
+	/* Stack grows down. */
+	for (unused = 0; unused < sizeof(request_stack) && request_stack[unused] == BENCH_STACK_PATTERN; unused++) {
+	}
+	http_client_deinit(&http_client_module_inst);
+	if (done != 1) {
+		printf("%-12s FAILED\n", name);
+		return 1;
+	}
+	printf("%-12s %6lu %6lu\n", name, (unsigned long)before, (unsigned long)(sizeof(request_stack) - unused));
+	return 0;
+}
+
+int main(void)
+{
+	static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+	static const char chunked[] = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n";
+	struct http_entity value_entity, file_entity;
+	struct http_multipart multipart;
+	int fails = 0;
+
+	memset(&value_entity, 0, sizeof(value_entity));
+	value_entity.get_contents_type = value_type;
+	value_entity.get_contents_length = value_length;
+	value_entity.read = value_read;
+	http_multipart_init(&multipart);
+	if (http_multipart_add_file(&multipart, "log", file_path, NULL, NULL) < 0) {
+		printf("POST file    FAILED\n");
+		return 1;
+	}
+	http_multipart_get_entity(&multipart, &file_entity);
+
+	printf("Stack bytes (send_buffer_size %u)\n", SOCKET_BUFFER_MAX_LENGTH);
+	printf("path         before  after\n");
+	fails += run("GET", BENCH_BEFORE_GET, NULL, response);
+	fails += run("GET chunked", BENCH_BEFORE_GET, NULL, chunked);
+	fails += run("POST value", BENCH_BEFORE_POST, &value_entity, response);
+	fails += run("POST file", BENCH_BEFORE_POST, &file_entity, response);
+	return fails;
+}
@@ -0,0 +1,170 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the entity upload with the send window.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Entities from 1 KB to 10 MB are uploaded to the fake socket.
+ * The socket accepts up to 8 packets like the WINC and completes them once per round trip.
+ * The CPU throughput of the client is measured, and the link throughput is estimated
+ * from the number of the round trips with BENCH_RTT_MS.
+ * A round is one iteration of the main loop. The longest one shows how long the other work
+ * of the application is blocked while the upload runs.
+ */
+#include "bench.h"
+#include "iot/http/http_client.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Round trip time of the modeled link. Unit is milliseconds. */
+#define BENCH_RTT_MS             10
+
+static struct http_client_module http_client_module_inst;
+static struct sw_timer_module swt_module_inst;
+static char pattern[4096];
+static uint32_t entity_size;
+static int requested;
+static int disconnected;
+
+static const char *entity_type(void *priv_data)
+{
+	return "application/octet-stream";
+}
+
+static int entity_length(void *priv_data)
+{
+	return (int)entity_size;
+}
+
+static int entity_read(void *priv_data, char *buffer, uint32_t size, uint32_t written)
+{
+	uint32_t offset = written % sizeof(pattern);
+
+	if (size > sizeof(pattern) - offset) {
+		size = sizeof(pattern) - offset;
+	}
+	memcpy(buffer, pattern + offset, size);
+	return (int)size;
+}
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+	if (type == HTTP_CLIENT_CALLBACK_REQUESTED) {
+		requested = 1;
+	} else if (type == HTTP_CLIENT_CALLBACK_DISCONNECTED) {
+		disconnected = 1;
+	}
+}
+
+static int run(uint32_t size, uint8_t window)
+{
+	static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+	struct http_client_config httpc_conf;
+	struct http_entity entity;
+	uint32_t rounds = 0;
+	uint64_t ns, loop_ns, max_loop_ns;
+	int completed;
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.timer_inst = &swt_module_inst;
+	httpc_conf.send_buffer_size = SOCKET_BUFFER_MAX_LENGTH;
+	httpc_conf.send_window_max = window;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		return 1;
+	}
+	http_client_register_callback(&http_client_module_inst, http_client_callback);
+	fake_winc_reset();
+
+	memset(&entity, 0, sizeof(entity));
+	entity.get_contents_type = entity_type;
+	entity.get_contents_length = entity_length;
+	entity.read = entity_read;
+	entity_size = size;
+	requested = 0;
+	disconnected = 0;
+
+	ns = bench_now_ns();
+	if (http_client_send_request(&http_client_module_inst, "http://127.0.0.1/upload", HTTP_METHOD_POST, &entity, NULL) < 0) {
+		http_client_deinit(&http_client_module_inst);
+		printf("%9lu %6u  FAILED\n", (unsigned long)size, window);
+		return 1;
+	}
+	loop_ns = bench_now_ns();
+	fake_winc_complete_connects();
+	max_loop_ns = bench_now_ns() - loop_ns;
+	while (!requested && !disconnected) {
+		loop_ns = bench_now_ns();
+		completed = fake_winc_complete_sends();
+		loop_ns = bench_now_ns() - loop_ns;
+		if (loop_ns > max_loop_ns) {
+			max_loop_ns = loop_ns;
+		}
+		if (completed == 0) {
+			break;
+		}
+		rounds++;
+	}
+	ns = bench_now_ns() - ns;
+	if (requested) {
+		fake_winc_feed(http_client_module_inst.sock, response, sizeof(response) - 1, sizeof(response) - 1);
+	}
+	http_client_deinit(&http_client_module_inst);
+	/* Each case starts with a new connection. The idle one is closed in the pool. */
+	fake_winc_disconnect_all();
+
+	if (!requested || fake_winc_stats.sent_bytes < size) {
+		printf("%9lu %6u  FAILED\n", (unsigned long)size, window);
+		return 1;
+	}
+	printf("%9lu %6u %7lu %9lu %8lu %10.1f %10.1f %8.1f\n", (unsigned long)size, window, (unsigned long)rounds,
+		(unsigned long)fake_winc_stats.sends, (unsigned long)fake_winc_stats.buffer_full,
+		(double)size / ns * 1000.0, (double)size / (rounds * BENCH_RTT_MS), max_loop_ns / 1000.0);
+	return 0;
+}
+
+int main(void)
+{
+	static const uint32_t sizes[] = {1024, 10 * 1024, 100 * 1024, 1024 * 1024, 10 * 1024 * 1024};
+	static const uint8_t windows[] = {1, 2, 4, 6, 8, 12};
+	int fails = 0;
+	size_t i, j;
+
+	for (i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = (char)('a' + i % 26);
+	}
+	printf("     size window  rounds   packets     full  cpu MB/s  KB/s@%dms max loop us\n", BENCH_RTT_MS);
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		for (j = 0; j < sizeof(windows) / sizeof(windows[0]); j++) {
+			fails += run(sizes[i], windows[j]);
+		}
+	}
+	return fails;
+}
@@ -0,0 +1,183 @@
+/**
+ * \file
+ *
+ * \brief Benchmark of the request header serialization.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Same request header is written with the per-byte path which stream_writer_send_buffer used before,
+ * with the block copy, and with the scatter/gather and reserve/commit API.
+ * Then the whole request header of the HTTP client is measured through the fake socket.
+ */
+#include "bench.h"
+#include "iot/stream_writer.h"
+#include "iot/http/http_client.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Number of the headers which are written in each case. */
+#define BENCH_ITERATIONS         200000
+/** Number of the requests of the HTTP client. */
+#define BENCH_REQUESTS           20000
+
+static const char *const parts[] = {
+	"POST ", "/api/v1/devices/0123456789/telemetry?fields=temperature,humidity", " HTTP/1.1\r\n",
+	"User-Agent: ", "atmel/1.0.2", "\r\n",
+	"Host: ", "iot.example.com", "\r\n",
+	"Connection: ", "Keep-Alive", "\r\n",
+	"Accept-Encoding: ", "gzip, deflate", "\r\n",
+	"Content-Type: ", "application/x-www-form-urlencoded", "\r\n",
+	"X-Api-Key: 7f3c2a9b4e6d1f08a5c3b2e1d0f9a8b7c6d5e4f3a2b1c0d9e8f7a6b5c4d3e2f1\r\n",
+};
+#define PART_COUNT               (sizeof(parts) / sizeof(parts[0]))
+
+static uint64_t written_bytes;
+static struct http_client_module http_client_module_inst;
+static struct sw_timer_module swt_module_inst;
+
+static int discard(void *priv_data, char *buffer, size_t length)
+{
+	written_bytes += length;
+	return 0;
+}
+
+static void write_per_byte(struct stream_writer *writer, uint32_t content_length)
+{
+	char number[32];
+	size_t i, j, length;
+
+	for (i = 0; i < PART_COUNT; i++) {
+		for (j = 0; parts[i][j] != '\0'; j++) {
+			stream_writer_send_8(writer, parts[i][j]);
+		}
+	}
+	length = sprintf(number, "Content-Length: %u\r\n\r\n", (unsigned int)content_length);
+	for (j = 0; j < length; j++) {
+		stream_writer_send_8(writer, number[j]);
+	}
+}
+
+static void write_block(struct stream_writer *writer, uint32_t content_length)
+{
+	char number[32];
+	size_t i;
+
+	for (i = 0; i < PART_COUNT; i++) {
+		stream_writer_send_buffer(writer, parts[i], strlen(parts[i]));
+	}
+	stream_writer_send_buffer(writer, number, sprintf(number, "Content-Length: %u\r\n\r\n", (unsigned int)content_length));
+}
+
+static void write_iov(struct stream_writer *writer, uint32_t content_length)
+{
+	struct stream_writer_iov iov[PART_COUNT];
+	char *ptr;
+	size_t i;
+
+	for (i = 0; i < PART_COUNT; i++) {
+		iov[i].buffer = parts[i];
+		iov[i].length = strlen(parts[i]);
+	}
+	stream_writer_send_iov(writer, iov, PART_COUNT);
+	ptr = stream_writer_reserve(writer, sizeof("Content-Length: 4294967295\r\n\r\n"));
+	stream_writer_commit(writer, sprintf(ptr, "Content-Length: %u\r\n\r\n", (unsigned int)content_length));
+}
+
+static void run(const char *name, void (*write)(struct stream_writer *, uint32_t))
+{
+	static char buffer[1400];
+	struct stream_writer writer;
+	uint64_t ns, cycles;
+	uint32_t i;
+
+	written_bytes = 0;
+	ns = bench_now_ns();
+	cycles = bench_cycles();
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		stream_writer_init(&writer, buffer, sizeof(buffer), discard, NULL);
+		write(&writer, 1000 + i);
+		stream_writer_send_remain(&writer);
+	}
+	cycles = bench_cycles() - cycles;
+	ns = bench_now_ns() - ns;
+	printf("%-10s %6lu %10.1f %10.1f %8.2f\n", name, (unsigned long)(written_bytes / BENCH_ITERATIONS),
+		(double)ns / BENCH_ITERATIONS, (double)cycles / BENCH_ITERATIONS, (double)cycles / written_bytes);
+}
+
+static void http_client_callback(struct http_client_module *module_inst, int type, union http_client_data *data)
+{
+}
+
+static int run_client(void)
+{
+	static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+	struct http_client_config httpc_conf;
+	uint64_t ns = 0, cycles = 0, start_ns, start_cycles, bytes = 0;
+	uint32_t i;
+
+	http_client_get_config_defaults(&httpc_conf);
+	httpc_conf.timer_inst = &swt_module_inst;
+	if (http_client_init(&http_client_module_inst, &httpc_conf) < 0) {
+		return 1;
+	}
+	http_client_register_callback(&http_client_module_inst, http_client_callback);
+	fake_winc_reset();
+	for (i = 0; i < BENCH_REQUESTS; i++) {
+		start_ns = bench_now_ns();
+		start_cycles = bench_cycles();
+		if (http_client_send_request(&http_client_module_inst, "http://127.0.0.1/api/v1/devices/0123456789/telemetry?fields=temperature,humidity",
+			HTTP_METHOD_GET, NULL, "X-Api-Key: 7f3c2a9b4e6d1f08a5c3b2e1d0f9a8b7c6d5e4f3a2b1c0d9e8f7a6b5c4d3e2f1\r\n") < 0) {
+			break;
+		}
+		fake_winc_complete_connects();
+		fake_winc_complete_sends();
+		cycles += bench_cycles() - start_cycles;
+		ns += bench_now_ns() - start_ns;
+		bytes = fake_winc_stats.sent_bytes;
+		fake_winc_feed(http_client_module_inst.sock, response, sizeof(response) - 1, sizeof(response) - 1);
+	}
+	http_client_deinit(&http_client_module_inst);
+	if (i != BENCH_REQUESTS) {
+		printf("http_client  FAILED after %lu requests\n", (unsigned long)i);
+		return 1;
+	}
+	printf("%-10s %6lu %10.1f %10.1f %8.2f\n", "client", (unsigned long)(bytes / BENCH_REQUESTS),
+		(double)ns / BENCH_REQUESTS, (double)cycles / BENCH_REQUESTS, (double)cycles / bytes);
+	return 0;
+}
+
+int main(void)
+{
+	printf("path        bytes  ns/header cyc/header cyc/byte\n");
+	run("per-byte", write_per_byte);
+	run("block", write_block);
+	run("iov", write_iov);
+	return run_client();
+}
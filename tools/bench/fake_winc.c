@@ -0,0 +1,268 @@
+/**
+ * \file
+ *
+ * \brief Fake WINC socket, SW timer and response cache for the host benchmarks.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "bench.h"
+#include "driver/include/m2m_wifi.h"
+#include "iot/http/http_cache.h"
+#include "iot/http/http_client.h"
+#include <string.h>
+#include <errno.h>
+
+struct fake_winc_stats fake_winc_stats;
+int fake_winc_send_capacity = 8;
+char *fake_winc_capture;
+size_t fake_winc_capture_size;
+size_t fake_winc_captured;
+void (*fake_winc_server)(SOCKET sock, const char *data, size_t length);
+
+/** State of a fake socket. */
+static struct {
+	uint8_t used;
+	/** A flag that connect was called but not completed. */
+	uint8_t connecting;
+	/** Buffer which was passed to recv. */
+	uint8 *recv_buffer;
+	uint16 recv_length;
+} sockets[TCP_SOCK_MAX];
+
+/** Sizes of the sent packets in order. Completion is delivered with the socket of the packet. */
+static struct {
+	SOCKET sock;
+	sint16 length;
+} pending[64];
+static int pending_count;
+
+void fake_winc_reset(void)
+{
+	memset(&fake_winc_stats, 0, sizeof(fake_winc_stats));
+	pending_count = 0;
+	fake_winc_captured = 0;
+}
+
+void fake_winc_complete_connects(void)
+{
+	tstrSocketConnectMsg msg;
+	SOCKET sock;
+
+	for (sock = 0; sock < TCP_SOCK_MAX; sock++) {
+		if (sockets[sock].connecting) {
+			sockets[sock].connecting = 0;
+			msg.sock = sock;
+			msg.s8Error = 0;
+			http_client_socket_event_handler(sock, SOCKET_MSG_CONNECT, &msg);
+		}
+	}
+}
+
+int fake_winc_complete_sends(void)
+{
+	int count = pending_count;
+	int i;
+	SOCKET sock;
+	sint16 length;
+
+	for (i = 0; i < count; i++) {
+		sock = pending[0].sock;
+		length = pending[0].length;
+		memmove(pending, pending + 1, --pending_count * sizeof(pending[0]));
+		http_client_socket_event_handler(sock, SOCKET_MSG_SEND, &length);
+	}
+	return count;
+}
+
+size_t fake_winc_feed(SOCKET sock, const char *data, size_t length, size_t fragment)
+{
+	tstrSocketRecvMsg msg;
+	size_t size, delivered = 0;
+
+	while (length > 0) {
+		size = (length < fragment) ? length : fragment;
+		if (size > sockets[sock].recv_length) {
+			size = sockets[sock].recv_length;
+		}
+		if (size == 0) {
+			/* Client does not receive. */
+			break;
+		}
+		memcpy(sockets[sock].recv_buffer, data, size);
+		memset(&msg, 0, sizeof(msg));
+		msg.pu8Buffer = sockets[sock].recv_buffer;
+		msg.s16BufferSize = (sint16)size;
+		msg.u16RemainingSize = (uint16)(length - size);
+		sockets[sock].recv_length = 0;
+		data += size;
+		length -= size;
+		delivered += size;
+		http_client_socket_event_handler(sock, SOCKET_MSG_RECV, &msg);
+	}
+	return delivered;
+}
+
+void fake_winc_disconnect(SOCKET sock)
+{
+	tstrSocketRecvMsg msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.s16BufferSize = SOCK_ERR_CONN_ABORTED;
+	sockets[sock].recv_length = 0;
+	http_client_socket_event_handler(sock, SOCKET_MSG_RECV, &msg);
+}
+
+void fake_winc_disconnect_all(void)
+{
+	SOCKET sock;
+
+	for (sock = 0; sock < TCP_SOCK_MAX; sock++) {
+		if (sockets[sock].used) {
+			fake_winc_disconnect(sock);
+		}
+	}
+}
+
+SOCKET socket(uint16 u16Domain, uint8 u8Type, uint8 u8Flags)
+{
+	SOCKET sock;
+
+	for (sock = 0; sock < TCP_SOCK_MAX; sock++) {
+		if (!sockets[sock].used) {
+			memset(&sockets[sock], 0, sizeof(sockets[sock]));
+			sockets[sock].used = 1;
+			return sock;
+		}
+	}
+	return SOCK_ERR_MAX_TCP_SOCK;
+}
+
+sint8 connect(SOCKET sock, struct sockaddr *pstrAddr, uint8 u8AddrLen)
+{
+	sockets[sock].connecting = 1;
+	fake_winc_stats.connects++;
+	return SOCK_ERR_NO_ERROR;
+}
+
+sint16 recv(SOCKET sock, void *pvRecvBuf, uint16 u16BufLen, uint32 u32Timeoutmsec)
+{
+	sockets[sock].recv_buffer = pvRecvBuf;
+	sockets[sock].recv_length = u16BufLen;
+	return SOCK_ERR_NO_ERROR;
+}
+
+sint16 send(SOCKET sock, void *pvSendBuffer, uint16 u16SendLength, uint16 u16Flags)
+{
+	size_t size;
+
+	if (pending_count >= fake_winc_send_capacity || pending_count >= (int)(sizeof(pending) / sizeof(pending[0]))) {
+		fake_winc_stats.buffer_full++;
+		return SOCK_ERR_BUFFER_FULL;
+	}
+	if (fake_winc_capture != NULL) {
+		size = fake_winc_capture_size - fake_winc_captured;
+		if (size > u16SendLength) {
+			size = u16SendLength;
+		}
+		memcpy(fake_winc_capture + fake_winc_captured, pvSendBuffer, size);
+		fake_winc_captured += size;
+	}
+	if (fake_winc_server != NULL) {
+		fake_winc_server(sock, pvSendBuffer, u16SendLength);
+	}
+	pending[pending_count].sock = sock;
+	pending[pending_count].length = (sint16)u16SendLength;
+	pending_count++;
+	fake_winc_stats.sends++;
+	fake_winc_stats.sent_bytes += u16SendLength;
+	return SOCK_ERR_NO_ERROR;
+}
+
+sint8 close(SOCKET sock)
+{
+	if (sock >= 0 && sock < TCP_SOCK_MAX) {
+		sockets[sock].used = 0;
+		sockets[sock].connecting = 0;
+		sockets[sock].recv_length = 0;
+	}
+	return SOCK_ERR_NO_ERROR;
+}
+
+uint32 nmi_inet_addr(char *pcIpAddr)
+{
+	/* Every host in the benchmarks is an IP address. */
+	return 0x0100007F;
+}
+
+sint8 gethostbyname(uint8 *pcHostName)
+{
+	return SOCK_ERR_NO_ERROR;
+}
+
+sint8 m2m_wifi_handle_events(void *arg)
+{
+	fake_winc_complete_sends();
+	return 0;
+}
+
+int sw_timer_register_callback(struct sw_timer_module *const module_inst, sw_timer_callback_t callback,
+	void *context, uint32_t period)
+{
+	return 0;
+}
+
+void sw_timer_unregister_callback(struct sw_timer_module *const module_inst, int timer_id)
+{
+}
+
+void sw_timer_enable_callback(struct sw_timer_module *const module_inst, int timer_id, uint32_t delay)
+{
+}
+
+void sw_timer_disable_callback(struct sw_timer_module *const module_inst, int timer_id)
+{
+}
+
+void sw_timer_task(struct sw_timer_module *const module_inst)
+{
+}
+
+void sw_timer_sleep(struct sw_timer_module *const module_inst)
+{
+}
+
+uint32_t sw_timer_get_time(struct sw_timer_module *const module_inst)
+{
+	return (uint32_t)(bench_now_ns() / 1000000);
+}
+
+int http_cache_lookup(struct http_cache_module *const module, const char *url, struct http_cache_entry *entry)
+{
+	return -ENOENT;
+}
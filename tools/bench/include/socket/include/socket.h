@@ -0,0 +1,123 @@
+/**
+ * \file
+ *
+ * \brief Host replacement of the WINC socket API for the benchmarks.
+ *
+ * Copyright (c) 2016-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#ifndef __SOCKET_H__
+#define __SOCKET_H__
+
+/*
+ * Only the part which is used by the HTTP client. The values are same as the WINC driver.
+ * The functions are implemented by fake_winc.c.
+ */
+#include "common/include/nm_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOSTNAME_MAX_SIZE              64
+#define SOCKET_BUFFER_MAX_LENGTH       1400
+#define AF_INET                        2
+#define SOCK_STREAM                    1
+#define SOCKET_FLAGS_SSL               0x01
+#define TCP_SOCK_MAX                   (7)
+
+#define SOCK_ERR_NO_ERROR              0
+#define SOCK_ERR_INVALID_ADDRESS       -1
+#define SOCK_ERR_ADDR_ALREADY_IN_USE   -2
+#define SOCK_ERR_MAX_TCP_SOCK          -3
+#define SOCK_ERR_MAX_UDP_SOCK          -4
+#define SOCK_ERR_INVALID_ARG           -6
+#define SOCK_ERR_MAX_LISTEN_SOCK       -7
+#define SOCK_ERR_INVALID               -9
+#define SOCK_ERR_ADDR_IS_REQUIRED      -11
+#define SOCK_ERR_CONN_ABORTED          -12
+#define SOCK_ERR_TIMEOUT               -13
+#define SOCK_ERR_BUFFER_FULL           -14
+
+#define _htons(A)   (uint16)((((uint16) (A)) << 8) | (((uint16) (A)) >> 8))
+
+typedef sint8 SOCKET;
+
+typedef struct {
+	uint32 s_addr;
+} in_addr;
+
+struct sockaddr {
+	uint16 sa_family;
+	uint8 sa_data[14];
+};
+
+struct sockaddr_in {
+	uint16 sin_family;
+	uint16 sin_port;
+	in_addr sin_addr;
+	uint8 sin_zero[8];
+};
+
+typedef enum {
+	SOCKET_MSG_BIND = 1,
+	SOCKET_MSG_LISTEN,
+	SOCKET_MSG_DNS_RESOLVE,
+	SOCKET_MSG_ACCEPT,
+	SOCKET_MSG_CONNECT,
+	SOCKET_MSG_RECV,
+	SOCKET_MSG_SEND,
+	SOCKET_MSG_SENDTO,
+	SOCKET_MSG_RECVFROM
+} tenuSocketCallbackMsgType;
+
+typedef struct {
+	SOCKET sock;
+	sint8 s8Error;
+} tstrSocketConnectMsg;
+
+typedef struct {
+	uint8 *pu8Buffer;
+	sint16 s16BufferSize;
+	uint16 u16RemainingSize;
+	struct sockaddr_in strRemoteAddr;
+} tstrSocketRecvMsg;
+
+NMI_API SOCKET socket(uint16 u16Domain, uint8 u8Type, uint8 u8Flags);
+NMI_API sint8 connect(SOCKET sock, struct sockaddr *pstrAddr, uint8 u8AddrLen);
+NMI_API sint16 recv(SOCKET sock, void *pvRecvBuf, uint16 u16BufLen, uint32 u32Timeoutmsec);
+NMI_API sint16 send(SOCKET sock, void *pvSendBuffer, uint16 u16SendLength, uint16 u16Flags);
+NMI_API sint8 close(SOCKET sock);
+NMI_API uint32 nmi_inet_addr(char *pcIpAddr);
+NMI_API sint8 gethostbyname(uint8 *pcHostName);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SOCKET_H__ */